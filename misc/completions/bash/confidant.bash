@@ -23,10 +23,26 @@ __complgen_match () {
 }
 
 _confidant_cmd_0 () {
-    compgen -A file "$1"
+    confidant complete queries "$1" 2>/dev/null
 }
 
 _confidant_cmd_1 () {
+    compgen -A file "$1"
+}
+
+_confidant_cmd_2 () {
+    confidant complete tags "$1" 2>/dev/null
+}
+
+_confidant_cmd_3 () {
+    confidant complete names "$1" 2>/dev/null
+}
+
+_confidant_cmd_4 () {
+    compgen -A user "$1"
+}
+
+_confidant_cmd_5 () {
     compgen -A directory "$1"
 }
 
@@ -39,23 +55,33 @@ _confidant () {
     local words cword
     _get_comp_words_by_ref -n "$COMP_WORDBREAKS" words cword
 
-    declare -a literals=(help init link config dump get config get -g --global create-directories color log-level repository repository.url links templates -? -h --help -v --verbose -q --quiet dump -f --file -g --global -j --json link -t --tags -f --file -d --dry-run init -d --dry-run usage version -V --version -u --usage -? -h --help -v --verbose -q --quiet)
+    declare -a literals=(help init link watch serve status which rollback check apply archive clone sync config dump get config get -g --global create-directories color log-level -? -h --help -v --verbose -q --quiet dump -f --file -g --global -j --json -t --tags -n --name link -t --tags -f --file -d --dry-run -r --roots -j --jobs --sysroot --sysroot-user --sysroot-sources --backup --force --no-hooks --strict --no-check --changed --plan-out watch -t --tags -f --file serve status which rollback -f --file -d --dry-run check -t --tags -f --file -j --jobs --strict apply -d --dry-run -j --jobs --backup --force --no-hooks --strict --no-check archive -t --tags -f --file --format tar cpio --owner --dir-mode clone -t --tags -j --jobs --depth --sparse --no-link sync -t --tags -f --file -j --jobs --no-link init -d --dry-run usage version -V --version -u --usage -? -h --help -v --verbose -q --quiet)
     declare -a regexes=()
     declare -A literal_transitions=()
     declare -A nontail_transitions=()
-    literal_transitions[0]="([0]=1 [6]=2 [31]=3 [38]=4 [41]=5 [42]=5 [43]=5 [44]=5 [45]=5 [46]=5 [47]=5 [48]=5 [49]=5 [50]=5 [51]=5 [52]=5 [53]=5)"
-    literal_transitions[1]="([38]=5 [31]=5 [6]=17)"
-    literal_transitions[2]="([7]=10 [47]=5 [48]=5 [49]=5 [50]=5 [51]=5 [52]=5 [53]=5 [24]=11)"
-    literal_transitions[3]="([47]=5 [48]=5 [49]=5 [50]=5 [51]=5 [52]=5 [53]=5 [32]=6 [33]=7 [34]=8 [35]=9 [39]=3 [40]=3)"
-    literal_transitions[4]="([47]=5 [48]=5 [49]=5 [50]=5 [51]=5 [52]=5 [53]=5 [39]=18 [40]=18)"
-    literal_transitions[10]="([27]=16 [28]=16 [13]=15 [14]=15 [15]=15 [16]=15 [47]=12 [48]=12 [49]=12 [50]=12 [51]=12 [52]=12 [53]=12)"
-    literal_transitions[11]="([47]=12 [48]=12 [49]=12 [50]=12 [51]=12 [52]=12 [53]=12 [34]=13 [35]=14 [27]=15 [28]=15 [29]=15 [30]=15)"
-    literal_transitions[12]="([47]=5 [48]=5 [49]=5 [50]=5 [51]=5 [52]=5 [53]=5)"
-    literal_transitions[15]="([47]=12 [48]=12 [49]=12 [50]=12 [51]=12 [52]=12 [53]=12)"
-    literal_transitions[16]="([10]=15 [11]=15 [12]=15)"
-    literal_transitions[17]="([24]=5 [7]=5)"
-    literal_transitions[18]="([47]=5 [48]=5 [49]=5 [50]=5 [51]=5 [52]=5 [53]=5)"
-    declare -A match_anything_transitions=([6]=3 [7]=3 [8]=3 [9]=3 [4]=12 [13]=15 [14]=15 [18]=12)
+    literal_transitions[0]="([0]=1 [16]=2 [41]=3 [62]=4 [67]=4 [68]=5 [69]=6 [70]=7 [75]=8 [83]=9 [93]=10 [103]=11 [111]=12 [119]=13 [122]=14 [123]=14 [124]=14 [125]=14 [126]=14 [127]=14 [128]=14 [129]=14 [130]=14 [131]=14 [132]=14 [133]=14 [134]=14)"
+    literal_transitions[1]="([16]=15 [41]=14 [62]=14 [67]=14 [68]=14 [69]=14 [70]=14 [75]=14 [83]=14 [93]=14 [103]=14 [111]=14 [119]=14)"
+    literal_transitions[2]="([17]=16 [30]=17 [128]=14 [129]=14 [130]=14 [131]=14 [132]=14 [133]=14 [134]=14)"
+    literal_transitions[3]="([48]=18 [49]=18 [52]=18 [53]=19 [54]=3 [60]=3 [61]=18 [88]=3 [89]=3 [90]=3 [91]=3 [92]=3 [112]=20 [113]=20 [114]=18 [115]=18 [116]=21 [117]=21 [120]=3 [121]=3 [128]=14 [129]=14 [130]=14 [131]=14 [132]=14 [133]=14 [134]=14)"
+    literal_transitions[4]="([112]=22 [113]=22 [114]=23 [115]=23 [128]=14 [129]=14 [130]=14 [131]=14 [132]=14 [133]=14 [134]=14)"
+    literal_transitions[5]="([112]=24 [113]=24 [114]=25 [115]=25 [128]=14 [129]=14 [130]=14 [131]=14 [132]=14 [133]=14 [134]=14)"
+    literal_transitions[6]="([112]=27 [113]=27 [114]=28 [115]=28)"
+    literal_transitions[7]="([114]=29 [115]=29 [120]=7 [121]=7 [128]=14 [129]=14 [130]=14 [131]=14 [132]=14 [133]=14 [134]=14)"
+    literal_transitions[8]="([91]=8 [112]=30 [113]=30 [114]=31 [115]=31 [116]=32 [117]=32 [128]=14 [129]=14 [130]=14 [131]=14 [132]=14 [133]=14 [134]=14)"
+    literal_transitions[9]="([88]=9 [89]=9 [90]=9 [91]=9 [92]=9 [116]=33 [117]=33 [120]=9 [121]=9)"
+    literal_transitions[10]="([98]=34 [101]=35 [102]=35 [112]=36 [113]=36 [114]=37 [115]=37 [128]=14 [129]=14 [130]=14 [131]=14 [132]=14 [133]=14 [134]=14)"
+    literal_transitions[11]="([108]=38 [109]=11 [112]=39 [113]=39 [116]=38 [117]=38 [118]=11)"
+    literal_transitions[12]="([112]=41 [113]=41 [114]=42 [115]=42 [116]=43 [117]=43 [118]=12 [128]=14 [129]=14 [130]=14 [131]=14 [132]=14 [133]=14 [134]=14)"
+    literal_transitions[13]="([120]=40 [121]=40 [128]=14 [129]=14 [130]=14 [131]=14 [132]=14 [133]=14 [134]=14)"
+    literal_transitions[15]="([17]=14 [30]=14)"
+    literal_transitions[16]="([33]=44 [34]=44 [128]=26 [129]=26 [130]=26 [131]=26 [132]=26 [133]=26 [134]=26)"
+    literal_transitions[17]="([33]=45 [34]=45 [36]=45 [39]=46 [40]=46 [112]=47 [113]=47 [114]=48 [115]=48 [116]=45 [128]=26 [129]=26 [130]=26 [131]=26 [132]=26 [133]=26 [134]=26)"
+    literal_transitions[26]="([128]=14 [129]=14 [130]=14 [131]=14 [132]=14 [133]=14 [134]=14)"
+    literal_transitions[34]="([99]=10 [100]=10)"
+    literal_transitions[40]="([128]=14 [129]=14 [130]=14 [131]=14 [132]=14 [133]=14 [134]=14)"
+    literal_transitions[44]="([20]=45 [21]=45 [22]=45)"
+    literal_transitions[45]="([128]=26 [129]=26 [130]=26 [131]=26 [132]=26 [133]=26 [134]=26)"
+    declare -A match_anything_transitions=([5]=26 [6]=26 [9]=26 [11]=40 [13]=26 [16]=45 [18]=3 [19]=3 [20]=3 [21]=3 [22]=4 [23]=4 [24]=5 [25]=5 [27]=6 [28]=6 [29]=7 [30]=8 [31]=8 [32]=8 [33]=9 [35]=10 [36]=10 [37]=10 [38]=11 [39]=11 [40]=26 [41]=12 [42]=12 [43]=12 [46]=45 [47]=45 [48]=45)
     declare -A subword_transitions
 
     local state=0
@@ -92,11 +118,11 @@ _confidant () {
         return 1
     done
 
-    declare -A literal_transitions_level_0=([4]="47 48 49 50 51 52 53 39 40" [2]="7 47 48 49 50 51 52 53 24" [0]="0 6 31 38 41 42" [3]="47 48 49 50 51 52 53 32 33 34 35 39 40" [18]="47 48 49 50 51 52 53" [10]="27 28 13 14 15 16 47 48 49 50 51 52 53" [11]="47 48 49 50 51 52 53 34 35 27 28 29 30" [16]="10 11 12" [12]="47 48 49 50 51 52 53" [15]="47 48 49 50 51 52 53" [1]="38 31 6" [17]="24 7")
-    declare -A literal_transitions_level_1=([0]="43 44 45 46 47 48 49 50 51 52 53")
+    declare -A literal_transitions_level_0=([0]="0 16 41 62 67 68 69 70 75 83 93 103 111 119 122 123" [1]="16 41 62 67 68 69 70 75 83 93 103 111 119" [2]="17 30 128 129 130 131 132 133 134" [3]="48 49 52 53 54 60 61 88 89 90 91 92 112 113 114 115 116 117 120 121 128 129 130 131 132 133 134" [4]="112 113 114 115 128 129 130 131 132 133 134" [5]="112 113 114 115 128 129 130 131 132 133 134" [6]="112 113 114 115" [7]="114 115 120 121 128 129 130 131 132 133 134" [8]="91 112 113 114 115 116 117 128 129 130 131 132 133 134" [9]="88 89 90 91 92 116 117 120 121" [10]="98 101 102 112 113 114 115 128 129 130 131 132 133 134" [11]="108 109 112 113 116 117 118" [12]="112 113 114 115 116 117 118 128 129 130 131 132 133 134" [13]="120 121 128 129 130 131 132 133 134" [15]="17 30" [16]="33 34 128 129 130 131 132 133 134" [17]="33 34 36 39 40 112 113 114 115 116 128 129 130 131 132 133 134" [26]="128 129 130 131 132 133 134" [34]="99 100" [40]="128 129 130 131 132 133 134" [44]="20 21 22" [45]="128 129 130 131 132 133 134")
+    declare -A literal_transitions_level_1=([0]="124 125 126 127 128 129 130 131 132 133 134")
     declare -A subword_transitions_level_0=()
     declare -A subword_transitions_level_1=()
-    declare -A commands_level_0=([18]="1" [9]="0" [4]="1" [8]="0" [13]="0" [14]="0")
+    declare -A commands_level_0=([5]="3" [6]="1" [9]="1" [13]="5" [16]="0" [18]="1" [19]="4" [20]="2" [22]="2" [23]="1" [24]="2" [25]="1" [27]="2" [28]="1" [29]="1" [30]="2" [31]="1" [36]="2" [37]="1" [39]="2" [40]="5" [41]="2" [42]="1" [46]="3" [47]="2" [48]="1")
     declare -A commands_level_1=()
     declare -A nontail_commands_level_0=()
     declare -A nontail_regexes_level_0=()
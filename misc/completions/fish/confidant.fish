@@ -8,6 +8,18 @@ function __confidant_help_depth_2
     test (count $cmd) -eq 3
 end
 
+# names, tags and queries from the config in use, see 'confidant complete'
+function __confidant_complete
+    set -l cmd (commandline -opc)
+    set -l file
+    for i in (seq (count $cmd))
+        if contains -- $cmd[$i] -f --file; and test $i -lt (count $cmd)
+            set file -f $cmd[(math $i + 1)]
+        end
+    end
+    confidant complete $file $argv[1] (commandline -ct) 2>/dev/null
+end
+
 # usage
 complete -c confidant -f -n "
     __fish_use_subcommand;
@@ -62,7 +74,7 @@ complete -c confidant -f -n "
     and not __fish_seen_subcommand_from version;
 " -a help -d "display help for subcommands"
 # help <action>
-complete -c confidant -n "__fish_seen_subcommand_from help; and __confidant_help_depth_1" -f -a "init link config"
+complete -c confidant -n "__fish_seen_subcommand_from help; and __confidant_help_depth_1" -f -a "init link watch serve status which rollback check apply archive clone sync config"
 complete -c confidant -n "__fish_seen_subcommand_from help; and __fish_seen_subcommand_from config; and __confidant_help_depth_2" -f -a "dump get"
 
 complete -c confidant -f -n "
@@ -115,6 +127,12 @@ complete -c confidant -n "
     and __fish_seen_subcommand_from get
 " -f -s h -s '?' -l help -d "display help info"
 
+complete -c confidant -n "
+    __fish_seen_subcommand_from config;
+    and __fish_seen_subcommand_from get;
+    and not __fish_seen_argument -s g -l global
+" -f -a "(__confidant_complete queries)"
+
 complete -c confidant -n "
     __fish_seen_subcommand_from config;
     and __fish_seen_subcommand_from dump
@@ -125,6 +143,21 @@ complete -c confidant -n "
     and __fish_seen_subcommand_from dump;
 " -s g -l global -d "display global configuration"
 
+complete -c confidant -n "
+    __fish_seen_subcommand_from config;
+    and __fish_seen_subcommand_from dump;
+" -f -s j -l json -d "output in JSON format"
+
+complete -c confidant -n "
+    __fish_seen_subcommand_from config;
+    and __fish_seen_subcommand_from dump;
+" -x -s t -l tags -a "(__confidant_complete tags)" -d "only display entries with the given tags"
+
+complete -c confidant -n "
+    __fish_seen_subcommand_from config;
+    and __fish_seen_subcommand_from dump;
+" -x -s n -l name -a "(__confidant_complete names)" -d "only display entries matching a pattern"
+
 complete -c confidant -n __fish_use_subcommand -a init -d "initialize a repository"
 complete -c confidant -n "__fish_seen_subcommand_from init" -s d -l dry-run -d "simulate actions only"
 complete -c confidant -n "__fish_seen_subcommand_from init" -s v -l verbose -d "increase verbosity"
@@ -134,6 +167,90 @@ complete -c confidant -n "__fish_seen_subcommand_from init" -s h -s '?' -l help
 complete -c confidant -n __fish_use_subcommand -a link -d "apply symlinks"
 complete -c confidant -n "__fish_seen_subcommand_from link" -s h -s '?' -l help -d "display help info"
 
-complete -c confidant -n "__fish_seen_subcommand_from link" -s t -l tags -d "specify tagged entries to apply"
+complete -c confidant -n "__fish_seen_subcommand_from link" -x -s t -l tags -a "(__confidant_complete tags)" -d "specify tagged entries to apply"
 complete -c confidant -n "__fish_seen_subcommand_from link" -s f -l file -d "specify a file path"
-complete -c confidant -n "__fish_seen_subcommand_from link" -s d -l dry-run -d "simulate actions only"
\ No newline at end of file
+complete -c confidant -n "__fish_seen_subcommand_from link" -s d -l dry-run -d "simulate actions only"
+complete -c confidant -n "__fish_seen_subcommand_from link" -r -s r -l roots -d "apply to every home listed in a file"
+complete -c confidant -n "__fish_seen_subcommand_from link" -x -s j -l jobs -d "entries, homes or hooks to handle concurrently"
+complete -c confidant -n "__fish_seen_subcommand_from link" -x -l sysroot -a "(__fish_complete_directories)" -d "link into an image root"
+complete -c confidant -n "__fish_seen_subcommand_from link" -x -l sysroot-user -a "(__fish_complete_users)" -d "user in the image to link for"
+complete -c confidant -n "__fish_seen_subcommand_from link" -l sysroot-sources -d "repository is inside the image"
+complete -c confidant -n "__fish_seen_subcommand_from link" -l backup -d "back up conflicting destinations"
+complete -c confidant -n "__fish_seen_subcommand_from link" -l force -d "replace conflicting destinations"
+complete -c confidant -n "__fish_seen_subcommand_from link" -l no-hooks -d "don't run on-change hooks"
+complete -c confidant -n "__fish_seen_subcommand_from link" -l strict -d "don't apply when the check finds warnings"
+complete -c confidant -n "__fish_seen_subcommand_from link" -l no-check -d "apply without checking first"
+complete -c confidant -n "__fish_seen_subcommand_from link" -l changed -d "only entries git staged changes to"
+complete -c confidant -n "__fish_seen_subcommand_from link" -r -l plan-out -d "save the plan instead of applying it"
+
+complete -c confidant -n __fish_use_subcommand -a watch -d "keep symlinks applied"
+complete -c confidant -n "__fish_seen_subcommand_from watch" -s h -s '?' -l help -d "display help info"
+complete -c confidant -n "__fish_seen_subcommand_from watch" -x -s t -l tags -a "(__confidant_complete tags)" -d "specify tagged entries to apply"
+complete -c confidant -n "__fish_seen_subcommand_from watch" -r -s f -l file -d "specify a file path"
+
+complete -c confidant -n __fish_use_subcommand -a status -d "show the state of links"
+complete -c confidant -n "__fish_seen_subcommand_from status" -s h -s '?' -l help -d "display help info"
+complete -c confidant -n "__fish_seen_subcommand_from status" -x -s t -l tags -a "(__confidant_complete tags)" -d "specify tagged entries to include"
+complete -c confidant -n "__fish_seen_subcommand_from status" -r -s f -l file -d "specify a file path"
+complete -c confidant -n "__fish_seen_subcommand_from status" -f -a "(__confidant_complete names)"
+
+complete -c confidant -n __fish_use_subcommand -a which -d "find the link managing a path"
+complete -c confidant -n "__fish_seen_subcommand_from which" -s h -s '?' -l help -d "display help info"
+complete -c confidant -n "__fish_seen_subcommand_from which" -x -s t -l tags -a "(__confidant_complete tags)" -d "specify tagged entries to include"
+complete -c confidant -n "__fish_seen_subcommand_from which" -r -s f -l file -d "specify a file path"
+
+# rollback
+complete -c confidant -n __fish_use_subcommand -a rollback -d "undo the last link"
+complete -c confidant -n "__fish_seen_subcommand_from rollback" -s h -s '?' -l help -d "display help info"
+complete -c confidant -n "__fish_seen_subcommand_from rollback" -s d -l dry-run -d "show what would be undone"
+complete -c confidant -n "__fish_seen_subcommand_from rollback" -r -s f -l file -d "specify a file path"
+
+# check
+complete -c confidant -n __fish_use_subcommand -a check -d "find problems before linking"
+complete -c confidant -n "__fish_seen_subcommand_from check" -s h -s '?' -l help -d "display help info"
+complete -c confidant -n "__fish_seen_subcommand_from check" -x -s t -l tags -a "(__confidant_complete tags)" -d "specify tagged entries to check"
+complete -c confidant -n "__fish_seen_subcommand_from check" -r -s f -l file -d "specify a file path"
+complete -c confidant -n "__fish_seen_subcommand_from check" -x -s j -l jobs -d "entries to check concurrently"
+complete -c confidant -n "__fish_seen_subcommand_from check" -l strict -d "fail on warnings too"
+
+# apply
+complete -c confidant -n __fish_use_subcommand -a apply -d "create symlinks from a saved plan"
+complete -c confidant -n "__fish_seen_subcommand_from apply" -s h -s '?' -l help -d "display help info"
+complete -c confidant -n "__fish_seen_subcommand_from apply" -s d -l dry-run -d "simulate actions only"
+complete -c confidant -n "__fish_seen_subcommand_from apply" -x -s j -l jobs -d "entries or hooks to handle concurrently"
+complete -c confidant -n "__fish_seen_subcommand_from apply" -l backup -d "back up conflicting destinations"
+complete -c confidant -n "__fish_seen_subcommand_from apply" -l force -d "replace conflicting destinations"
+complete -c confidant -n "__fish_seen_subcommand_from apply" -l no-hooks -d "don't run on-change hooks"
+complete -c confidant -n "__fish_seen_subcommand_from apply" -l strict -d "don't apply when the check finds warnings"
+complete -c confidant -n "__fish_seen_subcommand_from apply" -l no-check -d "apply without checking first"
+
+# archive
+complete -c confidant -n __fish_use_subcommand -a archive -d "write symlinks as a tar or cpio archive"
+complete -c confidant -n "__fish_seen_subcommand_from archive" -s h -s '?' -l help -d "display help info"
+complete -c confidant -n "__fish_seen_subcommand_from archive" -x -s t -l tags -a "(__confidant_complete tags)" -d "specify tagged entries to include"
+complete -c confidant -n "__fish_seen_subcommand_from archive" -r -s f -l file -d "specify a file path"
+complete -c confidant -n "__fish_seen_subcommand_from archive" -x -l format -a "tar cpio" -d "archive format"
+complete -c confidant -n "__fish_seen_subcommand_from archive" -x -l owner -d "UID:GID owning every entry"
+complete -c confidant -n "__fish_seen_subcommand_from archive" -x -l dir-mode -d "octal mode of directories"
+
+# clone
+complete -c confidant -n __fish_use_subcommand -a clone -d "fetch a repository and link it"
+complete -c confidant -n "__fish_seen_subcommand_from clone" -s h -s '?' -l help -d "display help info"
+complete -c confidant -n "__fish_seen_subcommand_from clone" -x -s t -l tags -d "specify tagged entries to link"
+complete -c confidant -n "__fish_seen_subcommand_from clone" -x -s j -l jobs -d "entries to apply concurrently"
+complete -c confidant -n "__fish_seen_subcommand_from clone" -x -l depth -d "commits of history to fetch"
+complete -c confidant -n "__fish_seen_subcommand_from clone" -l sparse -d "only check out what the config uses"
+complete -c confidant -n "__fish_seen_subcommand_from clone" -l no-link -d "clone without linking"
+
+# sync
+complete -c confidant -n __fish_use_subcommand -a sync -d "update the repository and link what changed"
+complete -c confidant -n "__fish_seen_subcommand_from sync" -s h -s '?' -l help -d "display help info"
+complete -c confidant -n "__fish_seen_subcommand_from sync" -x -s t -l tags -a "(__confidant_complete tags)" -d "specify tagged entries to link"
+complete -c confidant -n "__fish_seen_subcommand_from sync" -r -s f -l file -d "specify a file path"
+complete -c confidant -n "__fish_seen_subcommand_from sync" -x -s j -l jobs -d "entries to apply concurrently"
+complete -c confidant -n "__fish_seen_subcommand_from sync" -l no-link -d "update without linking"
+
+complete -c confidant -n __fish_use_subcommand -a serve -d "answer queries from a long-lived process"
+complete -c confidant -n "__fish_seen_subcommand_from serve" -s h -s '?' -l help -d "display help info"
+complete -c confidant -n "__fish_seen_subcommand_from serve" -x -s t -l tags -a "(__confidant_complete tags)" -d "specify tagged entries to include"
+complete -c confidant -n "__fish_seen_subcommand_from serve" -r -s f -l file -d "specify a file path"
@@ -0,0 +1,257 @@
+// SPDX-FileCopyrightText: 2026 Will Reed <wreed@disroot.org>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <iostream>
+#include <map>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "settings/global.hpp"
+#include "settings/local.hpp"
+#include "actions/archive.hpp"
+#include "actions/link.hpp"
+#include "fmt.hpp"
+#include "msg.hpp"
+
+namespace fs = std::filesystem;
+
+using sview = std::string_view;
+using std::string;
+using std::vector;
+
+namespace confidant {
+    namespace actions {
+        namespace archive {
+
+            struct member {
+                // relative to the root the archive is extracted into
+                string path;
+                // empty for a directory
+                string target;
+                bool dir() const { return target.empty(); }
+            };
+
+            // every link, and every directory on the way to one, in path order so
+            // that directories come before what is in them
+            static vector<member> members(const vector<link::entry>& entries) {
+                std::map<string, string> links;
+                for (const auto& e : entries) {
+                    if (e.type == config::local::linktype::copy || e.type == config::local::linktype::hardlink) {
+                        msg::warn("{} is a {} and needs its source, leaving it out", fmt::bolden(e.destination.string()),
+                            config::local::literal(e.type));
+                        continue;
+                    }
+                    string rel = e.destination.lexically_normal().relative_path().string();
+                    while (rel.ends_with('/')) rel.pop_back();
+                    if (rel.empty()) continue;
+                    const fs::path& target = e.target.empty() ? e.source : e.target;
+                    if (!links.emplace(rel, target.string()).second)
+                        msg::warn("{} is the destination of more than one entry, keeping the first", fmt::bolden(e.destination.string()));
+                }
+
+                std::map<string, string> all;
+                for (const auto& [rel, target] : links) {
+                    vector<string> dirs;
+                    for (fs::path dir = fs::path(rel).parent_path(); !dir.empty(); dir = dir.parent_path())
+                        dirs.push_back(dir.string());
+                    // inside another link, extracting it would write through that link
+                    auto outer = std::find_if(dirs.begin(), dirs.end(), [&](const string& d) { return links.contains(d); });
+                    if (outer != dirs.end()) {
+                        msg::warn("{} is inside the link {}, leaving it out", fmt::bolden("/" + rel), fmt::bolden("/" + *outer));
+                        continue;
+                    }
+                    for (auto& d : dirs) all.emplace(std::move(d), string());
+                    all.insert_or_assign(rel, target);
+                }
+
+                vector<member> out;
+                out.reserve(all.size());
+                for (auto& [path, target] : all) out.push_back({path, std::move(target)});
+                return out;
+            }
+
+            namespace tar {
+
+                constexpr std::size_t block = 512;
+
+                // an octal field, NUL terminated; false when the value doesn't fit
+                static bool octal(char* field, std::size_t width, std::uint64_t value) {
+                    string digits = std::format("{:o}", value);
+                    if (digits.size() > width - 1) return false;
+                    digits.insert(0, width - 1 - digits.size(), '0');
+                    std::memcpy(field, digits.data(), digits.size());
+                    field[width - 1] = '\0';
+                    return true;
+                }
+
+                static void pad(std::ostream& out, std::size_t written) {
+                    static const char zeros[block] = {};
+                    if (written % block) out.write(zeros, block - written % block);
+                }
+
+                // a pax record: "LENGTH key=value\n", LENGTH counting itself
+                static string record(sview key, sview value) {
+                    std::size_t body = key.size() + value.size() + 3;
+                    std::size_t length = body + std::to_string(body).size();
+                    if (std::to_string(length).size() != std::to_string(body).size()) length++;
+                    return std::format("{} {}={}\n", length, key, value);
+                }
+
+                static void header(std::ostream& out, sview name, sview prefix, char type, std::uint64_t size,
+                                   sview linkname, mode_t mode, const options& opts) {
+                    char h[block] = {};
+                    name.copy(h, 100);
+                    octal(h + 100, 8, mode & 07777);
+                    octal(h + 108, 8, opts.uid <= 07777777 ? opts.uid : 0);
+                    octal(h + 116, 8, opts.gid <= 07777777 ? opts.gid : 0);
+                    octal(h + 124, 12, size);
+                    octal(h + 136, 12, std::max<std::int64_t>(opts.mtime, 0));
+                    h[156] = type;
+                    linkname.copy(h + 157, 100);
+                    std::memcpy(h + 257, "ustar", 6);
+                    std::memcpy(h + 263, "00", 2);
+                    prefix.copy(h + 345, 155);
+
+                    // the checksum is taken with its own field as spaces
+                    std::memset(h + 148, ' ', 8);
+                    unsigned sum = 0;
+                    for (unsigned char c : h) sum += c;
+                    string digits = std::format("{:06o}", sum & 0777777);
+                    std::memcpy(h + 148, digits.data(), 6);
+                    h[154] = '\0';
+                    out.write(h, block);
+                }
+
+                // how many blocks it took
+                static std::size_t add(std::ostream& out, const member& m, const options& opts) {
+                    string path = m.dir() ? m.path + "/" : m.path;
+                    sview name = path;
+                    sview prefix;
+                    // ustar fits longer paths by splitting them at a slash
+                    if (path.size() > 100) {
+                        std::size_t slash = path.find('/', path.size() - 101);
+                        if (slash != string::npos && slash <= 155 && slash != 0 && path.size() - slash - 1 <= 100) {
+                            prefix = sview(path).substr(0, slash);
+                            name = sview(path).substr(slash + 1);
+                        } else {
+                            name = {};
+                        }
+                    }
+
+                    // whatever ustar can't hold goes in a pax header ahead of it
+                    std::size_t blocks = 1;
+                    string extended;
+                    if (name.empty() && !path.empty()) extended += record("path", path);
+                    if (m.target.size() > 100) extended += record("linkpath", m.target);
+                    if (opts.uid > 07777777) extended += record("uid", std::to_string(opts.uid));
+                    if (opts.gid > 07777777) extended += record("gid", std::to_string(opts.gid));
+                    if (!extended.empty()) {
+                        string paxname = "PaxHeaders/" + fs::path(m.path).filename().string();
+                        header(out, sview(paxname).substr(0, 100), {}, 'x', extended.size(), {}, 0644, opts);
+                        out.write(extended.data(), extended.size());
+                        pad(out, extended.size());
+                        blocks += 1 + (extended.size() + block - 1) / block;
+                    }
+                    if (name.empty()) {
+                        name = sview(path).substr(0, 100);
+                        prefix = {};
+                    }
+
+                    if (m.dir()) header(out, name, prefix, '5', 0, {}, opts.dirmode, opts);
+                    else header(out, name, prefix, '2', 0, m.target, 0777, opts);
+                    return blocks;
+                }
+
+                static void end(std::ostream& out, std::size_t blocks) {
+                    // two empty blocks, then up to a whole record of twenty
+                    static const char zeros[block] = {};
+                    blocks += 2;
+                    std::size_t total = blocks % 20 ? blocks + 20 - blocks % 20 : blocks;
+                    for (std::size_t i = blocks - 2; i < total; i++) out.write(zeros, block);
+                }
+
+            }; // END tar
+
+            namespace cpio {
+
+                static void pad(std::ostream& out, std::size_t written) {
+                    static const char zeros[4] = {};
+                    if (written % 4) out.write(zeros, 4 - written % 4);
+                }
+
+                // a "newc" header: its magic, then thirteen 8-digit hex fields
+                static void add(std::ostream& out, std::uint32_t ino, mode_t mode, std::uint32_t nlink, sview name,
+                                sview data, const options& opts) {
+                    string h = std::format("070701{:08x}{:08x}{:08x}{:08x}{:08x}{:08x}{:08x}{:08x}{:08x}{:08x}{:08x}{:08x}{:08x}",
+                        ino, static_cast<std::uint32_t>(mode), static_cast<std::uint32_t>(opts.uid), static_cast<std::uint32_t>(opts.gid),
+                        nlink, static_cast<std::uint32_t>(std::max<std::int64_t>(opts.mtime, 0)), data.size(),
+                        0, 0, 0, 0, name.size() + 1, 0);
+                    out.write(h.data(), h.size());
+                    out.write(name.data(), name.size());
+                    out.put('\0');
+                    pad(out, h.size() + name.size() + 1);
+                    out.write(data.data(), data.size());
+                    pad(out, data.size());
+                }
+
+            }; // END cpio
+
+            std::size_t write(std::ostream& out, const vector<link::entry>& entries, const options& opts) {
+                vector<member> all = members(entries);
+                std::size_t links = 0;
+
+                if (opts.kind == format::tar) {
+                    std::size_t blocks = 0;
+                    for (const auto& m : all) {
+                        blocks += tar::add(out, m, opts);
+                        if (!m.dir()) links++;
+                    }
+                    tar::end(out, blocks);
+                } else {
+                    std::uint32_t ino = 1;
+                    for (const auto& m : all) {
+                        if (m.dir()) {
+                            cpio::add(out, ino++, S_IFDIR | (opts.dirmode & 07777), 2, m.path, {}, opts);
+                        } else {
+                            cpio::add(out, ino++, S_IFLNK | 0777, 1, m.path, m.target, opts);
+                            links++;
+                        }
+                    }
+                    cpio::add(out, 0, 0, 1, "TRAILER!!!", {}, opts);
+                }
+                return links;
+            }
+
+            int run(sview path, const config::global::settings& globals, const vector<sview>& tags, const options& opts) {
+                if (isatty(STDOUT_FILENO)) {
+                    msg::error("not writing an archive to a terminal, redirect it to a file or a pipe");
+                    return 1;
+                }
+                config::local::settings conf = config::local::serialize(path, globals);
+                if (!conf.packages.empty())
+                    msg::warn("packages depend on what is already at each destination and are not archived");
+                vector<link::entry> entries = link::plan(conf, tags);
+
+                std::size_t links = write(std::cout, entries, opts);
+                std::cout.flush();
+                if (!std::cout) {
+                    msg::error("failed to write the archive");
+                    return 1;
+                }
+                msg::info("archived {} links", links);
+                return 0;
+            }
+
+        }; // END archive
+    }; // END actions
+}; // END confidant
@@ -0,0 +1,47 @@
+// SPDX-FileCopyrightText: 2026 Will Reed <wreed@disroot.org>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+#include <vector>
+
+#include <sys/types.h>
+
+#include "actions/link.hpp"
+#include "settings/global.hpp"
+
+using sview = std::string_view;
+using std::vector;
+
+namespace confidant {
+    namespace actions {
+        namespace archive {
+
+            enum class format { tar, cpio };
+
+            // what every member of the archive is given; the links themselves are
+            // always mode 0777, as symlinks are
+            struct options {
+                format kind = format::tar;
+                uid_t uid = 0;
+                gid_t gid = 0;
+                mode_t dirmode = 0755;
+                // for every member, so the same plan gives the same bytes
+                std::int64_t mtime = 0;
+            };
+
+            // a POSIX (pax) tar or a newc cpio stream of a symlink per entry, after
+            // the directories leading to them; only the plan is looked at, never
+            // the filesystem. copies and hardlinks, which would need the sources,
+            // and entries inside another entry's link are left out
+            std::size_t write(std::ostream& out, const vector<confidant::actions::link::entry>& entries, const options& opts);
+
+            // the 'archive' command, to standard output
+            int run(sview path, const confidant::config::global::settings& globals, const vector<sview>& tags, const options& opts);
+
+        }; // END archive
+    }; // END actions
+}; // END confidant
@@ -0,0 +1,201 @@
+// SPDX-FileCopyrightText: 2026 Will Reed <wreed@disroot.org>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "settings/global.hpp"
+#include "settings/local.hpp"
+#include "actions/check.hpp"
+#include "actions/link.hpp"
+#include "scan.hpp"
+#include "deploy.hpp"
+#include "listing.hpp"
+#include "util.hpp"
+#include "fmt.hpp"
+#include "msg.hpp"
+
+namespace fs = std::filesystem;
+
+using std::string;
+using std::vector;
+
+namespace confidant {
+    namespace actions {
+        namespace check {
+
+            static bool error(kind k) {
+                return k != kind::noparent && k != kind::conflict && k != kind::duplicate;
+            }
+
+            // whether what is at the destination would be left alone as someone else's
+            static bool taken(const link::entry& e, bool directory) {
+                std::error_code ec;
+                fs::file_status dest = listing::symlink_status(e.destination, ec);
+                if (ec || !fs::exists(dest)) return false;
+
+                const fs::path& target = e.target.empty() ? e.source : e.target;
+                bool placed = e.type == config::local::linktype::copy || e.type == config::local::linktype::hardlink;
+                if (fs::is_symlink(dest)) {
+                    if (fs::read_symlink(e.destination, ec) == target) return false;
+                    // a symlink only counts as ours by where it leads when it isn't placed
+                    return placed || !e.target.empty() || !fs::equivalent(e.source, e.destination, ec);
+                }
+                if (!placed) return true;
+                if (fs::is_directory(dest) != directory) return true;
+                // a hardlinked file is either the same inode or someone else's
+                if (e.type == config::local::linktype::hardlink && !directory)
+                    return !fs::equivalent(e.source, e.destination, ec);
+                // copies and trees are only refreshed when an earlier run placed them
+                if (!directory && deploy::identical(e.source, e.destination)) return false;
+                return !deploy::ours(e.destination);
+            }
+
+            static void inspect(const link::entry& e, std::size_t i, const config::global::settings& globals, vector<problem>& out) {
+                std::error_code ec;
+                fs::file_status source = scan::status(e.source, ec);
+                if (!fs::exists(source)) {
+                    out.push_back({kind::nosource, i});
+                    return;
+                }
+                bool directory = fs::is_directory(source);
+                if (!e.templated && e.type == config::local::linktype::directory && !directory)
+                    out.push_back({kind::notdirectory, i});
+
+                // the closest directory that's already there, which apply() builds on
+                fs::path parent = e.destination.parent_path();
+                fs::path existing = parent;
+                struct stat st;
+                int rc;
+                while ((rc = stat(existing.c_str(), &st)) != 0 && errno == ENOENT
+                       && existing.has_parent_path() && existing != existing.parent_path())
+                    existing = existing.parent_path();
+                if (rc != 0) {
+                    // can't even be looked at, let alone written to
+                    out.push_back({kind::unwritable, i, 0, existing});
+                    return;
+                }
+                if (!S_ISDIR(st.st_mode)) {
+                    out.push_back({kind::blocked, i, 0, existing});
+                    return;
+                }
+                if (existing != parent && !globals.createdirs) {
+                    out.push_back({kind::noparent, i});
+                    return;
+                }
+                if (access(existing.c_str(), W_OK) != 0)
+                    out.push_back({kind::unwritable, i, 0, existing});
+                struct stat src;
+                if (e.type == config::local::linktype::hardlink && stat(e.source.c_str(), &src) == 0 && st.st_dev != src.st_dev)
+                    out.push_back({kind::crossdevice, i});
+
+                if (globals.conflicts == config::global::conflict::skip && taken(e, directory))
+                    out.push_back({kind::conflict, i});
+            }
+
+            report validate(const vector<link::entry>& entries, const config::global::settings& globals, unsigned jobs) {
+                // each entry has a slot of its own, so workers never wait on one another
+                vector<vector<problem>> found(entries.size());
+
+                if (jobs == 0) jobs = std::max(1u, std::thread::hardware_concurrency());
+                jobs = std::min<unsigned>(jobs, std::max<std::size_t>(entries.size(), 1));
+                std::atomic<std::size_t> next = 0;
+                {
+                    vector<std::jthread> pool;
+                    pool.reserve(jobs);
+                    for (unsigned n = 0; n < jobs; n++) {
+                        pool.emplace_back([&] {
+                            for (std::size_t i; (i = next++) < entries.size();)
+                                inspect(entries[i], i, globals, found[i]);
+                        });
+                    }
+                }
+
+                // two entries sharing a destination is only visible across the plan; the
+                // plan has them in the order they're listed, and that's how they're applied
+                std::unordered_map<string, std::size_t> claimed;
+                for (std::size_t i = 0; i < entries.size(); i++) {
+                    auto [it, fresh] = claimed.try_emplace(entries[i].destination.lexically_normal().native(), i);
+                    if (!fresh) found[i].push_back({kind::duplicate, i, it->second});
+                }
+
+                report out;
+                for (auto& problems : found) {
+                    for (auto& p : problems) {
+                        if (error(p.what)) out.errors++;
+                        else out.warnings++;
+                        out.problems.push_back(std::move(p));
+                    }
+                }
+                return out;
+            }
+
+            void show(const vector<link::entry>& entries, const report& found) {
+                using util::unexpandhome;
+
+                for (const auto& p : found.problems) {
+                    const link::entry& e = entries[p.entry];
+                    string dest = unexpandhome(e.destination.string());
+                    switch (p.what) {
+                        case kind::nosource:
+                            msg::error("source {} of {} does not exist", fmt::ital(fs::relative(e.source).string()), fmt::bolden(e.name));
+                            break;
+                        case kind::notdirectory:
+                            msg::error("link {} source {} is not a directory", fmt::bolden(e.name), fmt::ital(fs::relative(e.source).string()));
+                            break;
+                        case kind::blocked:
+                            msg::error("{} can't be created, {} is not a directory", fmt::bolden(dest), fmt::ital(unexpandhome(p.path.string())));
+                            break;
+                        case kind::unwritable:
+                            msg::error("no write permissions for directory {}, needed for {}", fmt::bolden(unexpandhome(p.path.string())), fmt::ital(dest));
+                            break;
+                        case kind::crossdevice:
+                            msg::error("{} can't be hardlinked at {}, they are on different filesystems", fmt::bolden(e.name), fmt::ital(dest));
+                            break;
+                        case kind::noparent:
+                            msg::warn("parent directory for {} does not exist, it would be skipped", fmt::bolden(dest));
+                            break;
+                        case kind::conflict:
+                            msg::warn("destination {} already exists and is not identical to source, it would be skipped", fmt::bolden(dest));
+                            break;
+                        case kind::duplicate:
+                            msg::warn("{} and {} both link to {}, {} is applied first", fmt::bolden(entries[p.other].name), fmt::bolden(e.name),
+                                fmt::ital(dest), fmt::bolden(entries[p.other].name));
+                            break;
+                    }
+                }
+            }
+
+            bool clean(const report& found, bool strict) {
+                return found.errors == 0 && (!strict || found.warnings == 0);
+            }
+
+            int run(sview path, const config::global::settings& globals, const vector<sview>& tags, unsigned jobs, bool strict) {
+                config::local::settings conf = config::local::serialize(path, globals);
+                scan::warm(fs::path(path).parent_path(), jobs);
+                listing::enable();
+                vector<link::entry> entries = link::plan(conf, tags);
+                report found = validate(entries, globals, jobs);
+                show(entries, found);
+
+                if (found.problems.empty()) {
+                    msg::pretty("all {} entries can be applied", entries.size());
+                    return 0;
+                }
+                msg::pretty("{} errors and {} warnings in {} entries", found.errors, found.warnings, entries.size());
+                return clean(found, strict) ? 0 : 1;
+            }
+
+        }; // END check
+    }; // END actions
+}; // END confidant
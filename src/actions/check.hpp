@@ -0,0 +1,60 @@
+// SPDX-FileCopyrightText: 2026 Will Reed <wreed@disroot.org>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <string_view>
+#include <vector>
+
+#include "actions/link.hpp"
+#include "settings/global.hpp"
+#include "settings/local.hpp"
+
+using sview = std::string_view;
+using std::vector;
+
+namespace confidant {
+    namespace actions {
+        namespace check {
+
+            enum class kind {
+                nosource,     // error: the source doesn't exist
+                notdirectory, // error: 'type: directory' with a source that isn't one
+                blocked,      // error: something on the way to the destination isn't a directory
+                unwritable,   // error: the directory the destination goes in can't be written
+                crossdevice,  // error: a hardlink would have to cross filesystems
+                noparent,     // warning: the parent is missing and create-directories is off
+                conflict,     // warning: the destination is taken and would be skipped
+                duplicate     // warning: an earlier entry has the same destination, and goes first
+            };
+
+            struct problem {
+                kind what;
+                // the entry it's about, and for a duplicate, the one it clashes with
+                std::size_t entry;
+                std::size_t other = 0;
+                // the path at fault when it isn't the entry's own
+                std::filesystem::path path = {};
+            };
+
+            struct report {
+                vector<problem> problems;
+                std::size_t errors = 0;
+                std::size_t warnings = 0;
+            };
+
+            // look over every entry at once, up to `jobs` at a time (0 for one per
+            // processor), without touching anything; problems come in plan order
+            report validate(const vector<confidant::actions::link::entry>& entries, const confidant::config::global::settings& globals, unsigned jobs);
+            void show(const vector<confidant::actions::link::entry>& entries, const report& found);
+            // whether applying may go ahead: nothing is wrong, or only warnings unless `strict`
+            bool clean(const report& found, bool strict);
+
+            // the 'check' command
+            int run(sview path, const confidant::config::global::settings& globals, const vector<sview>& tags, unsigned jobs, bool strict);
+
+        }; // END check
+    }; // END actions
+}; // END confidant
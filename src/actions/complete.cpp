@@ -0,0 +1,286 @@
+// SPDX-FileCopyrightText: 2026 Will Reed <wreed@disroot.org>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "settings/global.hpp"
+#include "settings/local.hpp"
+#include "actions/complete.hpp"
+#include "digest.hpp"
+#include "msg.hpp"
+#include "util.hpp"
+#include "xdg.hpp"
+
+namespace fs = std::filesystem;
+
+using std::string;
+using std::vector;
+
+namespace confidant {
+    namespace actions {
+        namespace complete {
+
+            // bumped whenever the layout below changes
+            constexpr sview magic = "confidant-complete 1";
+
+            // the index starts with '<magic> <dev> <ino> <size> <mtime> <hash>' for
+            // the config it was built from, then one section per kind: a
+            // '<kind> <count>' line followed by that many 'word[\tdescription]' lines
+            struct stamp {
+                std::uint64_t dev = 0, ino = 0, size = 0, mtime = 0, hash = 0;
+            };
+
+            static bool read(const fs::path& path, string& out) {
+                int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+                if (fd < 0) return false;
+                struct stat st;
+                if (fstat(fd, &st) != 0) {
+                    close(fd);
+                    return false;
+                }
+                out.resize(st.st_size);
+                std::size_t got = 0;
+                while (got < out.size()) {
+                    ssize_t n = ::read(fd, out.data() + got, out.size() - got);
+                    if (n <= 0) break;
+                    got += n;
+                }
+                close(fd);
+                out.resize(got);
+                return true;
+            }
+
+            static bool identify(const fs::path& config, stamp& s) {
+                struct stat st;
+                if (stat(config.c_str(), &st) != 0) return false;
+                s.dev = st.st_dev;
+                s.ino = st.st_ino;
+                s.size = st.st_size;
+                s.mtime = std::uint64_t(st.st_mtim.tv_sec) * 1000000000ULL + std::uint64_t(st.st_mtim.tv_nsec);
+                return true;
+            }
+
+            static bool parse(sview header, stamp& s) {
+                if (!header.starts_with(magic)) return false;
+                const char* p = header.data() + magic.size();
+                const char* end = header.data() + header.size();
+                for (std::uint64_t* field : {&s.dev, &s.ino, &s.size, &s.mtime, &s.hash}) {
+                    while (p < end && *p == ' ') p++;
+                    auto res = std::from_chars(p, end, *field, 16);
+                    if (res.ec != std::errc()) return false;
+                    p = res.ptr;
+                }
+                return p == end;
+            }
+
+            static string header(const stamp& s) {
+                return std::format("{} {:x} {:x} {:x} {:x} {:016x}\n", magic, s.dev, s.ino, s.size, s.mtime, s.hash);
+            }
+
+            static void section(string& out, sview kind, const vector<std::pair<string, string>>& words) {
+                out += std::format("{} {}\n", kind, words.size());
+                for (const auto& [word, descr] : words) {
+                    out += word;
+                    if (!descr.empty()) {
+                        out += '\t';
+                        out += descr;
+                    }
+                    out += '\n';
+                }
+            }
+
+            static string build(sview config, const stamp& s) {
+                // only names matter here, so the global config isn't consulted, and
+                // nothing but the words may end up on stdout
+                config::global::loglevel = util::verbose::quiet;
+                config::local::settings conf;
+                try {
+                    msg::recoverable recover;
+                    conf = config::local::serialize(config, config::global::settings{});
+                } catch (const msg::failure&) {
+                    // a config that doesn't load has nothing to offer
+                    return {};
+                }
+
+                vector<std::pair<string, string>> links, templates, items, tags;
+                std::set<sview> tagged;
+                for (std::size_t i = 0; i < conf.links.size(); i++) {
+                    links.emplace_back(conf.links.name[i], conf.links.destination[i]);
+                    if (!conf.links.tag[i].empty()) tagged.insert(conf.links.tag[i]);
+                }
+                for (std::size_t i = 0; i < conf.templates.size(); i++) {
+                    templates.emplace_back(conf.templates.name[i], conf.templates.destination[i]);
+                    if (!conf.templates.tag[i].empty()) tagged.insert(conf.templates.tag[i]);
+                    for (sview item : conf.templates.items[i])
+                        items.emplace_back(item, conf.templates.name[i]);
+                }
+                for (sview tag : tagged) tags.emplace_back(tag, string());
+
+                string out = header(s);
+                section(out, "links", links);
+                section(out, "templates", templates);
+                section(out, "items", items);
+                section(out, "tags", tags);
+                return out;
+            }
+
+            static void save(const fs::path& path, sview index) {
+                std::error_code ec;
+                fs::create_directories(path.parent_path(), ec);
+                fs::path tmp = path;
+                tmp += std::format(".{}", getpid());
+                {
+                    std::ofstream out(tmp, std::ios::trunc | std::ios::binary);
+                    out.write(index.data(), index.size());
+                    if (!out) {
+                        fs::remove(tmp, ec);
+                        return;
+                    }
+                }
+                fs::rename(tmp, path, ec);
+            }
+
+            // the stamp only covers the config itself; what an include pulls in, what a
+            // 'when' tests and what a variable reads or runs can change without it, so
+            // configs that might use any of those are read every time. a word in a
+            // comment is enough to count, which only costs the caching
+            static bool cacheable(sview contents) {
+                for (sview word : {"include", ".load", "when", "variables"})
+                    if (contents.find(word) != sview::npos) return false;
+                return true;
+            }
+
+            // the index for `config`, brought up to date if it has to be
+            static string load(sview config) {
+                fs::path path = fs::absolute(fs::path(config));
+                stamp now;
+                if (!identify(path, now)) return {};
+
+                fs::path location;
+                try {
+                    location = xdg::homes().at("XDG_CACHE_HOME") / "confidant" / std::format("{}.complete", util::configkey(config));
+                } catch (...) {
+                    return build(config, now);
+                }
+
+                string index;
+                stamp was;
+                bool found = read(location, index);
+                sview first = sview(index).substr(0, sview(index).find('\n'));
+                if (found && parse(first, was) && was.dev == now.dev && was.ino == now.ino
+                    && was.size == now.size && was.mtime == now.mtime)
+                    return index;
+
+                // touched, or rewritten by an editor, but not necessarily changed
+                string contents;
+                if (!read(path, contents)) return {};
+                if (!cacheable(contents)) {
+                    // an index from before the config started depending on anything else
+                    std::error_code ec;
+                    if (found) fs::remove(location, ec);
+                    return build(config, now);
+                }
+                now.hash = digest::xxh64(contents.data(), contents.size());
+                if (found && parse(first, was) && was.hash == now.hash) {
+                    index.replace(0, first.size() + 1, header(now));
+                } else {
+                    index = build(config, now);
+                    if (index.empty()) return index;
+                }
+                save(location, index);
+                return index;
+            }
+
+            // the words of one section of the index
+            static vector<sview> words(sview index, sview kind) {
+                vector<sview> found;
+                std::size_t pos = index.find('\n');
+                while (pos != sview::npos && pos + 1 < index.size()) {
+                    sview rest = index.substr(pos + 1);
+                    sview line = rest.substr(0, rest.find('\n'));
+                    std::size_t space = line.rfind(' ');
+                    std::size_t count = 0;
+                    if (space == sview::npos) return found;
+                    std::from_chars(line.data() + space + 1, line.data() + line.size(), count);
+                    pos += line.size() + 1;
+                    bool wanted = line.substr(0, space) == kind;
+                    for (std::size_t i = 0; i < count && pos != sview::npos; i++) {
+                        std::size_t next = index.find('\n', pos + 1);
+                        if (wanted) found.push_back(index.substr(pos + 1, next - pos - 1));
+                        pos = next;
+                    }
+                    if (wanted) return found;
+                }
+                return found;
+            }
+
+            static sview word(sview line) {
+                return line.substr(0, line.find('\t'));
+            }
+
+            int run(sview config, sview what, sview prefix) {
+                string index = load(config);
+                string out;
+                auto offer = [&](sview head, sview line) {
+                    bool match = prefix.size() <= head.size()
+                        ? head.starts_with(prefix)
+                        : prefix.starts_with(head) && word(line).starts_with(prefix.substr(head.size()));
+                    if (!match) return;
+                    out += head;
+                    out += line;
+                    out += '\n';
+                };
+
+                if (what == "names") {
+                    for (sview line : words(index, "links")) offer("", line);
+                    for (sview line : words(index, "templates")) offer("", line);
+                } else if (what == "links" || what == "templates" || what == "items") {
+                    for (sview line : words(index, what)) offer("", line);
+                } else if (what == "tags") {
+                    // --tags takes a comma separated list; complete its last element
+                    sview head = prefix.substr(0, prefix.rfind(',') + 1);
+                    for (sview line : words(index, "tags")) offer(head, line);
+                } else if (what == "queries") {
+                    for (sview top : {"repository", "repository.url", "links", "templates"}) offer("", top);
+                    for (sview kind : {"links", "templates"}) {
+                        string head = string(kind) + ".";
+                        vector<sview> fields = kind == "links"
+                            ? vector<sview>{"source", "dest", "type", "tag"}
+                            : vector<sview>{"source", "dest", "items", "tag"};
+                        for (sview line : words(index, kind)) {
+                            sview name = word(line);
+                            offer(head, line);
+                            // fields only once the name is complete, instead of for every name
+                            sview rest = prefix.substr(std::min(prefix.size(), head.size()));
+                            if (!prefix.starts_with(head) || !rest.starts_with(name)
+                                || rest.size() <= name.size() || rest[name.size()] != '.')
+                                continue;
+                            string named = head + string(name) + ".";
+                            for (sview field : fields) offer(named, field);
+                        }
+                    }
+                } else {
+                    return 1;
+                }
+
+                std::fwrite(out.data(), 1, out.size(), stdout);
+                return 0;
+            }
+
+        }; // END complete
+    }; // END actions
+}; // END confidant
@@ -0,0 +1,25 @@
+// SPDX-FileCopyrightText: 2026 Will Reed <wreed@disroot.org>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <string_view>
+
+using sview = std::string_view;
+
+// words for the shell completions, answered from an index of the config kept
+// in $XDG_CACHE_HOME/confidant/<config key>.complete; the index is rebuilt
+// only when the config's contents change, so a TAB press never parses it.
+// configs that include others, or use 'when' or variables, aren't cached
+namespace confidant {
+    namespace actions {
+        namespace complete {
+
+            // `what` is one of links, templates, names (both), items, tags or
+            // queries (for 'config get'); prints those starting with `prefix`,
+            // one per line, with a description after a tab where there is one
+            int run(sview config, sview what, sview prefix);
+
+        }; // END complete
+    }; // END actions
+}; // END confidant
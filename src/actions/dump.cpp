@@ -1,13 +1,17 @@
 // SPDX-FileCopyrightText: 2026 Will Reed <wreed@disroot.org>
 // SPDX-License-Identifier: GPL-3.0-or-later
 
+#include <algorithm>
 #include <string_view>
 #include <utility>
-#include <print>
-#include "parse.hpp"
+#include <vector>
+#include <fnmatch.h>
+#include <unistd.h>
 #include "settings/local.hpp"
 #include "settings/global.hpp"
+#include "actions/dump.hpp"
 
+#include "emit.hpp"
 #include "util.hpp"
 #include "fmt.hpp"
 
@@ -17,71 +21,218 @@ using sview = std::string_view;
 namespace confidant {
     namespace actions {
         namespace dump {
-            
+
+            bool filter::matches(sview name, sview tag) const {
+                if (!tags.empty() && std::find(tags.begin(), tags.end(), tag) == tags.end())
+                    return false;
+                if (!this->name.empty() && fnmatch(this->name.c_str(), string(name).c_str(), 0) != 0)
+                    return false;
+                return true;
+            }
+
             namespace json {
-                void global(sview path) {
-                    auto input = ucl::parsing::file(path, std::map<string, string>{});
-                    std::cout << input.dump(ucl::emit::json) << std::endl;
+                // lists of names are left out when empty
+                template <typename List>
+                static void names(emit::json& js, sview key, const List& list) {
+                    if (list.empty()) return;
+                    js.key(key);
+                    js.open('[');
+                    for (const auto& n : list)
+                        js.value(n);
+                    js.close();
+                }
+
+                void global(const confidant::config::global::settings& conf) {
+                    emit::writer out(STDOUT_FILENO);
+                    emit::json js(out);
+                    js.open('{');
+                    js.key("create-directories");
+                    js.value(conf.createdirs);
+                    js.key("log-level");
+                    js.value(util::verboseliteral(conf.loglevel));
+                    js.key("color");
+                    js.value(conf.color);
+                    js.end();
                 }
-                void local(sview path) {
-                    auto input = ucl::parsing::file(path, util::makevarmap(path));
-                    std::cout << input.dump(ucl::emit::json) << std::endl;
+
+                void local(const confidant::config::local::settings& conf, const filter& only) {
+                    emit::writer out(STDOUT_FILENO);
+                    emit::json js(out);
+                    js.open('{');
+                    js.key("repository");
+                    js.open('{');
+                    js.key("url");
+                    js.value(conf.repo.url);
+                    js.close();
+
+                    js.key("links");
+                    js.open('{');
+                    for (const auto& link : conf.links) {
+                        if (!only.matches(link.name, link.tag)) continue;
+                        js.key(link.name);
+                        js.open('{');
+                        js.key("source");
+                        js.value(link.source);
+                        js.key("dest");
+                        js.value(link.destination);
+                        js.key("type");
+                        js.value(config::local::literal(link.type));
+                        if (!link.tag.empty()) {
+                            js.key("tag");
+                            js.value(link.tag);
+                        }
+                        names(js, "on-change", link.onchange);
+                        names(js, "after", link.after);
+                        names(js, "requires", link.needs);
+                        js.close();
+                    }
+                    js.close();
+
+                    js.key("templates");
+                    js.open('{');
+                    for (const auto& tmpl : conf.templates) {
+                        if (!only.matches(tmpl.name, tmpl.tag)) continue;
+                        js.key(tmpl.name);
+                        js.open('{');
+                        js.key("source");
+                        js.value(tmpl.source);
+                        js.key("dest");
+                        js.value(tmpl.destination);
+                        if (!tmpl.tag.empty()) {
+                            js.key("tag");
+                            js.value(tmpl.tag);
+                        }
+                        js.key("items");
+                        js.open('[');
+                        for (const auto& item : tmpl.items)
+                            js.value(item);
+                        js.close();
+                        names(js, "on-change", tmpl.onchange);
+                        names(js, "after", tmpl.after);
+                        names(js, "requires", tmpl.needs);
+                        js.close();
+                    }
+                    js.close();
+
+                    js.key("packages");
+                    js.open('{');
+                    for (const auto& pkg : conf.packages) {
+                        if (!only.matches(pkg.name, pkg.tag)) continue;
+                        js.key(pkg.name);
+                        js.open('{');
+                        js.key("source");
+                        js.value(pkg.source.native());
+                        js.key("dest");
+                        js.value(pkg.destination.native());
+                        if (!pkg.tag.empty()) {
+                            js.key("tag");
+                            js.value(pkg.tag);
+                        }
+                        js.close();
+                    }
+                    js.close();
+
+                    js.key("hooks");
+                    js.open('{');
+                    for (const auto& hook : conf.hooks) {
+                        if (!only.matches(hook.name, "")) continue;
+                        js.key(hook.name);
+                        js.open('{');
+                        js.key("run");
+                        js.value(hook.run);
+                        names(js, "after", hook.after);
+                        js.close();
+                    }
+                    js.close();
+                    js.end();
                 }
             }; // END json
 
+            template <typename List>
+            static void names(emit::writer& out, sview key, const List& list) {
+                if (list.empty()) return;
+                out.println("  {}:", fmt::fg::blue(key));
+                for (const auto& n : list)
+                    out.println("  - {}", fmt::fg::green(n));
+            }
+
             void global(const confidant::config::global::settings& conf) {
-                std::println("{}: {}", fmt::fg::blue("create-directories"), conf.createdirs);
-                std::println("{}: {}", fmt::fg::blue("log-level"), util::verboseliteral(conf.loglevel));
-                std::println("{}: {}", fmt::fg::blue("color"), conf.color);
+                emit::writer out(STDOUT_FILENO);
+                out.println("{}: {}", fmt::fg::blue("create-directories"), conf.createdirs);
+                out.println("{}: {}", fmt::fg::blue("log-level"), util::verboseliteral(conf.loglevel));
+                out.println("{}: {}", fmt::fg::blue("color"), conf.color);
             }
 
-    
-            void local(const confidant::config::local::settings& conf) {
-                std::println("{}:", fmt::fg::blue("repository"));
-                std::println("  {}: {}", fmt::fg::blue("url"), conf.repo.url);
-                int numlinks = conf.links.size();
-                int numtemplates = conf.templates.size();
-                if (numlinks > 0) {
-                    std::println("{}:", fmt::fg::blue("links"));
-                    for (int n = 0; n < numlinks; n++) {
-                        std::println("- {}: {}", fmt::fg::blue("name"), conf.links.at(n).name);
-                        std::println("  {}: {}", fmt::fg::blue("source"), conf.links.at(n).source.string());
-                        std::println("  {}: {}", fmt::fg::blue("destination"), conf.links.at(n).destination.string());
-                        if (!conf.links.at(n).tag.empty())
-                            std::println("  {}: {}", fmt::fg::blue("tag"), conf.links.at(n).tag);
-                        switch (conf.links.at(n).type) {
-                            case config::local::linktype::file:
-                                std::println("  {}: file", fmt::fg::blue("type"));
-                                break;
-                            case config::local::linktype::directory:
-                                std::println("  {}: directory", fmt::fg::blue("type"));
-                                break;
-                            default:
-                                // invalid or absent values will have been replaced with 'file'
-                                std::unreachable();
-                        }
+            void local(const confidant::config::local::settings& conf, const filter& only) {
+                emit::writer out(STDOUT_FILENO);
+                out.println("{}:", fmt::fg::blue("repository"));
+                out.println("  {}: {}", fmt::fg::blue("url"), conf.repo.url);
+
+                bool header = false;
+                for (const auto& link : conf.links) {
+                    if (!only.matches(link.name, link.tag)) continue;
+                    if (!header) {
+                        out.println("{}:", fmt::fg::blue("links"));
+                        header = true;
                     }
+                    out.println("- {}: {}", fmt::fg::blue("name"), link.name);
+                    out.println("  {}: {}", fmt::fg::blue("source"), link.source);
+                    out.println("  {}: {}", fmt::fg::blue("destination"), link.destination);
+                    if (!link.tag.empty())
+                        out.println("  {}: {}", fmt::fg::blue("tag"), link.tag);
+                    // invalid or absent values will have been replaced with 'file'
+                    out.println("  {}: {}", fmt::fg::blue("type"), config::local::literal(link.type));
+                    names(out, "on-change", link.onchange);
+                    names(out, "after", link.after);
+                    names(out, "requires", link.needs);
                 }
-                
-                if (numtemplates > 0) {
-                    std::println("{}:", fmt::fg::blue("templates"));
-                    for (int n = 0; n < numtemplates; n++) {
-                        string name = conf.templates.at(n).name;
-                        string src = conf.templates.at(n).source.string();
-                        string dst = conf.templates.at(n).destination.string();
-                        std::println("- {}: {}", fmt::fg::blue("name"), name);
-                        std::println("  {}: {}", fmt::fg::blue("source"), src);
-                        std::println("  {}: {}", fmt::fg::blue("destination"), dst);
-                        if (!conf.templates.at(n).tag.empty())
-                            std::println("  {}: {}", fmt::fg::blue("tag"), conf.templates.at(n).tag);
-                        int numitems = conf.templates.at(n).items.size();
-                        if (numitems > 0) {
-                            std::println("  {}:", fmt::fg::blue("items"));
-                            for (int x = 0; x < numitems; x++) {
-                                std::println("  - {}", fmt::fg::green(conf.templates.at(n).items.at(x)));
-                            }
-                        }
+
+                header = false;
+                for (const auto& tmpl : conf.templates) {
+                    if (!only.matches(tmpl.name, tmpl.tag)) continue;
+                    if (!header) {
+                        out.println("{}:", fmt::fg::blue("templates"));
+                        header = true;
+                    }
+                    out.println("- {}: {}", fmt::fg::blue("name"), tmpl.name);
+                    out.println("  {}: {}", fmt::fg::blue("source"), tmpl.source);
+                    out.println("  {}: {}", fmt::fg::blue("destination"), tmpl.destination);
+                    if (!tmpl.tag.empty())
+                        out.println("  {}: {}", fmt::fg::blue("tag"), tmpl.tag);
+                    if (!tmpl.items.empty()) {
+                        out.println("  {}:", fmt::fg::blue("items"));
+                        for (const auto& item : tmpl.items)
+                            out.println("  - {}", fmt::fg::green(item));
+                    }
+                    names(out, "on-change", tmpl.onchange);
+                    names(out, "after", tmpl.after);
+                    names(out, "requires", tmpl.needs);
+                }
+
+                header = false;
+                for (const auto& pkg : conf.packages) {
+                    if (!only.matches(pkg.name, pkg.tag)) continue;
+                    if (!header) {
+                        out.println("{}:", fmt::fg::blue("packages"));
+                        header = true;
+                    }
+                    out.println("- {}: {}", fmt::fg::blue("name"), pkg.name);
+                    out.println("  {}: {}", fmt::fg::blue("source"), pkg.source.native());
+                    out.println("  {}: {}", fmt::fg::blue("destination"), pkg.destination.native());
+                    if (!pkg.tag.empty())
+                        out.println("  {}: {}", fmt::fg::blue("tag"), pkg.tag);
+                }
+
+                header = false;
+                for (const auto& hook : conf.hooks) {
+                    if (!only.matches(hook.name, "")) continue;
+                    if (!header) {
+                        out.println("{}:", fmt::fg::blue("hooks"));
+                        header = true;
                     }
+                    out.println("- {}: {}", fmt::fg::blue("name"), hook.name);
+                    out.println("  {}: {}", fmt::fg::blue("run"), hook.run);
+                    names(out, "after", hook.after);
                 }
             }
         } // END dump
@@ -3,7 +3,9 @@
 
 #pragma once
 
+#include <string>
 #include <string_view>
+#include <vector>
 #include "settings/local.hpp"
 #include "settings/global.hpp"
 
@@ -12,12 +14,21 @@ using sview = std::string_view;
 namespace confidant {
     namespace actions {
         namespace dump {
+
+            // restricts which links/templates are emitted; an empty filter
+            // lets everything through
+            struct filter {
+                std::vector<sview> tags;
+                std::string name;
+                bool matches(sview name, sview tag) const;
+            };
+
             namespace json {
-                void global(sview path);
-                void local(sview path);
+                void global(const confidant::config::global::settings& conf);
+                void local(const confidant::config::local::settings& conf, const filter& only);
             }; // END json
             void global(const confidant::config::global::settings& conf);
-            void local(const confidant::config::local::settings& conf);
+            void local(const confidant::config::local::settings& conf, const filter& only);
         }; // END dump
     }; // END actions
 }; // END confidant
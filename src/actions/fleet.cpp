@@ -0,0 +1,249 @@
+// SPDX-FileCopyrightText: 2026 Will Reed <wreed@disroot.org>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/fsuid.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "settings/global.hpp"
+#include "settings/local.hpp"
+#include "actions/fleet.hpp"
+#include "actions/link.hpp"
+#include "util.hpp"
+#include "xdg.hpp"
+#include "fmt.hpp"
+#include "msg.hpp"
+
+namespace fs = std::filesystem;
+
+using sview = std::string_view;
+using std::string;
+using std::vector;
+using std::optional;
+using std::nullopt;
+
+namespace confidant {
+    namespace actions {
+        namespace fleet {
+
+            // the config is parsed once with these standing in for ${home} and
+            // ${user}; each root then only swaps in its own values
+            constexpr sview homemark = "/@confidant:home@";
+            constexpr sview usermark = "@confidant:user@";
+            // and ${xdg_runtime_dir}, which is named after the uid rather than under the home
+            constexpr sview runmark = "/@confidant:runtime@";
+
+            template <typename T>
+            static bool number(sview s, T& out) {
+                auto [p, ec] = std::from_chars(s.data(), s.data() + s.size(), out);
+                return ec == std::errc() && p == s.data() + s.size();
+            }
+
+            vector<root> roots(sview path) {
+                std::ifstream file;
+                std::istream* in = &std::cin;
+                if (path != "-") {
+                    file.open(fs::path(path));
+                    if (!file.is_open())
+                        msg::fatal("failed to open {}", fmt::bolden(path));
+                    in = &file;
+                }
+
+                vector<root> found;
+                string line;
+                int lineno = 0;
+                while (std::getline(*in, line)) {
+                    lineno++;
+                    if (auto hash = line.find('#'); hash != string::npos) line.erase(hash);
+
+                    std::istringstream fields(line);
+                    vector<string> parts;
+                    for (string part; fields >> part;) parts.push_back(part);
+                    if (parts.empty()) continue;
+
+                    root r;
+                    if (parts.size() < 3 || parts.size() > 4
+                        || !number(parts[1], r.uid) || !number(parts[2], r.gid)
+                        || !fs::path(parts[0]).is_absolute()) {
+                        msg::fatal("{} line {}: expected 'HOME UID GID [USER]' with an absolute HOME", fmt::bolden(path), lineno);
+                    }
+                    r.home = fs::path(parts[0]).lexically_normal();
+                    r.user = parts.size() == 4 ? parts[3] : r.home.filename().string();
+                    found.push_back(r);
+                }
+                return found;
+            }
+
+            static string replaced(string s, sview mark, sview with) {
+                size_t pos = 0;
+                while ((pos = s.find(mark, pos)) != string::npos) {
+                    s.replace(pos, mark.size(), with);
+                    pos += with.size();
+                }
+                return s;
+            }
+
+            static string rebased(const string& s, const root& r) {
+                string out = replaced(s, homemark, r.home.native());
+                out = replaced(out, runmark, std::format("/run/user/{}", r.uid));
+                return replaced(out, usermark, r.user);
+            }
+
+            static optional<link::entry> rebase(const link::entry& e, const root& r) {
+                sview dest = e.destination.native();
+                if (!dest.starts_with(homemark) && !dest.starts_with(runmark)) return nullopt;
+                link::entry out = e;
+                out.destination = fs::path(rebased(e.destination.native(), r));
+                out.source = fs::path(rebased(e.source.native(), r));
+                return out;
+            }
+
+            // while alive, the calling thread reaches the filesystem as the root's
+            // owner, so a symlink planted in a home can't steer a privileged write
+            // outside of it; the kernel keeps these ids, and the groups, per thread
+            class identity {
+            public:
+                explicit identity(const root& r) {
+                    if (geteuid() != 0) return;
+                    privileged = true;
+                    groups.resize(std::max(getgroups(0, nullptr), 0));
+                    if (getgroups(int(groups.size()), groups.data()) < 0) groups.clear();
+                    // glibc's setgroups() would change every thread, not just this one
+                    if (syscall(SYS_setgroups, 0, nullptr) != 0) return;
+                    setfsgid(r.gid);
+                    setfsuid(r.uid);
+                    // both return the previous id; an invalid one only asks for the current
+                    dropped = setfsuid(uid_t(-1)) == int(r.uid) && setfsgid(gid_t(-1)) == int(r.gid);
+                }
+
+                ~identity() {
+                    if (!privileged) return;
+                    setfsuid(geteuid());
+                    setfsgid(getegid());
+                    syscall(SYS_setgroups, groups.size(), groups.data());
+                }
+
+                identity(const identity&) = delete;
+                identity& operator=(const identity&) = delete;
+
+                // running as root without having become the owner would be unsafe
+                bool refused() const { return privileged && !dropped; }
+                // anything created is then the owner's already
+                bool owned() const { return dropped; }
+
+            private:
+                bool privileged = false;
+                bool dropped = false;
+                vector<gid_t> groups;
+            };
+
+            // hand a freshly created link, and any directories made for it, to the root's owner
+            static bool chown(const fs::path& top, const fs::path& dest, const root& r) {
+                bool ok = true;
+                if (!top.empty()) {
+                    fs::path dir = top;
+                    fs::path rest = dest.parent_path().lexically_relative(top);
+                    auto part = rest.begin();
+                    for (;;) {
+                        if (fchownat(AT_FDCWD, dir.c_str(), r.uid, r.gid, AT_SYMLINK_NOFOLLOW) != 0) ok = false;
+                        if (part == rest.end() || *part == ".") break;
+                        dir /= *part++;
+                    }
+                }
+                if (fchownat(AT_FDCWD, dest.c_str(), r.uid, r.gid, AT_SYMLINK_NOFOLLOW) != 0) ok = false;
+                return ok;
+            }
+
+            static bool apply(const vector<link::entry>& entries, const config::global::settings& globals, const root& r, bool dry) {
+                identity as(r);
+                if (as.refused()) {
+                    msg::error("failed to take on the identity of {}:{} for {}, skipping it",
+                        r.uid, r.gid, fmt::bolden(r.home.string()));
+                    return false;
+                }
+
+                int linked = 0;
+                bool owned = true;
+                for (const auto& planned : entries) {
+                    auto e = rebase(planned, r);
+                    if (!e) {
+                        msg::warn("destination {} of {} is outside of the home and runtime directories, skipping",
+                            fmt::bolden(planned.destination.string()), fmt::bolden(planned.name));
+                        continue;
+                    }
+
+                    // the outermost directory apply() is about to create
+                    fs::path top;
+                    std::error_code ec;
+                    for (fs::path dir = e->destination.parent_path(); !dir.empty() && !fs::exists(dir, ec); dir = dir.parent_path()) {
+                        top = dir;
+                        if (dir == dir.parent_path()) break;
+                    }
+
+                    link::result res = link::apply(e.value(), globals, dry);
+                    if (res == link::result::fatal) return false;
+                    if (res != link::result::linked) continue;
+                    linked++;
+                    if (!dry && !as.owned() && !chown(top, e->destination, r)) owned = false;
+                }
+                if (!owned)
+                    msg::error("failed to change ownership of links under {} to {}:{}",
+                        fmt::bolden(r.home.string()), r.uid, r.gid);
+                msg::pretty("applied {} links under {}", linked, fmt::bolden(r.home.string()));
+                return owned;
+            }
+
+            int run(sview path, const config::global::settings& globals, const vector<sview>& tags,
+                    const vector<root>& roots, unsigned jobs, bool dry) {
+
+                // parse and expand templates once, for every root
+                auto homes = xdg::homes(fs::path(homemark), 0);
+                homes.insert_or_assign("XDG_RUNTIME_DIR", fs::path(runmark));
+                variables::resolver vars(path, std::move(homes), homemark, usermark);
+                config::local::settings conf = config::local::serialize(path, globals, vars);
+                vector<link::entry> entries = link::plan(conf, tags);
+                if (!conf.packages.empty())
+                    msg::warn("packages depend on what is already in each home and are not applied with {}", fmt::bolden("--roots"));
+
+                if (jobs == 0) jobs = std::max(1u, std::thread::hardware_concurrency());
+                jobs = std::min<unsigned>(jobs, std::max<size_t>(roots.size(), 1));
+
+                std::atomic<size_t> next = 0;
+                std::atomic<int> failed = 0;
+                {
+                    vector<std::jthread> pool;
+                    pool.reserve(jobs);
+                    for (unsigned n = 0; n < jobs; n++) {
+                        pool.emplace_back([&] {
+                            for (size_t r; (r = next++) < roots.size();) {
+                                if (!apply(entries, globals, roots[r], dry)) failed++;
+                            }
+                        });
+                    }
+                }
+
+                if (failed > 0) {
+                    msg::error("{} of {} roots failed", failed.load(), roots.size());
+                    return 1;
+                }
+                return 0;
+            }
+
+        }; // END fleet
+    }; // END actions
+}; // END confidant
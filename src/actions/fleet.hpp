@@ -0,0 +1,39 @@
+// SPDX-FileCopyrightText: 2026 Will Reed <wreed@disroot.org>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <sys/types.h>
+
+#include "settings/global.hpp"
+
+using sview = std::string_view;
+using std::string;
+using std::vector;
+
+namespace confidant {
+    namespace actions {
+        namespace fleet {
+
+            // a home directory to link into, and who should own the result
+            struct root {
+                std::filesystem::path home;
+                uid_t uid;
+                gid_t gid;
+                string user;
+            };
+
+            // one root per line: 'HOME UID GID [USER]', '#' starts a comment;
+            // USER defaults to the last component of HOME
+            vector<root> roots(sview path);
+            int run(sview path, const confidant::config::global::settings& globals, const vector<sview>& tags,
+                    const vector<root>& roots, unsigned jobs, bool dry);
+
+        }; // END fleet
+    }; // END actions
+}; // END confidant
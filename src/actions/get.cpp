@@ -48,7 +48,7 @@ namespace confidant {
                 
                 if (parts.at(0) == "links") {
                     if (parts.size() == 1) {
-                        return conf.links;
+                        return vector<config::local::link>(conf.links.begin(), conf.links.end());
                     }
                     if (parts.size() == 2) {
                         for (const auto& link : conf.links) 
@@ -58,12 +58,12 @@ namespace confidant {
                     if (parts.size() == 3) {
                         for (const auto& link : conf.links) {
                             if (link.name == parts.at(1)) {
-                                if (parts.at(2) == "source") return link.source.string();
-                                if (parts.at(2) == "dest") return link.destination.string();
+                                if (parts.at(2) == "source") return string(link.source);
+                                if (parts.at(2) == "dest") return string(link.destination);
                                 if (parts.at(2) == "type")
-                                    return link.type == config::local::linktype::file ? "file" : "directory";
+                                    return string(config::local::literal(link.type));
                                 if (parts.at(2) == "tag" && !link.tag.empty())
-                                    return link.tag;
+                                    return string(link.tag);
                             }
                         }
                     }
@@ -71,18 +71,18 @@ namespace confidant {
                 }
                 
                 if (parts.at(0) == "templates") {
-                    if (parts.size() == 1) return conf.templates;
+                    if (parts.size() == 1) return vector<config::local::templatelink>(conf.templates.begin(), conf.templates.end());
                     if (parts.size() >= 2) {
                         for (const auto& tmpl : conf.templates) {
                             if (tmpl.name == parts.at(1)) {
                                 if (parts.size() == 2) return tmpl;
                                 
                                 if (parts.size() == 3) {
-                                    if (parts.at(2) == "source") return tmpl.source.string();
-                                    if (parts.at(2) == "dest") return tmpl.destination.string();
-                                    if (parts.at(2) == "items") return tmpl.items;
+                                    if (parts.at(2) == "source") return string(tmpl.source);
+                                    if (parts.at(2) == "dest") return string(tmpl.destination);
+                                    if (parts.at(2) == "items") return vector<string>(tmpl.items.begin(), tmpl.items.end());
                                     if (parts.at(2) == "tag" && !tmpl.tag.empty())
-                                        return tmpl.tag;
+                                        return string(tmpl.tag);
                                 }
                             }
                         }
@@ -130,27 +130,27 @@ namespace confidant {
                         std::ostringstream oss;
                         for (const auto& link : arg) {
                             oss << link.name << ":\n";
-                            oss << "  source: " << link.source.string() << "\n";
-                            oss << "  dest: " << link.destination.string() << "\n";
-                            oss << "  type: " << (link.type == config::local::linktype::file ? "file" : "directory") << "\n";
+                            oss << "  source: " << link.source << "\n";
+                            oss << "  dest: " << link.destination << "\n";
+                            oss << "  type: " << config::local::literal(link.type) << "\n";
                             if (!link.tag.empty()) oss << "  tag: " << link.tag << "\n";
                         }
                         return oss.str();
                     }
                     else if constexpr (std::is_same_v<T, config::local::link>) {
                         std::ostringstream oss;
-                        oss << "source: " << arg.source.string() << "\n";
-                        oss << "dest: " << arg.destination.string() << "\n";
+                        oss << "source: " << arg.source << "\n";
+                        oss << "dest: " << arg.destination << "\n";
                         if (!arg.tag.empty()) oss << "tag: " << arg.tag << "\n";
-                        oss << "type: " << (arg.type == config::local::linktype::file ? "file" : "directory");
+                        oss << "type: " << config::local::literal(arg.type);
                         return oss.str();
                     }
                     else if constexpr (std::is_same_v<T, vector<config::local::templatelink>>) {
                         std::ostringstream oss;
                         for (const auto& tmpl : arg) {
                             oss << tmpl.name << ":\n";
-                            oss << "  source: " << tmpl.source.string() << "\n";
-                            oss << "  dest: " << tmpl.destination.string() << "\n";
+                            oss << "  source: " << tmpl.source << "\n";
+                            oss << "  dest: " << tmpl.destination << "\n";
                             if (!tmpl.tag.empty()) oss << "  tag: " << tmpl.tag << "\n";
                             oss << "  items: [" << tmpl.items.size() << " items]\n";
                         }
@@ -158,8 +158,8 @@ namespace confidant {
                     }
                     else if constexpr (std::is_same_v<T, config::local::templatelink>) {
                         std::ostringstream oss;
-                        oss << "source: " << arg.source.string() << "\n";
-                        oss << "dest: " << arg.destination.string() << "\n";
+                        oss << "source: " << arg.source << "\n";
+                        oss << "dest: " << arg.destination << "\n";
                         if (!arg.tag.empty()) oss << "tag: " << arg.tag << "\n";
                         oss << "items:\n";
                         for (const auto& item : arg.items) {
@@ -0,0 +1,165 @@
+// SPDX-FileCopyrightText: 2026 Will Reed <wreed@disroot.org>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "settings/local.hpp"
+#include "actions/hooks.hpp"
+#include "graph.hpp"
+#include "fmt.hpp"
+#include "msg.hpp"
+
+extern char** environ;
+
+using std::string;
+using std::vector;
+
+namespace confidant {
+    namespace actions {
+        namespace hooks {
+
+            static pid_t spawn(const config::local::hook& h) {
+                const char* argv[] = {"/bin/sh", "-c", h.run.c_str(), nullptr};
+                pid_t pid;
+                int err = posix_spawn(&pid, "/bin/sh", nullptr, nullptr, const_cast<char* const*>(argv), environ);
+                if (err != 0) {
+                    msg::error("failed to start hook {}: {}", fmt::bolden(h.name), std::strerror(err));
+                    return -1;
+                }
+                return pid;
+            }
+
+            int run(const config::local::settings& conf, const std::set<string>& fired, unsigned jobs, bool dry) {
+                return run(conf.hooks, fired, jobs, dry);
+            }
+
+            int run(const vector<config::local::hook>& hooks, const std::set<string>& fired, unsigned jobs, bool dry) {
+                if (fired.empty()) return 0;
+
+                // only the fired hooks, in the order the config gives them
+                vector<const config::local::hook*> chosen;
+                std::unordered_map<string, size_t> index;
+                for (const auto& h : hooks) {
+                    if (!fired.contains(h.name)) continue;
+                    index.emplace(h.name, chosen.size());
+                    chosen.push_back(&h);
+                }
+
+                // 'after' on a hook that didn't fire is nothing to wait for
+                size_t n = chosen.size();
+                graph::edges before(n);
+                vector<vector<size_t>> dependents(n);
+                for (size_t i = 0; i < n; i++) {
+                    for (const auto& a : chosen[i]->after) {
+                        auto it = index.find(a);
+                        if (it == index.end()) continue;
+                        before[i].push_back(it->second);
+                        dependents[it->second].push_back(i);
+                    }
+                }
+
+                if (dry) {
+                    // serialize() already refused cycles
+                    for (size_t i : graph::sort(before).order)
+                        msg::pretty("would run hook {}: {}", fmt::bolden(chosen[i]->name), chosen[i]->run);
+                    return 0;
+                }
+
+                // one per processor by default, the same as the entries themselves
+                if (jobs == 0) jobs = std::max(1u, std::thread::hardware_concurrency());
+
+                vector<size_t> waiting(n);
+                vector<bool> doomed(n, false);
+                std::deque<size_t> ready;
+                for (size_t i = 0; i < n; i++) {
+                    waiting[i] = before[i].size();
+                    if (waiting[i] == 0) ready.push_back(i);
+                }
+
+                std::map<pid_t, size_t> running;
+                int failed = 0;
+
+                // a finished (or abandoned) hook releases whatever waited on it
+                auto finish = [&](size_t done, bool ok) {
+                    vector<std::pair<size_t, bool>> stack{{done, ok}};
+                    while (!stack.empty()) {
+                        auto [i, fine] = stack.back();
+                        stack.pop_back();
+                        for (size_t d : dependents[i]) {
+                            if (!fine) doomed[d] = true;
+                            if (--waiting[d] != 0) continue;
+                            if (!doomed[d]) {
+                                ready.push_back(d);
+                            } else {
+                                msg::warn("skipping hook {}, a hook it runs after failed", fmt::bolden(chosen[d]->name));
+                                failed++;
+                                stack.emplace_back(d, false);
+                            }
+                        }
+                    }
+                };
+
+                while (!ready.empty() || !running.empty()) {
+                    while (!ready.empty() && running.size() < jobs) {
+                        size_t i = ready.front();
+                        ready.pop_front();
+                        msg::info("running hook {}", fmt::bolden(chosen[i]->name));
+                        pid_t pid = spawn(*chosen[i]);
+                        if (pid < 0) {
+                            failed++;
+                            finish(i, false);
+                            continue;
+                        }
+                        running.emplace(pid, i);
+                    }
+                    if (running.empty()) continue;
+
+                    int status;
+                    pid_t pid = waitpid(-1, &status, 0);
+                    if (pid < 0) {
+                        if (errno == EINTR) continue;
+                        msg::error("failed to wait for hooks: {}", std::strerror(errno));
+                        return 1;
+                    }
+                    auto it = running.find(pid);
+                    if (it == running.end()) continue;
+                    size_t i = it->second;
+                    running.erase(it);
+
+                    bool ok = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+                    if (!ok) {
+                        failed++;
+                        if (WIFEXITED(status))
+                            msg::error("hook {} exited with status {}", fmt::bolden(chosen[i]->name), WEXITSTATUS(status));
+                        else
+                            msg::error("hook {} was killed by signal {}", fmt::bolden(chosen[i]->name), WTERMSIG(status));
+                    } else {
+                        msg::trace("hook {} finished", chosen[i]->name);
+                    }
+                    finish(i, ok);
+                }
+
+                if (failed > 0) {
+                    msg::error("{} of {} hooks failed or were skipped", failed, n);
+                    return 1;
+                }
+                msg::pretty("ran {} hooks", n);
+                return 0;
+            }
+
+        }; // END hooks
+    }; // END actions
+}; // END confidant
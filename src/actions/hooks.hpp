@@ -0,0 +1,26 @@
+// SPDX-FileCopyrightText: 2026 Will Reed <wreed@disroot.org>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include "settings/local.hpp"
+
+using std::string;
+
+namespace confidant {
+    namespace actions {
+        namespace hooks {
+
+            // run each fired hook once with 'sh -c', up to `jobs` at a time (0 for one
+            // per processor); a hook waits for whichever of its 'after' hooks fired too, and
+            // is skipped when one of them failed
+            int run(const confidant::config::local::settings& conf, const std::set<string>& fired, unsigned jobs, bool dry);
+            int run(const std::vector<confidant::config::local::hook>& hooks, const std::set<string>& fired, unsigned jobs, bool dry);
+
+        }; // END hooks
+    }; // END actions
+}; // END confidant
@@ -1,17 +1,37 @@
 // SPDX-FileCopyrightText: 2026 Will Reed <wreed@disroot.org>
 // SPDX-License-Identifier: GPL-3.0-or-later
 
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
 #include <filesystem>
+#include <format>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <span>
+#include <system_error>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 #include <string_view>
 
 #include "settings/global.hpp"
 #include "util.hpp"
+#include "deploy.hpp"
+#include "journal.hpp"
+#include "digest.hpp"
+#include "scan.hpp"
+#include "listing.hpp"
+#include "graph.hpp"
 #include "fmt.hpp"
 #include "msg.hpp"
 #include "settings/local.hpp"
+#include "actions/link.hpp"
 
 namespace fs = std::filesystem;
 
@@ -20,297 +40,583 @@ using std::string;
 using std::vector;
 
 namespace confidant {
-    
+
     namespace actions {
-        
+
         namespace link {
-        
-            int linktemplate(const confidant::config::local::settings& conf, const confidant::config::global::settings& globals, const vector<sview>& tags, bool dry) {
-                int processedTemplates = 0;
-                for (auto& tmpl : conf.templates) {
-              
-                    int processedItems = 0;
-                    int numitems = tmpl.items.size();
-                    
-                    if (!tmpl.tag.empty() && tags.size() == 0) continue;
-                    if (!tmpl.tag.empty() && tags.size() > 0) {
-                        bool matches = std::find(tags.begin(), tags.end(), tmpl.tag) != tags.end();
-                        if (!matches) continue;
+
+            bool tagged(sview tag, const vector<sview>& tags) {
+                // untagged entries always apply, tagged ones only when requested
+                if (tag.empty()) return true;
+                return std::find(tags.begin(), tags.end(), tag) != tags.end();
+            }
+
+            // before[i] holds the entries i comes after; needed[i] those it can't do without
+            static graph::edges depends(const vector<entry>& entries, vector<vector<size_t>>* needed = nullptr) {
+                std::unordered_map<sview, vector<size_t>> named;
+                std::unordered_map<string, vector<size_t>> placed;
+                for (size_t i = 0; i < entries.size(); i++) {
+                    named[entries[i].name].push_back(i);
+                    placed[entries[i].destination.lexically_normal().native()].push_back(i);
+                }
+
+                graph::edges before(entries.size());
+                if (needed) needed->assign(entries.size(), {});
+                for (size_t i = 0; i < entries.size(); i++) {
+                    const entry& e = entries[i];
+                    // names left out by tags have nothing to wait for
+                    for (const auto& name : e.after) {
+                        if (auto it = named.find(name); it != named.end())
+                            before[i].insert(before[i].end(), it->second.begin(), it->second.end());
                     }
-                    
-                    for (int n = 0; n < numitems; n++) {
-                        
-                        string sourcestr = util::substitute(tmpl.source.string() , tmpl.items.at(n));
-                        string deststr   = util::substitute(tmpl.destination.string(), tmpl.items.at(n));
-                        
-                        fs::path sourcepath = fs::path(sourcestr);
-                        fs::path destpath = fs::path(deststr);
-                        
-                        string usourcestr = fs::relative(fs::path(sourcestr)).string();
-                        string udeststr = util::unexpandhome(deststr);
-                        
-                        if (!fs::exists(sourcepath)) {
-                            msg::error("source file {} does not exist!",
-                                fmt::bolden(usourcestr));
-                            continue;
-                        }
-                        
-                        if (fs::exists(destpath)) {
-                            if (fs::equivalent(sourcepath, destpath)) {
-                                msg::extra("skipping {}, already linked", fmt::bolden(udeststr));
-                                continue;
-                            }
-                            msg::warn("destination {} already exists, skipping",
-                                fmt::bolden(udeststr));
-                            continue;
-                        
-                        } else if (fs::is_symlink(destpath) && !fs::exists(destpath)) {
-                            // it's a broken symlink, remove it
-                            if (!dry) {
-                                try {
-                                    fs::remove(destpath);
-                                } catch (const fs::filesystem_error& e) {
-                                    msg::error("failed to remove broken symlink at {}", fmt::bolden(deststr));
-                                    std::cout << e.what() << std::endl;
-                                    std::exit(1);
-                                }
-                            } else {
-                                msg::warnextra("removing broken symlink at {}", fmt::bolden(deststr));
-                            }
-                        }
-                        
-                        if (!fs::exists(destpath.parent_path())) {
-                            if (!globals.createdirs) {
-                                msg::warn("parent directory for {} doesn't exist, skipping", fmt::bolden(udeststr));
-                                continue;
-                            } else {
-                                if (!dry) {
-                                    try {
-                                        fs::create_directories(destpath.parent_path());
-                                    } catch (const fs::filesystem_error& err) {
-                                        msg::error("failed to create directory {}",
-                                            fmt::bolden(util::unexpandhome(destpath.parent_path().string())));
-                                        std::cout << err.what() << std::endl;
-                                        return 1;
-                                    }
-                                }
-                                msg::extra("created directory {}",
-                                    fmt::bolden(util::unexpandhome(destpath.parent_path().string())));
-                            }
-                        }
-                        
-                        if (!util::hasperms(deststr) && !dry) {
-                            msg::error("no write permissions for directory {}",
-                                fmt::bolden(util::unexpandhome(destpath.parent_path().string())));
-                            continue;
+                    for (const auto& name : e.needs) {
+                        auto it = named.find(name);
+                        if (it == named.end()) continue;
+                        before[i].insert(before[i].end(), it->second.begin(), it->second.end());
+                        if (needed) (*needed)[i].insert((*needed)[i].end(), it->second.begin(), it->second.end());
+                    }
+                    // entries sharing a destination go in the order they're listed, so the
+                    // same one wins every run; the one just before is enough
+                    fs::path dest = e.destination.lexically_normal();
+                    const vector<size_t>& same = placed[dest.native()];
+                    if (auto it = std::find(same.begin(), same.end(), i); it != same.begin())
+                        before[i].push_back(*std::prev(it));
+                    // whatever is placed where this one goes has to be there first;
+                    // the nearest such destination is enough, it waits on the rest
+                    for (fs::path dir = dest.parent_path(); !dir.empty(); dir = dir.parent_path()) {
+                        if (auto it = placed.find(dir.native()); it != placed.end()) {
+                            before[i].insert(before[i].end(), it->second.begin(), it->second.end());
+                            break;
                         }
-                        
-                        if (fs::status(sourcepath).type() == fs::file_type::directory) {
-                            if (!dry) {
-                                try {
-                                    // create the link
-                                    fs::create_directory_symlink(sourcepath, destpath);
-                                } catch (const fs::filesystem_error& err) {
-                                    msg::error("failed to create symlink at {}", fmt::bolden(udeststr));
-                                    std::cout << err.what() << std::endl;
-                                    return 1;
-                                }
+                        if (dir == dir.parent_path()) break;
+                    }
+                }
+                return before;
+            }
+
+            static string circle(const vector<entry>& entries, const vector<size_t>& cycle) {
+                string loop;
+                for (size_t i : cycle) loop += entries[i].destination.string() + " -> ";
+                loop += entries[cycle.front()].destination.string();
+                return loop;
+            }
+
+            static vector<string> owned(std::span<const sview> names) {
+                return vector<string>(names.begin(), names.end());
+            }
+
+            vector<entry> plan(const config::local::settings& conf, const vector<sview>& tags) {
+                vector<entry> entries;
+                entries.reserve(conf.links.size());
+
+                // tags are checked on their column alone, and only the rows that pass put together
+                for (size_t i = 0; i < conf.links.size(); i++) {
+                    if (!tagged(conf.links.tag[i], tags)) continue;
+                    auto link = conf.links[i];
+                    entries.push_back(entry{string(link.name), fs::path(link.source), fs::path(link.destination), link.type, false, {},
+                                            owned(link.onchange), owned(link.after), owned(link.needs)});
+                }
+
+                for (size_t i = 0; i < conf.templates.size(); i++) {
+                    if (!tagged(conf.templates.tag[i], tags)) continue;
+                    auto tmpl = conf.templates[i];
+                    for (sview item : tmpl.items) {
+                        entries.push_back(entry{
+                            string(tmpl.name),
+                            fs::path(util::substitute(tmpl.source, item)),
+                            fs::path(util::substitute(tmpl.destination, item)),
+                            config::local::linktype::file,
+                            true,
+                            {},
+                            owned(tmpl.onchange),
+                            owned(tmpl.after),
+                            owned(tmpl.needs)
+                        });
+                    }
+                }
+
+                // serialize() ruled out loops between names, but nesting can still close one
+                auto sorted = graph::sort(depends(entries));
+                if (!sorted.cycle.empty())
+                    msg::fatal("entries can't come after one another in a circle: {}", fmt::bolden(circle(entries, sorted.cycle)));
+                vector<entry> ordered;
+                ordered.reserve(entries.size());
+                for (size_t i : sorted.order) ordered.push_back(std::move(entries[i]));
+                return ordered;
+            }
+
+            // create missing parents of a destination; nullopt when it's fine to carry on
+            static std::optional<result> prepare(const entry& e, const config::global::settings& globals, bool dry, journal::writer* log) {
+                using util::unexpandhome;
+
+                const fs::path& destpath = e.destination;
+                string deststr = destpath.string();
+
+                if (!listing::exists(destpath.parent_path())) {
+                    if (!globals.createdirs) {
+                        // parent path doesn't exist and settings to create dirs is off
+                        msg::warn("parent directory for {} does not exist, skipping",
+                            fmt::bolden(e.name));
+                        return result::skipped;
+                    } else {
+                        // create dirs unless we are doing a dry run
+                        if (!dry) {
+                            // outermost first, so a rollback removes them innermost first
+                            vector<fs::path> missing;
+                            for (fs::path dir = destpath.parent_path(); !dir.empty() && !listing::exists(dir); dir = dir.parent_path()) {
+                                missing.insert(missing.begin(), dir);
+                                if (dir == dir.parent_path()) break;
                             }
-                            processedItems++;
-                        } else {
-                            if (!dry) {
-                                try {
-                                    // create the link
-                                    fs::create_symlink(sourcepath, destpath);
-                                } catch (const fs::filesystem_error& err) {
-                                    msg::error("failed to create symlink at {}", fmt::bolden(udeststr));
-                                    std::cout << err.what() << std::endl;
-                                    return 1;
+                            // entries applied alongside may share parents; only
+                            // what this one actually made is its to record
+                            for (const auto& dir : missing) {
+                                std::error_code ec;
+                                if (log) log->intend(journal::op::mkdir, dir);
+                                bool made = fs::create_directory(dir, ec);
+                                if (ec) {
+                                    msg::error("failed to create directory {}",
+                                        fmt::bolden(unexpandhome(dir.string())));
+                                    std::cout << ec.message() << "\n";
+                                    return result::fatal;
                                 }
+                                if (made) listing::forget(dir);
+                                if (made && log) log->record(journal::op::mkdir, dir);
                             }
-                            processedItems++;
                         }
-                        // show message regardless for dry-runs
-                        msg::pretty("linked {}", fmt::bolden(udeststr));
-                    }
-                    // show *something* when nothing happens
-                    if (processedItems == 0)
-                        msg::pretty("template {} required no links", fmt::bolden(tmpl.name));
-                    
-                    else if (processedItems == 1) {
-                        msg::trace("processed 1 item");
-                    } else {
-                        msg::trace("processed {} items", processedItems);
+                        // display extra message regardless, for dry-run verbose
+                        msg::extra("created directory {}",
+                            fmt::bolden(unexpandhome(destpath.parent_path().string())));
                     }
-                    processedTemplates++;
                 }
-                if (processedTemplates == 0) {
-                } else if (processedTemplates == 1) {
-                    msg::trace("processed 1 template");
-                } else {
-                    msg::trace("processed {} templates", processedTemplates);
+
+                // check parent directory for write permission
+                if (!util::hasperms(deststr) && !dry) {
+                    msg::error("no write permissions for directory {}",
+                        fmt::bolden(unexpandhome(destpath.parent_path().string())));
+                    // TODO: add strict setting, continue if true, return 1 if false
+                    return result::failed;
                 }
-                
-                return 0;
+
+                return std::nullopt;
+            }
+
+            // copies and trees we placed are refreshed by later runs rather than
+            // taken for someone else's; hardlinked files are told apart by inode
+            static void claim(const entry& e, bool directory) {
+                if (!directory && e.type != config::local::linktype::copy) return;
+                // a copy is what its source is; no need to read it back
+                if (!directory) {
+                    if (auto h = digest::file(e.source)) digest::remember(e.destination, h.value());
+                }
+                deploy::claim(e.destination);
+            }
+
+            // the destination is taken; skip it, or build the replacement beside it and
+            // swap it in with a single rename, so the path is never missing in between
+            template <typename F>
+            static result conflicting(const entry& e, const config::global::settings& globals, bool dry, journal::writer* log, F build) {
+                using util::unexpandhome;
+                using config::global::conflict;
+
+                string udeststr = unexpandhome(e.destination.string());
+                if (globals.conflicts == conflict::skip) {
+                    msg::warn("destination {} already exists and is not identical to source, skipping",
+                        fmt::bolden(udeststr));
+                    return result::skipped;
+                }
+
+                fs::path saved = globals.conflicts == conflict::backup ? deploy::backup(e.destination) : fs::path();
+                if (!dry) {
+                    std::error_code ec;
+                    fs::path staged = deploy::temporary(e.destination);
+                    if (!build(staged, ec)) {
+                        std::error_code ignored;
+                        fs::remove_all(staged, ignored);
+                        msg::error("failed to replace {}: {}", fmt::bolden(udeststr), ec.message());
+                        return result::failed;
+                    }
+                    if (log) {
+                        if (saved.empty()) log->intend(journal::op::replace, e.destination);
+                        else log->intend(journal::op::backup, e.destination, saved);
+                    }
+                    if (!deploy::swap(staged, e.destination, saved, ec)) {
+                        msg::error("failed to replace {}: {}", fmt::bolden(udeststr), ec.message());
+                        std::error_code ignored;
+                        if (fs::exists(fs::symlink_status(staged, ignored)))
+                            msg::warn("its previous contents were left at {}", fmt::bolden(staged.string()));
+                        return result::failed;
+                    }
+                    listing::forget(e.destination);
+                    if (e.type == config::local::linktype::copy || e.type == config::local::linktype::hardlink)
+                        claim(e, fs::is_directory(fs::symlink_status(e.destination, ec)));
+                    if (log) {
+                        if (saved.empty()) log->record(journal::op::replace, e.destination);
+                        else log->record(journal::op::backup, e.destination, saved);
+                    }
+                }
+
+                if (saved.empty())
+                    msg::pretty("replaced {}", udeststr);
+                else
+                    msg::pretty("replaced {}, backed up to {}", udeststr, fmt::bolden(unexpandhome(saved.string())));
+                return result::linked;
             }
-            
-            int linknormal(const config::local::settings& conf, const config::global::settings& globals, const vector<sview>& tags, bool dry) {
+
+            // copies and hardlinks: real files at the destination instead of a symlink
+            static result place(const entry& e, const fs::file_status& sourcefstat,
+                                const config::global::settings& globals, bool dry, journal::writer* log) {
                 using util::unexpandhome;
-                int numlinks = conf.links.size();
-                int linksdone = 0;
-                
-                for (int n = 0; n < numlinks; n++) {
-                    
-                    string name       = conf.links.at(n).name;
-                    string tag        = conf.links.at(n).tag;
-                    fs::path sourcepath    = conf.links.at(n).source;
-                    fs::path destpath      = conf.links.at(n).destination;
-                    string sourcestr  = sourcepath.string();
-                    string deststr    = destpath.string();
-                    string usourcestr = fs::relative(sourcepath).string();
-                    string udeststr   = util::unexpandhome(deststr);
-                    
-                    config::local::linktype lt = conf.links.at(n).type;
-                
-                    if (!tag.empty() && tags.size() == 0) continue;
-                    
-                    // skip entry when tag wasn't specified
-                    if (!tag.empty() && tags.size() > 0) {
-                        bool matches = std::find(tags.begin(), tags.end(), tag) != tags.end();
-                        if (!matches) continue;
+
+                bool copying = e.type == config::local::linktype::copy;
+                bool directory = sourcefstat.type() == fs::file_type::directory;
+                string udeststr = unexpandhome(e.destination.string());
+
+                auto build = [&](const fs::path& staged, std::error_code& ec) {
+                    if (directory) {
+                        deploy::tree(e.source, staged, !copying, ec);
+                        return !ec;
                     }
-                    
-                    // skip if the source file doesn't exist
-                    if (!fs::exists(sourcepath)) {
-                        msg::error("source file {} does not exist!", fmt::bolden(usourcestr));
-                        continue;
+                    return copying ? deploy::copy(e.source, staged, ec) : deploy::hardlink(e.source, staged, ec);
+                };
+
+                std::error_code ec;
+                fs::file_status deststat = listing::symlink_status(e.destination, ec);
+                if (fs::is_symlink(deststat)) {
+                    // a symlink we made before the type changed is ours to replace
+                    const fs::path& target = e.target.empty() ? e.source : e.target;
+                    if (fs::read_symlink(e.destination, ec) != target)
+                        return conflicting(e, globals, dry, log, build);
+                    if (!dry && !fs::remove(e.destination, ec)) {
+                        msg::error("failed to remove symlink at {}", fmt::bolden(udeststr));
+                        return result::failed;
                     }
-                    // only after checking the file exists
-                    fs::file_status sourcefstat = fs::status(sourcepath);
-                    
-                    // check if the destination exists
-                    if (fs::exists(destpath)) {
-                        // if the source and dest are the same file, e.g. the link was (likely) already created by us
-                        if (fs::equivalent(sourcepath, destpath)) {
+                    listing::forget(e.destination);
+                } else if (fs::exists(deststat)) {
+                    if (fs::is_directory(deststat) != directory)
+                        return conflicting(e, globals, dry, log, build);
+                    if (!copying && !directory) {
+                        // a hardlink is either the same inode or someone else's file
+                        if (fs::equivalent(e.source, e.destination, ec)) {
                             msg::extra("skipping {}, already linked", fmt::bolden(udeststr));
-                            continue;
-                        }
-                        
-                        // the destination already exists, and isn't identical to our source; we do nothing and skip
-                        msg::warn("destination {} already exists and is not identical to source, skipping",
-                            fmt::bolden(udeststr));
-                        continue;
-                        
-                    } else if (fs::is_symlink(destpath) && !fs::exists(destpath)) {
-                        // it's a broken symlink, remove it
-                        if (!dry) {
-                            try {
-                                fs::remove(destpath);
-                            } catch (const fs::filesystem_error& e) {
-                                msg::error("failed to remove broken symlink at {}", fmt::bolden(deststr));
-                                std::cout << e.what() << std::endl;
-                                std::exit(1);
-                            }
-                        } else {
-                            msg::extra("removing broken symlink at {}", fmt::bolden(deststr));
+                            return result::skipped;
                         }
+                        return conflicting(e, globals, dry, log, build);
                     }
-                    
-                    if (!fs::exists(destpath.parent_path())) {
-                        if (!globals.createdirs) {
-                            // parent path doesn't exist and settings to create dirs is off
-                            msg::warn("parent directory for {} does not exist, skipping",
-                                fmt::bolden(name));
-                            continue;
-                        } else {
-                            // create dirs unless we are doing a dry run
-                            if (!dry) {
-                                try {
-                                    fs::create_directories(destpath.parent_path());
-                                } catch (const fs::filesystem_error& err) {
-                                    msg::error("failed to create directory {}",
-                                        fmt::bolden(unexpandhome(destpath.parent_path().string())));
-                                    std::cout << err.what() << "\n";
-                                    return 1;
-                                }
-                            }
-                            // display extra message regardless, for dry-run verbose
-                            msg::extra("created directory {}",
-                                fmt::bolden(unexpandhome(destpath.parent_path().string())));
-                        }
+                    // rewriting an identical copy would only churn its mtime and wake up watchers
+                    if (copying && !directory && deploy::identical(e.source, e.destination)) {
+                        msg::extra("skipping {}, already copied", fmt::bolden(udeststr));
+                        return result::skipped;
                     }
-                    
-                    // check parent directory for write permission
-                    if (!util::hasperms(deststr) && !dry) {
-                        msg::error("no write permissions for directory {}",
-                            fmt::bolden(unexpandhome(destpath.parent_path().string())));
-                        // TODO: add strict setting, continue if true, return 1 if false
-                        continue;
+                    // only what an earlier run placed, or the interrupted one being
+                    // resumed, is refreshed in place below; anything else is someone's
+                    if (!deploy::ours(e.destination) && !(log && log->changed(e.destination)))
+                        return conflicting(e, globals, dry, log, build);
+                }
+
+                if (auto r = prepare(e, globals, dry, log)) return r.value();
+
+                if (!dry) {
+                    bool creating = !fs::exists(deststat);
+                    if (log && creating) log->intend(journal::op::place, e.destination);
+                    size_t written = 1;
+                    if (directory)
+                        written = deploy::tree(e.source, e.destination, !copying, ec);
+                    else if (copying)
+                        deploy::copy(e.source, e.destination, ec);
+                    else
+                        deploy::hardlink(e.source, e.destination, ec);
+
+                    if (ec) {
+                        if (copying)
+                            msg::error("failed to copy {} to {}: {}", fmt::bolden(e.name), fmt::ital(udeststr), ec.message());
+                        else
+                            msg::error("failed to hardlink {} at {}: {}", fmt::bolden(e.name), fmt::ital(udeststr), ec.message());
+                        return result::failed;
+                    }
+                    listing::forget(e.destination);
+                    if (written == 0) {
+                        msg::extra("skipping {}, already up to date", fmt::bolden(udeststr));
+                        return result::skipped;
+                    }
+                    claim(e, directory);
+                    // refreshing a copy of ours can't be undone, creating one can
+                    if (log && creating) log->record(journal::op::place, e.destination);
+                }
+
+                if (copying)
+                    msg::pretty("copied {}", udeststr);
+                else
+                    msg::pretty("hardlinked {}", udeststr);
+                return result::linked;
+            }
+
+            void prefetch(const vector<entry>& entries) {
+                vector<std::pair<fs::path, fs::path>> pairs;
+                for (const auto& e : entries) {
+                    if (e.type == config::local::linktype::copy)
+                        pairs.emplace_back(e.source, e.destination);
+                }
+                deploy::warm(pairs);
+            }
+
+            bool unchanged(const entry& e, const gitindex::diff& since) {
+                // a copy goes stale as soon as its source is edited, staged or not
+                if (e.type == config::local::linktype::copy) return false;
+                return since.unchanged(e.source);
+            }
+
+            std::uint64_t identify(const config::local::settings& conf, const vector<sview>& tags) {
+                string key;
+                for (const auto& e : plan(conf, tags))
+                    key += std::format("{}\t{}\t{}\n", e.destination.native(), e.source.native(), config::local::literal(e.type));
+                // a package's layout changes as it's applied, so only what it is counts
+                for (const auto& pkg : conf.packages) {
+                    if (tagged(pkg.tag, tags))
+                        key += std::format("{}\t{}\tpackage\n", pkg.destination.native(), pkg.source.native());
+                }
+                return digest::xxh64(key.data(), key.size());
+            }
+
+            result apply(const entry& e, const config::global::settings& globals, bool dry, journal::writer* log) {
+                using util::unexpandhome;
+
+                const fs::path& sourcepath = e.source;
+                const fs::path& destpath   = e.destination;
+                string deststr    = destpath.string();
+                string usourcestr = fs::relative(sourcepath).string();
+                string udeststr   = unexpandhome(deststr);
+
+                // skip if the source file doesn't exist; answered from the repository
+                // walk when there was one
+                std::error_code sec;
+                fs::file_status sourcefstat = scan::status(sourcepath, sec);
+                if (!fs::exists(sourcefstat)) {
+                    msg::error("source file {} does not exist!", fmt::bolden(usourcestr));
+                    return result::failed;
+                }
+
+                if (e.type == config::local::linktype::copy || e.type == config::local::linktype::hardlink)
+                    return place(e, sourcefstat, globals, dry, log);
+
+                // templates link whatever the source turns out to be
+                bool directory = e.templated
+                    ? sourcefstat.type() == fs::file_type::directory
+                    : e.type == config::local::linktype::directory;
+
+                if (!e.templated && directory && sourcefstat.type() != fs::file_type::directory) {
+                    // they specified directory, but the source is not a directory
+                    msg::error("link {} source {} is not a directory",
+                        fmt::bolden(e.name),
+                        fmt::ital(usourcestr));
+                    // TODO: strict return 1
+                    return result::failed;
+                }
+
+                const fs::path& target = e.target.empty() ? sourcepath : e.target;
+                auto build = [&](const fs::path& staged, std::error_code& ec) {
+                    if (directory)
+                        fs::create_directory_symlink(target, staged, ec);
+                    else
+                        fs::create_symlink(target, staged, ec);
+                    return !ec;
+                };
+
+                // what's at the destination, from the listing of its directory; only
+                // a symlink there still needs following
+                std::error_code dec;
+                fs::file_status deststat = listing::symlink_status(destpath, dec);
+                if (!e.target.empty()) {
+                    // the link only resolves from within another root; never follow it here
+                    std::error_code ec;
+                    if (fs::is_symlink(deststat) && fs::read_symlink(destpath, ec) == e.target) {
+                        msg::extra("skipping {}, already linked", fmt::bolden(udeststr));
+                        return result::skipped;
+                    }
+                    if (fs::exists(deststat))
+                        return conflicting(e, globals, dry, log, build);
+                } else if (fs::exists(deststat) && (!fs::is_symlink(deststat) || fs::exists(destpath))) {
+                    // check if the destination exists
+                    // if the source and dest are the same file, e.g. the link was (likely) already created by us
+                    if (fs::equivalent(sourcepath, destpath)) {
+                        msg::extra("skipping {}, already linked", fmt::bolden(udeststr));
+                        return result::skipped;
                     }
-                    
-                    // use create_directory_symlink for dirs because apparenty
-                    // some inferior operating systems treat directory symlinks
-                    // differently to file symlinks
-                    if (lt == config::local::linktype::directory) {
-                        
-                        if (sourcefstat.type() != fs::file_type::directory) {
-                            // they specified directory, but the source is not a directory
-                            msg::error("link {} source {} is not a directory",
-                                fmt::bolden(name),
-                                fmt::ital(usourcestr));
-                            // TODO: strict return 1
-                            continue;
+
+                    // the destination already exists, and isn't identical to our source
+                    return conflicting(e, globals, dry, log, build);
+
+                } else if (fs::is_symlink(deststat)) {
+                    // it's a broken symlink, remove it
+                    if (!dry) {
+                        try {
+                            fs::remove(destpath);
+                            listing::forget(destpath);
+                        } catch (const fs::filesystem_error& err) {
+                            msg::error("failed to remove broken symlink at {}", fmt::bolden(deststr));
+                            std::cout << err.what() << std::endl;
+                            return result::fatal;
                         }
-                        if (!dry) {
-                            try {
-                                // create the link
-                                fs::create_directory_symlink(sourcepath, destpath);
-                            } catch (const fs::filesystem_error& err) {
-                                msg::error("failed to create symlink for {} at {}",
-                                   fmt::bolden(name),
-                                   fmt::ital(udeststr));
-                                std::cout << err.what() << std::endl;
-                                // TODO: continue when strict == false
-                                return 1;
+                    } else {
+                        msg::extra("removing broken symlink at {}", fmt::bolden(deststr));
+                    }
+                }
+
+                if (auto r = prepare(e, globals, dry, log)) return r.value();
+
+
+                if (!dry) {
+                    if (log) log->intend(journal::op::link, destpath, target);
+                    try {
+                        // use create_directory_symlink for dirs because apparenty
+                        // some inferior operating systems treat directory symlinks
+                        // differently to file symlinks
+                        if (directory)
+                            fs::create_directory_symlink(target, destpath);
+                        else
+                            fs::create_symlink(target, destpath);
+                        listing::forget(destpath);
+                        if (log) log->record(journal::op::link, destpath, target);
+                    } catch (const fs::filesystem_error& err) {
+                        msg::error("failed to create symlink for {} at {}",
+                           fmt::bolden(e.name),
+                           fmt::ital(udeststr));
+                        std::cout << err.what() << std::endl;
+                        // TODO: continue when strict == false
+                        return result::fatal;
+                    }
+                }
+
+                // the file was linked; show message regardless for dry-runs
+                msg::pretty("linked {}", udeststr);
+                return result::linked;
+            }
+
+            // a resumed entry counts as changed when the interrupted run changed it
+            static void fire(const entry& e, result r, journal::writer* log, std::set<string>* fired) {
+                if (!fired || e.hooks.empty()) return;
+                if (r == result::linked || (log && log->changed(e.destination)))
+                    fired->insert(e.hooks.begin(), e.hooks.end());
+            }
+
+            int linkall(const config::local::settings& conf, const config::global::settings& globals, const vector<sview>& tags, bool dry,
+                        unsigned jobs, journal::writer* log, std::set<string>* fired,
+                        const gitindex::diff* since, std::size_t* failed) {
+                return linkall(plan(conf, tags), globals, dry, jobs, log, fired, since, failed);
+            }
+
+            int linkall(const vector<entry>& entries, const config::global::settings& globals, bool dry,
+                        unsigned jobs, journal::writer* log, std::set<string>* fired,
+                        const gitindex::diff* since, std::size_t* failed) {
+                if (since) {
+                    // nothing to compare for copies that won't be looked at
+                    vector<entry> stale;
+                    for (const auto& e : entries)
+                        if (!unchanged(e, *since)) stale.push_back(e);
+                    prefetch(stale);
+                } else {
+                    prefetch(entries);
+                }
+
+                size_t n = entries.size();
+                vector<vector<size_t>> needed;
+                graph::edges before = depends(entries, &needed);
+                // a saved plan never went through plan(), and a loop would leave every worker waiting
+                if (auto sorted = graph::sort(before); !sorted.cycle.empty()) {
+                    msg::error("entries can't come after one another in a circle: {}", fmt::bolden(circle(entries, sorted.cycle)));
+                    return 1;
+                }
+                vector<vector<size_t>> dependents(n);
+                vector<size_t> waiting(n);
+                for (size_t i = 0; i < n; i++) {
+                    waiting[i] = before[i].size();
+                    for (size_t b : before[i]) dependents[b].push_back(i);
+                }
+
+                std::mutex lock;
+                std::condition_variable wake;
+                std::deque<size_t> ready;
+                vector<bool> broken(n, false);
+                size_t settled = 0;
+                int linked = 0;
+                std::size_t failures = 0;
+                bool stop = false;
+                for (size_t i = 0; i < n; i++)
+                    if (waiting[i] == 0) ready.push_back(i);
+
+                // with `lock` held: release what waited on `i`, skipping what required it
+                auto settle = [&](size_t first, result r) {
+                    vector<std::pair<size_t, bool>> stack{{first, r == result::failed}};
+                    while (!stack.empty()) {
+                        auto [i, failed] = stack.back();
+                        stack.pop_back();
+                        settled++;
+                        for (size_t d : dependents[i]) {
+                            if (failed && std::find(needed[d].begin(), needed[d].end(), i) != needed[d].end())
+                                broken[d] = true;
+                            if (--waiting[d] != 0) continue;
+                            if (!broken[d]) {
+                                ready.push_back(d);
+                            } else {
+                                msg::warn("skipping {}, an entry it requires failed", fmt::bolden(entries[d].destination.string()));
+                                failures++;
+                                stack.emplace_back(d, true);
                             }
                         }
-                        linksdone++;
-                        
-                    } else if (lt == config::local::linktype::file) {
-                        if (!dry) {
-                            try {
-                                // create the link
-                                fs::create_symlink(sourcepath, destpath);
-                            } catch (const fs::filesystem_error& err) {
-                                 msg::error("failed to create symlink for {} at {}",
-                                    fmt::bolden(name),
-                                    fmt::ital(udeststr));
-                                 std::cout << err.what() << std::endl;
-                                // TODO: continue if strict == false
-                                return 1;
+                    }
+                };
+
+                if (jobs == 0) jobs = std::max(1u, std::thread::hardware_concurrency());
+                jobs = std::min<unsigned>(jobs, std::max<size_t>(n, 1));
+                {
+                    vector<std::jthread> pool;
+                    pool.reserve(jobs);
+                    for (unsigned w = 0; w < jobs; w++) {
+                        pool.emplace_back([&] {
+                            std::unique_lock held(lock);
+                            for (;;) {
+                                wake.wait(held, [&] { return stop || !ready.empty() || settled == n; });
+                                if (stop || ready.empty()) return;
+                                size_t i = ready.front();
+                                ready.pop_front();
+                                const entry& e = entries[i];
+
+                                held.unlock();
+                                // entries a previous, interrupted run got through aren't checked again,
+                                // and neither are those whose sources git has seen no change to
+                                bool resumed = log && log->done(e.destination);
+                                bool same = !resumed && since && unchanged(e, *since);
+                                result r = resumed || same ? result::skipped : apply(e, globals, dry, log);
+                                // failed entries are left for a resumed run to try again
+                                if (!resumed && log && (r == result::linked || r == result::skipped)) log->complete(e.destination);
+                                held.lock();
+
+                                if (r == result::fatal) {
+                                    stop = true;
+                                    wake.notify_all();
+                                    return;
+                                }
+                                if (r == result::linked) linked++;
+                                if (r == result::failed) failures++;
+                                fire(e, r, resumed ? log : nullptr, fired);
+                                settle(i, r);
+                                wake.notify_all();
                             }
-                        }
-                        // incr the tracking counter
-                        linksdone++;
-                    } else {
-                        // cant happen, the linkType will have already been resolved to a good value 
-                        std::unreachable();
+                        });
                     }
-                    
-                    // the file was linked
-                    msg::pretty("linked {}", udeststr);
                 }
+                if (failed) *failed = failures;
+                if (stop) return 1;
+
                 // show *something* when nothing happens at least
-                if (linksdone == 0) {
+                if (linked == 0) {
                     msg::pretty("no links were needed");
                 } else {
-                    if (linksdone == 1)
-                        msg::trace("created 1 normal link");
+                    if (linked == 1)
+                        msg::trace("created 1 link");
                     else
-                        msg::trace("created {} normal links", linksdone);
+                        msg::trace("created {} links", linked);
                 }
                 return 0;
-        
             }
 
         }; // END link
@@ -3,11 +3,17 @@
 
 #pragma once
 
+#include <cstdint>
+#include <filesystem>
+#include <set>
+#include <string>
 #include <string_view>
 #include <vector>
 
 #include "settings/local.hpp"
 #include "settings/global.hpp"
+#include "journal.hpp"
+#include "gitindex.hpp"
 
 using sview = std::string_view;
 using std::vector;
@@ -15,8 +21,57 @@ using std::vector;
 namespace confidant {
     namespace actions {
         namespace link {
-            int linktemplate(const confidant::config::local::settings& conf, const confidant::config::global::settings& globals, const vector<sview>& tags, bool dry);
-            int linknormal(const confidant::config::local::settings& conf, const confidant::config::global::settings& globals, const vector<sview>& tags, bool dry);
+
+            // a single resolved symlink; every template item becomes its own entry
+            struct entry {
+                std::string name;
+                std::filesystem::path source;
+                std::filesystem::path destination;
+                confidant::config::local::linktype type = confidant::config::local::linktype::file;
+                // templates determine the link type from the source itself
+                bool templated = false;
+                // what the symlink should contain when that differs from the
+                // path used to reach the source from here (e.g. inside a sysroot)
+                std::filesystem::path target;
+                // hooks to run if applying it changed anything
+                vector<std::string> hooks;
+                // names of the links and templates to apply first, and of
+                // those without which it is skipped
+                vector<std::string> after;
+                vector<std::string> needs;
+
+                bool operator==(const entry&) const = default;
+            };
+
+            enum class result { linked, skipped, failed, fatal };
+
+            bool tagged(sview tag, const vector<sview>& tags);
+            // identifies what a run with these settings and tags sets out to do
+            std::uint64_t identify(const confidant::config::local::settings& conf, const vector<sview>& tags);
+            // every tagged link and template item, each after whatever it comes after
+            // and after any entry whose destination it sits under
+            vector<entry> plan(const confidant::config::local::settings& conf, const vector<sview>& tags);
+            // hash copies that will need comparing, all at once and in parallel
+            void prefetch(const vector<entry>& entries);
+            // whether nothing `e` depends on changed in the index since the last
+            // run; copies are always compared, edits that aren't staged count
+            bool unchanged(const entry& e, const gitindex::diff& since);
+            // changes are recorded to `log` when given, for resuming and rolling back
+            result apply(const entry& e, const confidant::config::global::settings& globals, bool dry, journal::writer* log = nullptr);
+
+            // apply the plan, up to `jobs` entries at a time (0 for one per processor),
+            // each as soon as what it comes after is done; hooks of the entries that
+            // changed are collected into `fired` when given. with `since`, entries
+            // unchanged since then are left alone, and `failed` counts the entries
+            // that failed when given
+            int linkall(const confidant::config::local::settings& conf, const confidant::config::global::settings& globals, const vector<sview>& tags, bool dry,
+                        unsigned jobs, journal::writer* log = nullptr, std::set<std::string>* fired = nullptr,
+                        const gitindex::diff* since = nullptr, std::size_t* failed = nullptr);
+            // the same for entries already planned, such as those of a saved plan;
+            // entries that come after one another in a circle are refused
+            int linkall(const vector<entry>& entries, const confidant::config::global::settings& globals, bool dry,
+                        unsigned jobs, journal::writer* log = nullptr, std::set<std::string>* fired = nullptr,
+                        const gitindex::diff* since = nullptr, std::size_t* failed = nullptr);
         }; // END link
     }; // END actions
 }; // END confidant
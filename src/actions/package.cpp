@@ -0,0 +1,189 @@
+// SPDX-FileCopyrightText: 2026 Will Reed <wreed@disroot.org>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <algorithm>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include "settings/global.hpp"
+#include "settings/local.hpp"
+#include "actions/link.hpp"
+#include "actions/package.hpp"
+#include "util.hpp"
+#include "listing.hpp"
+#include "fmt.hpp"
+#include "msg.hpp"
+
+namespace fs = std::filesystem;
+
+using sview = std::string_view;
+using std::string;
+using std::vector;
+
+namespace confidant {
+    namespace actions {
+        namespace package {
+
+            // one path in the merged tree of every package
+            struct node {
+                std::map<string, node> children;
+                // the package directories (or the one file) that end up here
+                vector<fs::path> sources;
+                string owner;
+                bool directory = false;
+            };
+
+            static void gather(node& n, const fs::path& source, const string& name) {
+                std::error_code ec;
+                for (const auto& ent : fs::directory_iterator(source, ec)) {
+                    string fname = ent.path().filename().string();
+                    if (fname == ".git") continue;
+
+                    // symlinks inside a package are linked to, never descended into
+                    bool dir = ent.symlink_status(ec).type() == fs::file_type::directory;
+                    node& child = n.children[fname];
+                    if (child.sources.empty()) {
+                        child.owner = name;
+                        child.directory = dir;
+                    } else if (!dir || !child.directory) {
+                        msg::warn("{} is provided by both {} and {}, using the former",
+                            fmt::bolden(ent.path().string()), fmt::bolden(child.owner), fmt::bolden(name));
+                        continue;
+                    }
+                    child.sources.push_back(ent.path());
+                    if (dir) gather(child, ent.path(), name);
+                }
+                if (ec)
+                    msg::error("failed to read package directory {}: {}", fmt::bolden(source.string()), ec.message());
+            }
+
+            // `fresh` when `dest` is yet to be made, or a folded link about to become an
+            // empty directory; nothing under it is looked at, let alone through that link
+            static void lay(const node& n, const fs::path& dest, layout& out, bool fresh = false) {
+                using config::local::linktype;
+
+                for (const auto& [fname, child] : n.children) {
+                    fs::path d = dest / fname;
+                    link::entry folded{child.owner, child.sources.front(), d,
+                        child.directory ? linktype::directory : linktype::file, false, {}, {}, {}, {}};
+
+                    if (!child.directory) {
+                        out.entries.push_back(folded);
+                        continue;
+                    }
+
+                    std::error_code ec;
+                    fs::file_status st = fresh ? fs::file_status(fs::file_type::not_found) : listing::symlink_status(d, ec);
+                    bool alone = child.sources.size() == 1;
+
+                    if (fs::is_symlink(st)) {
+                        fs::path target = fs::read_symlink(d, ec);
+                        if (target.is_relative()) target = d.parent_path() / target;
+                        target = target.lexically_normal();
+                        bool ours = std::find(child.sources.begin(), child.sources.end(), target) != child.sources.end();
+                        if (ours && !alone) {
+                            // folded for one package, now shared with another
+                            out.unfold.push_back(d);
+                            lay(child, d, out, true);
+                        } else {
+                            // already folded, or someone else's link and apply reports the conflict
+                            out.entries.push_back(folded);
+                        }
+                    } else if (fs::is_directory(st)) {
+                        // a real directory may hold anything, only ever link into it
+                        lay(child, d, out);
+                    } else if (fs::exists(st) || alone) {
+                        out.entries.push_back(folded);
+                    } else {
+                        lay(child, d, out, true);
+                    }
+                }
+            }
+
+            layout plan(const config::local::settings& conf, const vector<sview>& tags) {
+                // packages sharing a destination are merged before anything is decided
+                std::map<fs::path, node> roots;
+                for (const auto& pkg : conf.packages) {
+                    if (!link::tagged(pkg.tag, tags)) continue;
+                    if (!fs::is_directory(pkg.source)) {
+                        msg::error("package {} source {} is not a directory",
+                            fmt::bolden(pkg.name), fmt::ital(pkg.source.string()));
+                        continue;
+                    }
+                    gather(roots[pkg.destination.lexically_normal()], pkg.source.lexically_normal(), pkg.name);
+                }
+
+                layout out;
+                for (const auto& [dest, root] : roots)
+                    lay(root, dest, out);
+                return out;
+            }
+
+            int linkpackages(const config::local::settings& conf, const config::global::settings& globals, const vector<sview>& tags, bool dry, journal::writer* log) {
+                if (conf.packages.empty()) return 0;
+                layout planned = plan(conf, tags);
+
+                for (const auto& dir : planned.unfold) {
+                    string udir = util::unexpandhome(dir.string());
+                    if (!dry) {
+                        std::error_code ec;
+                        fs::path target = fs::read_symlink(dir, ec);
+                        if (!ec && log) {
+                            log->intend(journal::op::replace, dir, target);
+                            log->intend(journal::op::mkdir, dir);
+                        }
+                        if (!ec) fs::remove(dir, ec);
+                        if (!ec) fs::create_directory(dir, ec);
+                        listing::forget(dir);
+                        if (ec) {
+                            msg::error("failed to unfold {}: {}", fmt::bolden(udir), ec.message());
+                            return 1;
+                        }
+                        // rolled back newest first: the links in it, the directory, then the link again
+                        if (log) {
+                            log->record(journal::op::replace, dir, target);
+                            log->record(journal::op::mkdir, dir);
+                        }
+                    }
+                    msg::extra("unfolded {}", fmt::bolden(udir));
+                }
+
+                // a dry run leaves the folded links in place; what goes under them
+                // would land in empty directories, and must not be looked up through them
+                auto unfolded = [&](const fs::path& dest) {
+                    for (fs::path dir = dest.parent_path(); dir.has_relative_path(); dir = dir.parent_path()) {
+                        if (std::find(planned.unfold.begin(), planned.unfold.end(), dir) != planned.unfold.end()) return true;
+                    }
+                    return false;
+                };
+
+                int linksdone = 0;
+                for (const auto& e : planned.entries) {
+                    if (log && log->done(e.destination)) continue;
+                    if (dry && unfolded(e.destination)) {
+                        msg::pretty("linked {}", util::unexpandhome(e.destination.string()));
+                        linksdone++;
+                        continue;
+                    }
+                    link::result r = link::apply(e, globals, dry, log);
+                    if (r == link::result::fatal) return 1;
+                    if (log && (r == link::result::linked || r == link::result::skipped)) log->complete(e.destination);
+                    if (r == link::result::linked) linksdone++;
+                }
+
+                if (linksdone == 0)
+                    msg::pretty("packages required no links");
+                else if (linksdone == 1)
+                    msg::trace("created 1 package link");
+                else
+                    msg::trace("created {} package links", linksdone);
+                return 0;
+            }
+
+        }; // END package
+    }; // END actions
+}; // END confidant
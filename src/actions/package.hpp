@@ -0,0 +1,37 @@
+// SPDX-FileCopyrightText: 2026 Will Reed <wreed@disroot.org>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <filesystem>
+#include <string_view>
+#include <vector>
+
+#include "actions/link.hpp"
+#include "settings/local.hpp"
+#include "settings/global.hpp"
+#include "journal.hpp"
+
+using sview = std::string_view;
+using std::vector;
+
+namespace confidant {
+    namespace actions {
+        namespace package {
+
+            // the links that mirror every package, and the folded directory links
+            // that have to become real directories before they can be made
+            struct layout {
+                vector<confidant::actions::link::entry> entries;
+                vector<std::filesystem::path> unfold;
+            };
+
+            // all packages are merged into one tree, which is walked once against the
+            // destination: a directory only one package provides becomes a single link
+            // unless something already lives there, then its contents are linked instead
+            layout plan(const confidant::config::local::settings& conf, const vector<sview>& tags);
+            int linkpackages(const confidant::config::local::settings& conf, const confidant::config::global::settings& globals, const vector<sview>& tags, bool dry, journal::writer* log = nullptr);
+
+        }; // END package
+    }; // END actions
+}; // END confidant
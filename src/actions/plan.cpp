@@ -0,0 +1,347 @@
+// SPDX-FileCopyrightText: 2026 Will Reed <wreed@disroot.org>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <optional>
+#include <set>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "settings/global.hpp"
+#include "settings/local.hpp"
+#include "actions/plan.hpp"
+#include "actions/link.hpp"
+#include "actions/check.hpp"
+#include "actions/hooks.hpp"
+#include "journal.hpp"
+#include "listing.hpp"
+#include "fmt.hpp"
+#include "msg.hpp"
+
+namespace fs = std::filesystem;
+
+using sview = std::string_view;
+using std::string;
+using std::vector;
+
+namespace confidant {
+    namespace actions {
+        namespace plan {
+
+            // written in the byte order of the host that planned; `order` tells
+            // a host of the other kind that it can't read it
+            constexpr char magic[8] = {'c', 'o', 'n', 'f', 'p', 'l', 'a', 'n'};
+            constexpr std::uint32_t order = 0x01020304;
+
+            struct header {
+                char magic[8];
+                std::uint32_t version;
+                std::uint32_t order;
+                std::uint64_t id;
+                std::uint32_t entries;
+                std::uint32_t hooks;
+                // names in the lists of all entries and hooks
+                std::uint32_t refs;
+                std::uint32_t reserved;
+                std::uint64_t strings;
+            };
+
+            // a string in the string block
+            struct str {
+                std::uint32_t offset;
+                std::uint32_t length;
+            };
+
+            // a run of names in the name lists
+            struct range {
+                std::uint32_t first;
+                std::uint32_t count;
+            };
+
+            struct record {
+                str name, source, destination, target;
+                std::uint8_t type;
+                std::uint8_t templated;
+                std::uint8_t reserved[2];
+                range hooks, after, needs;
+                std::uint32_t padding;
+            };
+
+            struct hookrecord {
+                str name, run;
+                range after;
+            };
+
+            static_assert(sizeof(header) == 48);
+            static_assert(sizeof(record) == 64);
+            static_assert(sizeof(hookrecord) == 24);
+
+            class builder {
+            public:
+                str add(sview s) {
+                    auto found = seen.find(string(s));
+                    if (found != seen.end()) return found->second;
+                    str at{static_cast<std::uint32_t>(strings.size()), static_cast<std::uint32_t>(s.size())};
+                    strings.append(s);
+                    seen.emplace(string(s), at);
+                    return at;
+                }
+
+                template <typename Names>
+                range list(const Names& names) {
+                    range r{static_cast<std::uint32_t>(refs.size()), static_cast<std::uint32_t>(names.size())};
+                    for (const auto& n : names) refs.push_back(add(n));
+                    return r;
+                }
+
+                vector<str> refs;
+                string strings;
+
+            private:
+                std::unordered_map<string, str> seen;
+            };
+
+            bool save(sview path, const vector<link::entry>& entries, const vector<config::local::hook>& hooks, std::uint64_t id) {
+                builder b;
+                vector<record> records;
+                records.reserve(entries.size());
+                for (const auto& e : entries) {
+                    record r{};
+                    r.name = b.add(e.name);
+                    r.source = b.add(e.source.native());
+                    r.destination = b.add(e.destination.native());
+                    r.target = b.add(e.target.native());
+                    r.type = static_cast<std::uint8_t>(e.type);
+                    r.templated = e.templated;
+                    r.hooks = b.list(e.hooks);
+                    r.after = b.list(e.after);
+                    r.needs = b.list(e.needs);
+                    records.push_back(r);
+                }
+                vector<hookrecord> hookrecords;
+                hookrecords.reserve(hooks.size());
+                for (const auto& h : hooks)
+                    hookrecords.push_back({b.add(h.name), b.add(h.run), b.list(h.after)});
+
+                if (b.strings.size() > UINT32_MAX || b.refs.size() > UINT32_MAX || records.size() > UINT32_MAX) {
+                    msg::error("the plan is too large to save");
+                    return false;
+                }
+
+                header h{};
+                std::memcpy(h.magic, magic, sizeof magic);
+                h.version = version;
+                h.order = order;
+                h.id = id;
+                h.entries = records.size();
+                h.hooks = hookrecords.size();
+                h.refs = b.refs.size();
+                h.strings = b.strings.size();
+
+                fs::path target(path);
+                fs::path tmp = target;
+                tmp += std::format(".{}", getpid());
+                std::error_code ec;
+                {
+                    std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+                    out.write(reinterpret_cast<const char*>(&h), sizeof h);
+                    out.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(record));
+                    out.write(reinterpret_cast<const char*>(hookrecords.data()), hookrecords.size() * sizeof(hookrecord));
+                    out.write(reinterpret_cast<const char*>(b.refs.data()), b.refs.size() * sizeof(str));
+                    out.write(b.strings.data(), b.strings.size());
+                    if (!out) {
+                        msg::error("failed to write {}", fmt::bolden(tmp.string()));
+                        fs::remove(tmp, ec);
+                        return false;
+                    }
+                }
+                fs::rename(tmp, target, ec);
+                if (ec) {
+                    msg::error("failed to write {}: {}", fmt::bolden(target.string()), ec.message());
+                    fs::remove(tmp, ec);
+                    return false;
+                }
+                return true;
+            }
+
+            // every section lies where the counts in the header say, back to back
+            static const header& head(const unsigned char* data) { return *reinterpret_cast<const header*>(data); }
+            static const record* records(const unsigned char* data) {
+                return reinterpret_cast<const record*>(data + sizeof(header));
+            }
+            static const hookrecord* hookrecords(const unsigned char* data) {
+                return reinterpret_cast<const hookrecord*>(records(data) + head(data).entries);
+            }
+            static const str* refs(const unsigned char* data) {
+                return reinterpret_cast<const str*>(hookrecords(data) + head(data).hooks);
+            }
+            static const char* strings(const unsigned char* data) {
+                return reinterpret_cast<const char*>(refs(data) + head(data).refs);
+            }
+
+            reader::reader(sview path) {
+                string p(path);
+                int fd = ::open(p.c_str(), O_RDONLY | O_CLOEXEC);
+                if (fd < 0) {
+                    problem = std::format("failed to open {}: {}", p, std::strerror(errno));
+                    return;
+                }
+                struct stat st;
+                if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(header))) {
+                    ::close(fd);
+                    problem = std::format("{} is not a plan", p);
+                    return;
+                }
+                void* mapped = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                ::close(fd);
+                if (mapped == MAP_FAILED) {
+                    problem = std::format("failed to map {}: {}", p, std::strerror(errno));
+                    return;
+                }
+                data = static_cast<const unsigned char*>(mapped);
+                size = st.st_size;
+                if (!check()) problem = std::format("{} {}", p, problem);
+            }
+
+            reader::~reader() {
+                if (data) munmap(const_cast<unsigned char*>(data), size);
+            }
+
+            // nothing may point outside of the file, so the accessors needn't check
+            bool reader::check() {
+                const header& h = head(data);
+                if (std::memcmp(h.magic, magic, sizeof magic) != 0) {
+                    problem = "is not a plan";
+                    return false;
+                }
+                if (h.order != order) {
+                    problem = "was planned on a host of another byte order";
+                    return false;
+                }
+                if (h.version != version) {
+                    problem = std::format("is a version {} plan, only version {} can be applied", h.version, version);
+                    return false;
+                }
+                std::uint64_t expected = sizeof(header) + std::uint64_t(h.entries) * sizeof(record)
+                    + std::uint64_t(h.hooks) * sizeof(hookrecord) + std::uint64_t(h.refs) * sizeof(str) + h.strings;
+                if (expected != size) {
+                    problem = "is truncated or damaged";
+                    return false;
+                }
+
+                auto inside = [&](str s) { return std::uint64_t(s.offset) + s.length <= h.strings; };
+                auto within = [&](range r) { return std::uint64_t(r.first) + r.count <= h.refs; };
+                const str* names = refs(data);
+                for (std::uint32_t i = 0; i < h.refs; i++)
+                    if (!inside(names[i])) { problem = "is damaged"; return false; }
+                const record* rs = records(data);
+                for (std::uint32_t i = 0; i < h.entries; i++) {
+                    const record& r = rs[i];
+                    if (!inside(r.name) || !inside(r.source) || !inside(r.destination) || !inside(r.target)
+                        || !within(r.hooks) || !within(r.after) || !within(r.needs)
+                        || r.type > config::local::linktype::hardlink) {
+                        problem = "is damaged";
+                        return false;
+                    }
+                }
+                const hookrecord* hs = hookrecords(data);
+                for (std::uint32_t i = 0; i < h.hooks; i++) {
+                    if (!inside(hs[i].name) || !inside(hs[i].run) || !within(hs[i].after)) {
+                        problem = "is damaged";
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            std::uint64_t reader::id() const { return head(data).id; }
+            std::size_t reader::entries() const { return problem.empty() ? head(data).entries : 0; }
+            std::size_t reader::hooks() const { return problem.empty() ? head(data).hooks : 0; }
+
+            static sview text(const unsigned char* data, str s) { return {strings(data) + s.offset, s.length}; }
+
+            static vector<string> names(const unsigned char* data, range r) {
+                vector<string> out;
+                out.reserve(r.count);
+                for (std::uint32_t i = 0; i < r.count; i++) out.emplace_back(text(data, refs(data)[r.first + i]));
+                return out;
+            }
+
+            link::entry reader::entry(std::size_t i) const {
+                const record& r = records(data)[i];
+                link::entry e;
+                e.name = text(data, r.name);
+                e.source = text(data, r.source);
+                e.destination = text(data, r.destination);
+                e.target = text(data, r.target);
+                e.type = static_cast<config::local::linktype>(r.type);
+                e.templated = r.templated;
+                e.hooks = names(data, r.hooks);
+                e.after = names(data, r.after);
+                e.needs = names(data, r.needs);
+                return e;
+            }
+
+            config::local::hook reader::hook(std::size_t i) const {
+                const hookrecord& r = hookrecords(data)[i];
+                return {string(text(data, r.name)), string(text(data, r.run)), names(data, r.after)};
+            }
+
+            int apply(sview path, const config::global::settings& globals, unsigned jobs,
+                      bool dry, bool nohooks, bool nocheck, bool strict) {
+                reader plan(path);
+                if (!plan.error().empty()) {
+                    msg::error("{}", plan.error());
+                    return 1;
+                }
+
+                vector<link::entry> entries;
+                entries.reserve(plan.entries());
+                for (std::size_t i = 0; i < plan.entries(); i++) entries.push_back(plan.entry(i));
+                vector<config::local::hook> commands;
+                commands.reserve(plan.hooks());
+                for (std::size_t i = 0; i < plan.hooks(); i++) commands.push_back(plan.hook(i));
+                msg::extra("applying {} planned entries", entries.size());
+
+                listing::enable();
+                if (!nocheck) {
+                    auto found = check::validate(entries, globals, jobs);
+                    if (!check::clean(found, strict)) {
+                        check::show(entries, found);
+                        msg::error("not applying anything, {} errors and {} warnings were found", found.errors, found.warnings);
+                        return 1;
+                    }
+                }
+
+                // the plan stands in for the configuration, so 'rollback' takes it too
+                std::optional<journal::writer> log;
+                if (!dry) log.emplace(path, plan.id());
+                journal::writer* logp = log ? &log.value() : nullptr;
+
+                std::set<string> fired;
+                int n = link::linkall(entries, globals, dry, jobs, logp, &fired);
+                if (n != 0) return n;
+                if (log) log->end();
+
+                if (nohooks) {
+                    if (!fired.empty()) msg::info("not running {} hooks", fired.size());
+                    return 0;
+                }
+                return hooks::run(commands, fired, jobs, dry);
+            }
+
+        }; // END plan
+    }; // END actions
+}; // END confidant
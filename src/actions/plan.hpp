@@ -0,0 +1,65 @@
+// SPDX-FileCopyrightText: 2026 Will Reed <wreed@disroot.org>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "actions/link.hpp"
+#include "settings/global.hpp"
+#include "settings/local.hpp"
+
+using sview = std::string_view;
+using std::vector;
+
+// a resolved plan written by 'link --plan-out' and carried out by 'apply',
+// so hosts sharing a configuration don't each have to read it. the file is
+// a header followed by fixed-size entry and hook records, the name lists
+// they share, and one block of strings the rest point into; it is read in
+// place, straight from a mapping of it
+namespace confidant {
+    namespace actions {
+        namespace plan {
+
+            // bumped whenever the layout changes; other versions are refused
+            constexpr std::uint32_t version = 1;
+
+            bool save(sview path, const vector<confidant::actions::link::entry>& entries,
+                      const vector<confidant::config::local::hook>& hooks, std::uint64_t id);
+
+            // a plan file, checked when opened so that nothing in it points
+            // outside of it; entries and hooks are put together on access
+            class reader {
+            public:
+                explicit reader(sview path);
+                ~reader();
+                reader(const reader&) = delete;
+                reader& operator=(const reader&) = delete;
+
+                // empty when the plan could be read, otherwise why not
+                const std::string& error() const { return problem; }
+                std::uint64_t id() const;
+                std::size_t entries() const;
+                std::size_t hooks() const;
+                confidant::actions::link::entry entry(std::size_t i) const;
+                confidant::config::local::hook hook(std::size_t i) const;
+
+            private:
+                bool check();
+
+                const unsigned char* data = nullptr;
+                std::size_t size = 0;
+                std::string problem;
+            };
+
+            // the 'apply' command: only what is on the filesystem now is looked at
+            int apply(sview path, const confidant::config::global::settings& globals, unsigned jobs,
+                      bool dry, bool nohooks, bool nocheck, bool strict);
+
+        }; // END plan
+    }; // END actions
+}; // END confidant
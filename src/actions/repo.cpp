@@ -0,0 +1,284 @@
+// SPDX-FileCopyrightText: 2026 Will Reed <wreed@disroot.org>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "settings/global.hpp"
+#include "settings/local.hpp"
+#include "actions/repo.hpp"
+#include "gitindex.hpp"
+#include "digest.hpp"
+#include "util.hpp"
+#include "xdg.hpp"
+#include "fmt.hpp"
+#include "msg.hpp"
+
+extern char** environ;
+
+namespace fs = std::filesystem;
+
+using sview = std::string_view;
+using std::string;
+using std::vector;
+using std::optional;
+using std::nullopt;
+
+namespace confidant {
+    namespace actions {
+        namespace repo {
+
+            constexpr sview configname = "confidant.ucl";
+
+            static void writeall(int fd, sview s) {
+                while (!s.empty()) {
+                    ssize_t n = write(fd, s.data(), s.size());
+                    if (n < 0) {
+                        if (errno == EINTR) continue;
+                        return;
+                    }
+                    s.remove_prefix(n);
+                }
+            }
+
+            // run git with `args`, with `input` on its standard input and its standard
+            // output collected into `output` when given; errors go straight through
+            static int git(const vector<string>& args, sview input = {}, string* output = nullptr) {
+                vector<const char*> argv{"git"};
+                for (const auto& a : args) argv.push_back(a.c_str());
+                argv.push_back(nullptr);
+
+                int in[2] = {-1, -1};
+                int out[2] = {-1, -1};
+                if ((!input.empty() && pipe2(in, O_CLOEXEC) != 0) || (output && pipe2(out, O_CLOEXEC) != 0)) {
+                    msg::error("failed to run {}: {}", fmt::bolden("git"), std::strerror(errno));
+                    return -1;
+                }
+
+                posix_spawn_file_actions_t actions;
+                posix_spawn_file_actions_init(&actions);
+                if (in[0] >= 0) posix_spawn_file_actions_adddup2(&actions, in[0], STDIN_FILENO);
+                if (out[1] >= 0) posix_spawn_file_actions_adddup2(&actions, out[1], STDOUT_FILENO);
+
+                pid_t pid;
+                int err = posix_spawnp(&pid, "git", &actions, nullptr, const_cast<char* const*>(argv.data()), environ);
+                posix_spawn_file_actions_destroy(&actions);
+                for (int fd : {in[0], out[1]})
+                    if (fd >= 0) close(fd);
+                if (err != 0) {
+                    for (int fd : {in[1], out[0]})
+                        if (fd >= 0) close(fd);
+                    msg::error("failed to run {}: {}", fmt::bolden("git"), std::strerror(err));
+                    return -1;
+                }
+
+                if (in[1] >= 0) {
+                    writeall(in[1], input);
+                    close(in[1]);
+                }
+                if (out[0] >= 0) {
+                    char buf[4096];
+                    for (;;) {
+                        ssize_t n = read(out[0], buf, sizeof buf);
+                        if (n < 0 && errno == EINTR) continue;
+                        if (n <= 0) break;
+                        output->append(buf, n);
+                    }
+                    close(out[0]);
+                }
+
+                int status;
+                while (waitpid(pid, &status, 0) < 0) {
+                    if (errno != EINTR) return -1;
+                }
+                return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+            }
+
+            // 'ref: refs/heads/NAME<TAB>HEAD' from 'git ls-remote --symref URL HEAD'
+            static optional<string> defaultbranch(sview url) {
+                string listed;
+                if (git({"ls-remote", "--symref", string(url), "HEAD"}, {}, &listed) != 0) return nullopt;
+                constexpr sview prefix = "ref: refs/heads/";
+                for (size_t at = 0; at < listed.size();) {
+                    size_t eol = listed.find('\n', at);
+                    if (eol == string::npos) eol = listed.size();
+                    sview line = sview(listed).substr(at, eol - at);
+                    at = eol + 1;
+                    if (line.starts_with(prefix) && line.ends_with("\tHEAD"))
+                        return string(line.substr(prefix.size(), line.size() - prefix.size() - 5));
+                }
+                return nullopt;
+            }
+
+            // a literal path as a sparse-checkout pattern, anchored to the top
+            static string pattern(sview rel) {
+                string out = "/";
+                for (char c : rel) {
+                    if (c == '\\' || c == '*' || c == '?' || c == '[' || c == ']') out += '\\';
+                    out += c;
+                }
+                return out + "\n";
+            }
+
+            // the configuration, whatever it includes, and every source it names
+            // under `top`; hooks' scripts and such aren't known, and are left out
+            static string patterns(const fs::path& top, sview config, const config::global::settings& globals) {
+                std::error_code ec;
+                string out = pattern(fs::absolute(config, ec).lexically_normal().lexically_relative(top).native()) + "*.ucl\n";
+                config::local::settings conf = config::local::serialize(config, globals);
+
+                auto add = [&](const fs::path& source) {
+                    fs::path rel = fs::absolute(source, ec).lexically_normal().lexically_relative(top);
+                    if (rel.empty() || rel == "." || *rel.begin() == "..") return;
+                    out += pattern(rel.native());
+                };
+                for (sview source : conf.links.source) add(fs::path(source));
+                for (auto tmpl : conf.templates)
+                    for (sview item : tmpl.items) add(fs::path(util::substitute(tmpl.source, item)));
+                for (const auto& pkg : conf.packages) add(pkg.source);
+                return out;
+            }
+
+            fs::path directory(sview url) {
+                sview name = url;
+                while (name.ends_with('/')) name.remove_suffix(1);
+                if (auto slash = name.find_last_of("/:"); slash != sview::npos) name.remove_prefix(slash + 1);
+                if (name.ends_with(".git")) name.remove_suffix(4);
+                return fs::current_path() / (name.empty() ? "dotfiles" : name);
+            }
+
+            int clone(sview url, const fs::path& dir, unsigned depth, bool sparse, const config::global::settings& globals) {
+                string udir = util::unexpandhome(dir.string());
+                std::error_code ec;
+                if (fs::exists(dir, ec) && !fs::is_empty(dir, ec)) {
+                    msg::error("{} already exists and isn't empty", fmt::bolden(udir));
+                    return 1;
+                }
+
+                // asked for up front, so the cache knows what to keep it as
+                optional<string> branch = defaultbranch(url);
+                if (!branch) {
+                    msg::error("failed to find the default branch of {}", fmt::bolden(url));
+                    return 1;
+                }
+
+                vector<string> shallow;
+                if (depth > 0) shallow = {"--depth", std::to_string(depth)};
+                string d = dir.string();
+                string tracking = std::format("refs/remotes/origin/{}", *branch);
+
+                if (git({"init", "-q", d}) != 0 || git({"-C", d, "remote", "add", "origin", string(url)}) != 0) {
+                    msg::error("failed to set up a repository at {}", fmt::bolden(udir));
+                    return 1;
+                }
+
+                if (sparse) {
+                    // blobs come straight from the remote as the checkout needs them,
+                    // which the cache can't stand in for
+                    vector<string> fetch{"-C", d, "fetch", "-q", "--no-tags", "--filter=blob:none"};
+                    fetch.insert(fetch.end(), shallow.begin(), shallow.end());
+                    fetch.insert(fetch.end(), {"origin", std::format("+refs/heads/{}:{}", *branch, tracking)});
+                    if (git(fetch) != 0) {
+                        msg::error("failed to fetch {}", fmt::bolden(url));
+                        return 1;
+                    }
+                    // only the configuration to begin with; what it names comes after
+                    if (git({"-C", d, "sparse-checkout", "set", "--no-cone", "--stdin"}, pattern(configname) + "*.ucl\n") != 0) {
+                        msg::error("failed to set up a sparse checkout at {}", fmt::bolden(udir));
+                        return 1;
+                    }
+                } else {
+                    fs::path cache = xdg::homes().at("XDG_CACHE_HOME") / "confidant" / "objects.git";
+                    string c = cache.string();
+                    if (!fs::exists(cache, ec) && git({"init", "-q", "--bare", c}) != 0) {
+                        msg::error("failed to create the object cache at {}", fmt::bolden(c));
+                        return 1;
+                    }
+                    // each remote branch has a ref of its own in the cache; whatever it
+                    // shares with anything fetched before isn't sent again
+                    string key = std::format("refs/heads/{:016x}", digest::xxh64(url.data(), url.size()));
+                    vector<string> fill{"-C", c, "fetch", "-q", "--no-tags"};
+                    fill.insert(fill.end(), shallow.begin(), shallow.end());
+                    fill.insert(fill.end(), {string(url), std::format("+refs/heads/{}:{}", *branch, key)});
+                    if (git(fill) != 0) {
+                        msg::error("failed to fetch {}", fmt::bolden(url));
+                        return 1;
+                    }
+                    vector<string> fetch{"-C", d, "fetch", "-q", "--no-tags"};
+                    fetch.insert(fetch.end(), shallow.begin(), shallow.end());
+                    fetch.insert(fetch.end(), {"file://" + c, std::format("+{}:{}", key, tracking)});
+                    if (git(fetch) != 0) {
+                        msg::error("failed to copy {} out of the object cache", fmt::bolden(url));
+                        return 1;
+                    }
+                }
+
+                if (git({"-C", d, "checkout", "-q", "-b", *branch, "--track", "origin/" + *branch}) != 0) {
+                    msg::error("failed to check out {} at {}", fmt::bolden(*branch), fmt::bolden(udir));
+                    return 1;
+                }
+
+                fs::path config = dir / configname;
+                if (!fs::exists(config, ec)) {
+                    msg::error("cloned {}, but there is no {} at the top of it", fmt::bolden(url), fmt::bolden(configname));
+                    return 1;
+                }
+                if (sparse && git({"-C", d, "sparse-checkout", "set", "--no-cone", "--stdin"}, patterns(dir, config.string(), globals)) != 0) {
+                    msg::error("failed to check out the sources {} names", fmt::bolden(util::unexpandhome(config.string())));
+                    return 1;
+                }
+
+                msg::pretty("cloned {} into {}", url, fmt::bolden(udir));
+                return 0;
+            }
+
+            int sync(sview config, const config::global::settings& globals) {
+                auto top = gitindex::worktree(fs::path(config).parent_path());
+                if (!top) {
+                    msg::error("{} isn't in a git repository", fmt::bolden(util::unexpandhome(string(config))));
+                    return 1;
+                }
+                string t = top->string();
+                string ut = util::unexpandhome(t);
+                config::local::settings conf = config::local::serialize(config, globals);
+
+                // repository.url, when it's set, says where the configuration lives now
+                vector<string> pull{"-C", t, "pull", "-q", "--ff-only"};
+                string origin;
+                git({"-C", t, "remote", "get-url", "origin"}, {}, &origin);
+                while (origin.ends_with('\n')) origin.pop_back();
+                if (!conf.repo.url.empty() && conf.repo.url != origin)
+                    pull.insert(pull.end(), {conf.repo.url, "HEAD"});
+                if (git(pull) != 0) {
+                    msg::error("failed to bring {} up to date", fmt::bolden(ut));
+                    return 1;
+                }
+
+                // what the configuration names may have changed with it
+                string sparse;
+                git({"-C", t, "config", "--get", "--bool", "core.sparseCheckout"}, {}, &sparse);
+                if (sparse.starts_with("true")
+                    && git({"-C", t, "sparse-checkout", "set", "--no-cone", "--stdin"}, patterns(top.value(), config, globals)) != 0) {
+                    msg::error("failed to check out the sources {} names", fmt::bolden(util::unexpandhome(string(config))));
+                    return 1;
+                }
+
+                msg::pretty("brought {} up to date", ut);
+                return 0;
+            }
+
+        }; // END repo
+    }; // END actions
+}; // END confidant
@@ -0,0 +1,34 @@
+// SPDX-FileCopyrightText: 2026 Will Reed <wreed@disroot.org>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <filesystem>
+#include <string_view>
+
+#include "settings/global.hpp"
+
+using sview = std::string_view;
+
+namespace confidant {
+    namespace actions {
+        namespace repo {
+
+            // where 'clone' puts `url` when not told: its last component, less any
+            // .git, under the current directory
+            std::filesystem::path directory(sview url);
+
+            // clone the default branch of `url` into `dir`, `depth` commits deep (0
+            // for the whole history); objects come by way of a bare repository in
+            // $XDG_CACHE_HOME/confidant/objects.git shared by every clone, so what
+            // one already fetched isn't fetched again. with `sparse`, only the
+            // configuration and the sources it names are fetched and checked out
+            int clone(sview url, const std::filesystem::path& dir, unsigned depth, bool sparse,
+                      const confidant::config::global::settings& globals);
+            // fast-forward the repository `config` is in from repository.url, or
+            // from its upstream when that isn't set
+            int sync(sview config, const confidant::config::global::settings& globals);
+
+        }; // END repo
+    }; // END actions
+}; // END confidant
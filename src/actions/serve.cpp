@@ -0,0 +1,378 @@
+// SPDX-FileCopyrightText: 2026 Will Reed <wreed@disroot.org>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "settings/global.hpp"
+#include "settings/local.hpp"
+#include "actions/get.hpp"
+#include "actions/link.hpp"
+#include "actions/package.hpp"
+#include "actions/serve.hpp"
+#include "actions/status.hpp"
+#include "parse.hpp"
+#include "util.hpp"
+#include "fmt.hpp"
+#include "msg.hpp"
+#include "xdg.hpp"
+
+namespace fs = std::filesystem;
+
+using sview = std::string_view;
+using std::string;
+using std::vector;
+using std::optional;
+using std::nullopt;
+
+namespace confidant {
+    namespace actions {
+        namespace serve {
+
+            // longest request line accepted before the client is dropped
+            constexpr size_t maxline = 4096;
+
+            struct state {
+                config::local::settings conf;
+                vector<link::entry> entries;
+                // what the plan was made for, as tagset() spells it
+                string tags;
+                // warm lookups for status/which
+                std::unordered_map<string, vector<size_t>> byname;
+                std::unordered_map<string, size_t> bypath;
+
+                void load(sview path, const config::global::settings& globals, const vector<sview>& tags, variables::resolver& vars) {
+                    this->tags = tagset(tags);
+                    conf = config::local::serialize(path, globals, vars);
+                    entries = link::plan(conf, tags);
+                    auto packaged = package::plan(conf, tags).entries;
+                    entries.insert(entries.end(), packaged.begin(), packaged.end());
+                    byname.clear();
+                    bypath.clear();
+                    for (size_t n = 0; n < entries.size(); n++) {
+                        byname[entries[n].name].push_back(n);
+                        bypath.emplace(entries[n].destination.lexically_normal().native(), n);
+                        bypath.emplace(entries[n].source.lexically_normal().native(), n);
+                    }
+                }
+            };
+
+            struct client {
+                int fd;
+                string input;
+                // replies it hasn't taken yet; nothing more is read from it until they're gone
+                string output;
+                size_t sent = 0;
+            };
+
+            string tagset(const vector<sview>& tags) {
+                vector<sview> sorted;
+                for (sview t : tags)
+                    if (!t.empty()) sorted.push_back(t);
+                std::sort(sorted.begin(), sorted.end());
+                sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+                if (sorted.empty()) return "-";
+                string out;
+                for (sview t : sorted) {
+                    if (!out.empty()) out += ',';
+                    out += t;
+                }
+                return out;
+            }
+
+            string socketpath(sview config) {
+                // one socket per configuration file, named after its path
+                fs::path runtime = xdg::homes().at("XDG_RUNTIME_DIR");
+                return std::format("{}/confidant/{}.sock", runtime.string(), util::configkey(config));
+            }
+
+            static bool sendall(int fd, sview data) {
+                while (!data.empty()) {
+                    ssize_t n = ::send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+                    if (n < 0) {
+                        if (errno == EINTR) continue;
+                        return false;
+                    }
+                    data.remove_prefix(size_t(n));
+                }
+                return true;
+            }
+
+            // queued rather than sent, so a client that stops reading can't hold up the others
+            static void respond(client& c, const optional<reply>& r) {
+                if (!r) c.output += "skip 0\n";
+                else c.output += std::format("{} {}\n{}", r->ok ? "ok" : "err", r->body.size(), r->body);
+            }
+
+            // as much of the queue as the socket takes right now; false once the client is gone
+            static bool flush(client& c) {
+                while (c.sent < c.output.size()) {
+                    ssize_t n = ::send(c.fd, c.output.data() + c.sent, c.output.size() - c.sent, MSG_NOSIGNAL | MSG_DONTWAIT);
+                    if (n < 0) {
+                        if (errno == EINTR) continue;
+                        return errno == EAGAIN || errno == EWOULDBLOCK;
+                    }
+                    c.sent += size_t(n);
+                }
+                c.output.clear();
+                c.sent = 0;
+                return true;
+            }
+
+            // nullopt when the request was for a plan made with other tags
+            static optional<reply> answer(state& st, sview line, bool& reload) {
+                size_t space = line.find(' ');
+                sview verb = line.substr(0, space);
+                sview arg = space == sview::npos ? sview() : line.substr(space + 1);
+
+                if (verb == "status" || verb == "which") {
+                    size_t gap = arg.find(' ');
+                    sview tags = arg.substr(0, gap);
+                    arg = gap == sview::npos ? sview() : arg.substr(gap + 1);
+                    if (tags != st.tags) return nullopt;
+                }
+
+                if (verb == "get") {
+                    auto value = get::local(st.conf, arg);
+                    if (!value) return reply{false, std::format("setting {} not found in configuration\n", arg)};
+                    return reply{true, get::formatlocalvalue(value.value()) + "\n"};
+                }
+
+                if (verb == "status") {
+                    vector<const link::entry*> found;
+                    if (arg.empty()) {
+                        for (const auto& e : st.entries) found.push_back(&e);
+                    } else if (auto named = st.byname.find(string(arg)); named != st.byname.end()) {
+                        for (size_t n : named->second) found.push_back(&st.entries[n]);
+                    } else {
+                        auto path = st.bypath.find(fs::absolute(fs::path(arg)).lexically_normal().native());
+                        if (path != st.bypath.end() && st.entries[path->second].destination.lexically_normal() == fs::path(path->first))
+                            found.push_back(&st.entries[path->second]);
+                    }
+                    if (found.empty()) return reply{false, std::format("no link named {} in configuration\n", arg)};
+                    return reply{true, status::format(found)};
+                }
+
+                if (verb == "which") {
+                    auto path = st.bypath.find(fs::absolute(fs::path(arg)).lexically_normal().native());
+                    if (path == st.bypath.end()) return reply{false, std::format("{} is not managed by confidant\n", arg)};
+                    return reply{true, status::format(st.entries[path->second])};
+                }
+
+                if (verb == "ping")
+                    return reply{true, ""};
+
+                if (verb == "reload") {
+                    reload = true;
+                    return reply{true, ""};
+                }
+
+                return reply{false, std::format("unknown request {}\n", verb)};
+            }
+
+            int run(sview path, const config::global::settings& globals, const vector<sview>& tags) {
+                fs::path config = fs::absolute(fs::path(path));
+                string confname = config.filename().string();
+                string sockpath = socketpath(path);
+
+                if (ask(path, "ping").has_value()) {
+                    msg::error("a server for {} is already listening at {}", fmt::bolden(path), fmt::bolden(sockpath));
+                    return 1;
+                }
+
+                sockaddr_un addr{};
+                addr.sun_family = AF_UNIX;
+                if (sockpath.size() >= sizeof(addr.sun_path)) {
+                    msg::error("socket path {} is too long", fmt::bolden(sockpath));
+                    return 1;
+                }
+                std::memcpy(addr.sun_path, sockpath.c_str(), sockpath.size() + 1);
+
+                std::error_code ec;
+                fs::create_directories(fs::path(sockpath).parent_path(), ec);
+                ::chmod(fs::path(sockpath).parent_path().c_str(), 0700);
+                // a leftover from a server that went away without cleaning up
+                fs::remove(sockpath, ec);
+
+                state st;
+                variables::resolver vars(path);
+                st.load(path, globals, tags, vars);
+
+                int listener = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+                if (listener < 0
+                    || ::bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof addr) < 0
+                    || ::listen(listener, 64) < 0) {
+                    msg::error("failed to listen on {}: {}", fmt::bolden(sockpath), std::strerror(errno));
+                    return 1;
+                }
+
+                int notify = inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+                int confwd = notify < 0 ? -1 : inotify_add_watch(notify, config.parent_path().c_str(),
+                    IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+                if (confwd < 0)
+                    msg::warn("unable to watch {}, changes will need an explicit reload", fmt::bolden(path));
+
+                msg::info("listening on {}", fmt::bolden(sockpath));
+
+                vector<client> clients;
+                alignas(struct inotify_event) char events[4096];
+
+                for (;;) {
+                    vector<pollfd> fds;
+                    fds.reserve(clients.size() + 2);
+                    fds.push_back({listener, POLLIN, 0});
+                    fds.push_back({notify, POLLIN, 0});
+                    for (const auto& c : clients)
+                        fds.push_back({c.fd, short(c.output.empty() ? POLLIN : POLLOUT), 0});
+
+                    if (::poll(fds.data(), fds.size(), -1) < 0) {
+                        if (errno == EINTR) continue;
+                        msg::error("failed to wait for requests: {}", std::strerror(errno));
+                        break;
+                    }
+
+                    bool reload = false;
+
+                    if (fds[1].revents & POLLIN) {
+                        ssize_t len;
+                        while ((len = ::read(notify, events, sizeof events)) > 0) {
+                            for (char* p = events; p < events + len;) {
+                                auto* ev = reinterpret_cast<struct inotify_event*>(p);
+                                p += sizeof(struct inotify_event) + ev->len;
+                                if (ev->len > 0 && sview(ev->name) == confname) reload = true;
+                            }
+                        }
+                    }
+
+                    // walk backwards so finished clients can be dropped in place
+                    for (size_t n = fds.size(); n-- > 2;) {
+                        short revents = fds[n].revents;
+                        if (!(revents & (POLLIN | POLLOUT | POLLHUP | POLLERR | POLLNVAL))) continue;
+                        client& c = clients[n - 2];
+                        bool done = revents & (POLLERR | POLLNVAL);
+
+                        if (!done && (revents & POLLOUT)) {
+                            done = !flush(c);
+                        } else if (!done) {
+                            char buffer[1024];
+                            ssize_t got = ::read(c.fd, buffer, sizeof buffer);
+                            done = got <= 0;
+                            if (!done) c.input.append(buffer, size_t(got));
+
+                            size_t eol;
+                            while (!done && (eol = c.input.find('\n')) != string::npos) {
+                                respond(c, answer(st, sview(c.input).substr(0, eol), reload));
+                                c.input.erase(0, eol + 1);
+                            }
+                            if (c.input.size() > maxline) done = true;
+                            if (!done) done = !flush(c);
+                        }
+
+                        if (done) {
+                            ::close(c.fd);
+                            clients.erase(clients.begin() + std::ptrdiff_t(n - 2));
+                        }
+                    }
+
+                    if (fds[0].revents & POLLIN) {
+                        int fd = ::accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+                        if (fd >= 0) clients.push_back(client{.fd = fd});
+                    }
+
+                    if (reload) {
+                        string errorstr;
+                        variables::resolver vars(path);
+                        if (!ucl::parsing::valid(path, vars, errorstr)) {
+                            msg::error("failed while parsing {}, keeping the previous configuration", fmt::bolden(path));
+                            std::cout << errorstr << std::endl;
+                        } else {
+                            try {
+                                // a mistake the syntax check can't see mustn't take the server down
+                                msg::recoverable guard;
+                                state next;
+                                next.load(path, globals, tags, vars);
+                                st = std::move(next);
+                                msg::info("configuration reloaded");
+                            } catch (const msg::failure& err) {
+                                msg::error("{}, keeping the previous configuration", err.what());
+                            }
+                        }
+                    }
+                }
+
+                for (const auto& c : clients) ::close(c.fd);
+                ::close(listener);
+                fs::remove(sockpath, ec);
+                return 1;
+            }
+
+            optional<reply> ask(sview config, sview request) {
+                string sockpath = socketpath(config);
+                sockaddr_un addr{};
+                addr.sun_family = AF_UNIX;
+                if (sockpath.size() >= sizeof(addr.sun_path)) return nullopt;
+                std::memcpy(addr.sun_path, sockpath.c_str(), sockpath.size() + 1);
+
+                int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+                if (fd < 0) return nullopt;
+                if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof addr) < 0) {
+                    ::close(fd);
+                    return nullopt;
+                }
+
+                // a wedged server must not hang the shell prompt
+                timeval timeout{1, 0};
+                ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof timeout);
+                ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof timeout);
+
+                if (!sendall(fd, string(request) + "\n")) {
+                    ::close(fd);
+                    return nullopt;
+                }
+
+                string input;
+                char buffer[4096];
+                size_t eol = string::npos;
+                size_t want = 0;
+                for (;;) {
+                    if (eol == string::npos && (eol = input.find('\n')) != string::npos) {
+                        sview header = sview(input).substr(0, eol);
+                        size_t space = header.find(' ');
+                        if (space == sview::npos) break;
+                        sview length = header.substr(space + 1);
+                        if (std::from_chars(length.data(), length.data() + length.size(), want).ec != std::errc()) break;
+                    }
+                    if (eol != string::npos && input.size() >= eol + 1 + want) {
+                        ::close(fd);
+                        // the server planned for other tags, the caller has to work it out itself
+                        if (input.starts_with("skip ")) return nullopt;
+                        return reply{input.starts_with("ok "), input.substr(eol + 1, want)};
+                    }
+                    ssize_t got = ::read(fd, buffer, sizeof buffer);
+                    if (got < 0 && errno == EINTR) continue;
+                    if (got <= 0) break;
+                    input.append(buffer, size_t(got));
+                }
+                ::close(fd);
+                return nullopt;
+            }
+
+        }; // END serve
+    }; // END actions
+}; // END confidant
@@ -0,0 +1,41 @@
+// SPDX-FileCopyrightText: 2026 Will Reed <wreed@disroot.org>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "settings/global.hpp"
+
+using sview = std::string_view;
+using std::string;
+using std::vector;
+using std::optional;
+
+namespace confidant {
+    namespace actions {
+        namespace serve {
+
+            // requests are single lines: 'get QUERY', 'status TAGS [NAME|PATH]',
+            // 'which TAGS PATH', 'reload' or 'ping', where TAGS is what tagset()
+            // gives for the tags the answer should be planned with. replies are
+            // 'ok LENGTH' or 'err LENGTH' followed by a newline and LENGTH bytes of
+            // payload, or 'skip 0' when the server was started with other tags.
+            struct reply {
+                bool ok;
+                string body;
+            };
+
+            string socketpath(sview config);
+            // a set of tags as one word: sorted, comma separated, '-' for none
+            string tagset(const vector<sview>& tags);
+            int run(sview path, const confidant::config::global::settings& globals, const vector<sview>& tags);
+            // ask the server for `config`, if one is running
+            optional<reply> ask(sview config, sview request);
+
+        }; // END serve
+    }; // END actions
+}; // END confidant
@@ -0,0 +1,106 @@
+// SPDX-FileCopyrightText: 2026 Will Reed <wreed@disroot.org>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <filesystem>
+#include <format>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "actions/link.hpp"
+#include "actions/status.hpp"
+#include "scan.hpp"
+#include "listing.hpp"
+
+namespace fs = std::filesystem;
+
+using sview = std::string_view;
+using std::string;
+using std::vector;
+using std::optional;
+using std::nullopt;
+
+namespace confidant {
+    namespace actions {
+        namespace status {
+
+            state check(const link::entry& e) {
+                std::error_code ec;
+                fs::file_status src = scan::status(e.source, ec);
+                if (!fs::exists(src)) return state::nosource;
+
+                fs::file_status dst = listing::symlink_status(e.destination, ec);
+                if (ec || dst.type() == fs::file_type::not_found) return state::missing;
+
+                if (e.type == config::local::linktype::copy
+                    || (e.type == config::local::linktype::hardlink && fs::is_directory(src))) {
+                    // placed files are only checked for being there, and being the right kind
+                    if (fs::is_symlink(dst) || fs::is_directory(dst) != fs::is_directory(src))
+                        return state::conflict;
+                    return state::linked;
+                }
+
+                if (fs::exists(e.destination, ec)) {
+                    if (fs::equivalent(e.source, e.destination, ec)) return state::linked;
+                    return state::conflict;
+                }
+                // a symlink pointing nowhere
+                return state::broken;
+            }
+
+            sview literal(state s) {
+                switch (s) {
+                    case state::linked:   return "linked";
+                    case state::missing:  return "missing";
+                    case state::broken:   return "broken";
+                    case state::conflict: return "conflict";
+                    case state::nosource: return "no-source";
+                }
+                std::unreachable();
+            }
+
+            vector<const link::entry*> select(const vector<link::entry>& entries, sview what) {
+                vector<const link::entry*> found;
+                fs::path asked = what.empty() ? fs::path() : fs::absolute(fs::path(what)).lexically_normal();
+                for (const auto& e : entries) {
+                    if (what.empty() || e.name == what || e.destination.lexically_normal() == asked)
+                        found.push_back(&e);
+                }
+                return found;
+            }
+
+            optional<link::entry> which(const vector<link::entry>& entries, sview path) {
+                fs::path asked = fs::absolute(fs::path(path)).lexically_normal();
+                for (const auto& e : entries) {
+                    if (e.destination.lexically_normal() == asked || e.source.lexically_normal() == asked)
+                        return e;
+                }
+                return nullopt;
+            }
+
+            string format(const vector<const link::entry*>& entries) {
+                string out;
+                for (const auto* e : entries)
+                    std::format_to(std::back_inserter(out), "{}\t{}\t{}\n", literal(check(*e)), e->name, e->destination.native());
+                return out;
+            }
+
+            string format(const link::entry& e) {
+                return std::format("{}\t{}\t{}\n", e.name, e.source.native(), e.destination.native());
+            }
+
+            bool linked(sview report) {
+                while (!report.empty()) {
+                    if (!report.starts_with("linked\t")) return false;
+                    size_t eol = report.find('\n');
+                    if (eol == sview::npos) break;
+                    report.remove_prefix(eol + 1);
+                }
+                return true;
+            }
+
+        }; // END status
+    }; // END actions
+}; // END confidant
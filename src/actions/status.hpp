@@ -0,0 +1,40 @@
+// SPDX-FileCopyrightText: 2026 Will Reed <wreed@disroot.org>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "actions/link.hpp"
+#include "settings/local.hpp"
+
+using sview = std::string_view;
+using std::string;
+using std::vector;
+using std::optional;
+
+namespace confidant {
+    namespace actions {
+        namespace status {
+
+            enum class state { linked, missing, broken, conflict, nosource };
+
+            state check(const confidant::actions::link::entry& e);
+            sview literal(state s);
+
+            // entries whose name or destination equals `what`; everything when empty
+            vector<const confidant::actions::link::entry*> select(const vector<confidant::actions::link::entry>& entries, sview what);
+            // the entry managing `path`, as either its source or destination
+            optional<confidant::actions::link::entry> which(const vector<confidant::actions::link::entry>& entries, sview path);
+
+            string format(const vector<const confidant::actions::link::entry*>& entries);
+            string format(const confidant::actions::link::entry& e);
+            // whether every line of a formatted report is in the linked state
+            bool linked(sview report);
+
+        }; // END status
+    }; // END actions
+}; // END confidant
@@ -0,0 +1,189 @@
+// SPDX-FileCopyrightText: 2026 Will Reed <wreed@disroot.org>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <charconv>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "settings/global.hpp"
+#include "settings/local.hpp"
+#include "actions/link.hpp"
+#include "actions/sysroot.hpp"
+#include "util.hpp"
+#include "xdg.hpp"
+#include "fmt.hpp"
+#include "msg.hpp"
+
+namespace fs = std::filesystem;
+
+using sview = std::string_view;
+using std::string;
+using std::vector;
+using std::optional;
+using std::nullopt;
+
+namespace confidant {
+    namespace actions {
+        namespace sysroot {
+
+            // same limit the kernel applies before giving up with ELOOP
+            constexpr int maxhops = 40;
+
+            optional<fs::path> resolve(const fs::path& root, const fs::path& path, bool last) {
+                std::deque<fs::path> pending(path.relative_path().begin(), path.relative_path().end());
+                vector<fs::path> parts;
+                bool missing = false;
+                int hops = 0;
+
+                while (!pending.empty()) {
+                    fs::path part = pending.front();
+                    pending.pop_front();
+
+                    if (part.empty() || part == ".") continue;
+                    if (part == "..") {
+                        // '..' at the top of the image is the top of the image
+                        if (!parts.empty()) parts.pop_back();
+                        continue;
+                    }
+                    if (missing || (pending.empty() && !last)) {
+                        parts.push_back(part);
+                        continue;
+                    }
+
+                    fs::path here = root;
+                    for (const auto& p : parts) here /= p;
+                    here /= part;
+
+                    std::error_code ec;
+                    fs::file_status st = fs::symlink_status(here, ec);
+                    if (!fs::exists(st)) {
+                        // nothing below a missing directory can be a symlink
+                        missing = true;
+                        parts.push_back(part);
+                        continue;
+                    }
+                    if (!fs::is_symlink(st)) {
+                        parts.push_back(part);
+                        continue;
+                    }
+
+                    if (++hops > maxhops) return nullopt;
+                    fs::path target = fs::read_symlink(here, ec);
+                    if (ec) return nullopt;
+                    // an absolute target starts over from the image root, not the host's
+                    if (target.is_absolute()) parts.clear();
+                    auto rel = target.relative_path();
+                    for (auto it = std::make_reverse_iterator(rel.end()); it != std::make_reverse_iterator(rel.begin()); ++it)
+                        pending.push_front(*it);
+                }
+
+                fs::path resolved = root;
+                for (const auto& p : parts) resolved /= p;
+                return resolved;
+            }
+
+            optional<account> lookup(const fs::path& root, sview user) {
+                auto passwd = resolve(root, "/etc/passwd", true);
+                if (!passwd) return nullopt;
+
+                std::ifstream file(passwd.value());
+                string line;
+                while (std::getline(file, line)) {
+                    // name:password:uid:gid:gecos:home:shell
+                    vector<sview> fields;
+                    sview rest = line;
+                    for (size_t colon; (colon = rest.find(':')) != sview::npos; rest.remove_prefix(colon + 1))
+                        fields.push_back(rest.substr(0, colon));
+                    fields.push_back(rest);
+
+                    if (fields.size() < 7 || fields[0] != user) continue;
+                    account a{string(user), fs::path(fields[5]), 0};
+                    auto [p, ec] = std::from_chars(fields[2].data(), fields[2].data() + fields[2].size(), a.uid);
+                    if (ec != std::errc() || !a.home.is_absolute()) return nullopt;
+                    return a;
+                }
+                return nullopt;
+            }
+
+            int run(sview path, const config::global::settings& globals, const vector<sview>& tags,
+                    sview rootstr, sview user, bool sources, bool dry) {
+
+                fs::path root = fs::absolute(fs::path(rootstr)).lexically_normal();
+                if (!root.has_filename()) root = root.parent_path();
+                if (!fs::is_directory(root))
+                    msg::fatal("sysroot {} is not a directory", fmt::bolden(root.string()));
+
+                auto who = lookup(root, user);
+                if (!who)
+                    msg::fatal("user {} not found in {}", fmt::bolden(user), fmt::bolden((root / "etc/passwd").string()));
+
+                // ${repo} must name the repository as the image will see it
+                string imagepath(path);
+                if (sources) {
+                    fs::path rel = fs::absolute(fs::path(path)).lexically_normal().lexically_relative(root);
+                    if (rel.empty() || *rel.begin() == "..")
+                        msg::fatal("{} is not inside sysroot {}", fmt::bolden(path), fmt::bolden(root.string()));
+                    imagepath = (fs::path("/") / rel).string();
+                }
+
+                // the image's defaults, never the build host's environment
+                variables::resolver vars(path, xdg::homes(who->home, who->uid), who->home.string(), who->user,
+                                         root, fs::path(imagepath).parent_path().string());
+                config::local::settings conf = config::local::serialize(path, globals, vars);
+                if (!conf.packages.empty())
+                    msg::warn("packages are not applied with {}", fmt::bolden("--sysroot"));
+
+                int linked = 0;
+                int failed = 0;
+                vector<link::entry> entries;
+                for (const auto& planned : link::plan(conf, tags)) {
+                    if (!planned.destination.is_absolute()) {
+                        msg::warn("destination {} of {} is not absolute, skipping",
+                            fmt::bolden(planned.destination.string()), fmt::bolden(planned.name));
+                        continue;
+                    }
+
+                    link::entry e = planned;
+                    auto parent = resolve(root, planned.destination.parent_path(), true);
+                    if (!parent) {
+                        msg::error("too many levels of symbolic links under {}", fmt::bolden(planned.destination.string()));
+                        failed++;
+                        continue;
+                    }
+                    e.destination = parent.value() / planned.destination.filename();
+                    // always set, so an existing destination is never followed out of the image
+                    e.target = planned.source;
+
+                    if (sources && planned.source.is_absolute()) {
+                        auto source = resolve(root, planned.source, true);
+                        if (!source) {
+                            msg::error("too many levels of symbolic links under {}", fmt::bolden(planned.source.string()));
+                            failed++;
+                            continue;
+                        }
+                        e.source = source.value();
+                    }
+
+                    entries.push_back(e);
+                }
+
+                link::prefetch(entries);
+                for (const auto& e : entries) {
+                    link::result res = link::apply(e, globals, dry);
+                    if (res == link::result::fatal) return 1;
+                    if (res == link::result::failed) failed++;
+                    if (res == link::result::linked) linked++;
+                }
+
+                msg::pretty("applied {} links under {}", linked, fmt::bolden(root.string()));
+                return failed > 0 ? 1 : 0;
+            }
+
+        }; // END sysroot
+    }; // END actions
+}; // END confidant
@@ -0,0 +1,42 @@
+// SPDX-FileCopyrightText: 2026 Will Reed <wreed@disroot.org>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "settings/global.hpp"
+
+using sview = std::string_view;
+using std::string;
+using std::vector;
+using std::optional;
+
+namespace confidant {
+    namespace actions {
+        namespace sysroot {
+
+            // a user as the image's own /etc/passwd describes them
+            struct account {
+                string user;
+                std::filesystem::path home;
+                int uid;
+            };
+
+            // resolve `path` as if `root` were '/'; absolute symlink targets and '..'
+            // are kept inside the root, the final component is only followed when `last` is set
+            optional<std::filesystem::path> resolve(const std::filesystem::path& root, const std::filesystem::path& path, bool last);
+            optional<account> lookup(const std::filesystem::path& root, sview user);
+
+            // link into the image at `root`; with `sources` the repository is expected
+            // inside the image too, and links point at its in-image location
+            int run(sview path, const confidant::config::global::settings& globals, const vector<sview>& tags,
+                    sview root, sview user, bool sources, bool dry);
+
+        }; // END sysroot
+    }; // END actions
+}; // END confidant
@@ -0,0 +1,286 @@
+// SPDX-FileCopyrightText: 2026 Will Reed <wreed@disroot.org>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <set>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include "settings/global.hpp"
+#include "settings/local.hpp"
+#include "actions/link.hpp"
+#include "actions/hooks.hpp"
+#include "actions/watch.hpp"
+#include "parse.hpp"
+#include "util.hpp"
+#include "fmt.hpp"
+#include "msg.hpp"
+
+namespace fs = std::filesystem;
+
+using sview = std::string_view;
+using std::string;
+using std::vector;
+
+namespace confidant {
+    namespace actions {
+        namespace watch {
+
+            // how long the event queue has to stay quiet before acting on it,
+            // so an editor's write-rename-chmod dance is handled only once
+            constexpr int settle = 150;
+
+            constexpr uint32_t dirmask = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO
+                                       | IN_CLOSE_WRITE | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+
+            struct watcher {
+                int fd = -1;
+                int confwd = -1;
+                // watch descriptor -> directory, and the entries that live below it
+                std::unordered_map<int, fs::path> dirs;
+                std::unordered_map<int, vector<size_t>> owners;
+                std::unordered_map<string, int> wds;
+
+                int add(const fs::path& dir) {
+                    auto found = wds.find(dir.native());
+                    if (found != wds.end()) return found->second;
+                    int wd = inotify_add_watch(fd, dir.c_str(), dirmask);
+                    if (wd < 0) {
+                        msg::warn("unable to watch directory {}: {}",
+                            fmt::bolden(util::unexpandhome(dir.string())), std::strerror(errno));
+                        return -1;
+                    }
+                    dirs[wd] = dir;
+                    wds[dir.native()] = wd;
+                    return wd;
+                }
+
+                void clear() {
+                    for (const auto& [wd, _] : dirs)
+                        inotify_rm_watch(fd, wd);
+                    dirs.clear();
+                    owners.clear();
+                    wds.clear();
+                    confwd = -1;
+                }
+            };
+
+            // the closest directory that exists right now; a watch there will
+            // tell us when the missing part of the path shows up
+            static fs::path existing(fs::path p) {
+                std::error_code ec;
+                while (!p.empty() && !fs::is_directory(p, ec)) {
+                    fs::path parent = p.parent_path();
+                    if (parent == p) break;
+                    p = parent;
+                }
+                return p;
+            }
+
+            // whether p is equal to, or an ancestor of, x
+            static bool covers(const fs::path& p, const fs::path& x) {
+                auto [a, b] = std::mismatch(p.begin(), p.end(), x.begin(), x.end());
+                return a == p.end();
+            }
+
+            static void install(watcher& w, const fs::path& config, const vector<link::entry>& entries) {
+                w.clear();
+                w.confwd = w.add(fs::absolute(config).parent_path());
+                for (size_t n = 0; n < entries.size(); n++) {
+                    // a relative path has no parent to fall back on once it runs out
+                    int src = w.add(existing(fs::absolute(entries[n].source).parent_path()));
+                    int dst = w.add(existing(fs::absolute(entries[n].destination).parent_path()));
+                    if (src >= 0) w.owners[src].push_back(n);
+                    if (dst >= 0 && dst != src) w.owners[dst].push_back(n);
+                }
+                msg::info("watching {} directories for {} links", w.dirs.size(), entries.size());
+            }
+
+            // remove a link we previously created, leaving anything else alone
+            static void unlink(const link::entry& e) {
+                std::error_code ec;
+                if (!fs::is_symlink(e.destination, ec)) return;
+                if (fs::read_symlink(e.destination, ec) != e.source || ec) return;
+                if (fs::remove(e.destination, ec))
+                    msg::pretty("unlinked {}", util::unexpandhome(e.destination.string()));
+                else if (ec)
+                    msg::error("failed to remove {}: {}", fmt::bolden(e.destination.string()), ec.message());
+            }
+
+            // diff the freshly planned entries against the previous ones, keyed
+            // on destination, and only touch what actually changed
+            static vector<size_t> reconcile(const vector<link::entry>& previous, const vector<link::entry>& next) {
+                std::unordered_map<string, const link::entry*> old;
+                old.reserve(previous.size());
+                for (const auto& e : previous)
+                    old[e.destination.native()] = &e;
+
+                vector<size_t> changed;
+                for (size_t n = 0; n < next.size(); n++) {
+                    auto found = old.find(next[n].destination.native());
+                    if (found == old.end()) {
+                        changed.push_back(n);
+                        continue;
+                    }
+                    if (!(*found->second == next[n])) {
+                        unlink(*found->second);
+                        changed.push_back(n);
+                    }
+                    old.erase(found);
+                }
+                // whatever is left was dropped from the config
+                for (const auto& [_, e] : old)
+                    unlink(*e);
+                return changed;
+            }
+
+            int run(sview path, const config::global::settings& globals, const vector<sview>& tags) {
+                fs::path config = fs::path(path);
+                string confname = config.filename().string();
+
+                config::local::settings conf = config::local::serialize(path, globals);
+                vector<link::entry> entries = link::plan(conf, tags);
+                if (!conf.packages.empty())
+                    msg::warn("packages are only applied by {}", fmt::bolden("link"));
+
+                std::set<string> fired;
+                for (const auto& e : entries) {
+                    link::result r = link::apply(e, globals, false);
+                    if (r == link::result::fatal) return 1;
+                    if (r == link::result::linked) fired.insert(e.hooks.begin(), e.hooks.end());
+                }
+                hooks::run(conf, fired, 0, false);
+
+                watcher w;
+                w.fd = inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+                if (w.fd < 0) {
+                    msg::error("failed to initialize inotify: {}", std::strerror(errno));
+                    return 1;
+                }
+                install(w, config, entries);
+
+                bool pending = false, reload = false, rewatch = false, everything = false;
+                vector<size_t> dirty;
+
+                alignas(struct inotify_event) char buffer[16 * 1024];
+
+                for (;;) {
+                    pollfd pfd{w.fd, POLLIN, 0};
+                    int ready = poll(&pfd, 1, pending ? settle : -1);
+                    if (ready < 0) {
+                        if (errno == EINTR) continue;
+                        msg::error("failed to wait for file system events: {}", std::strerror(errno));
+                        close(w.fd);
+                        return 1;
+                    }
+
+                    if (ready > 0) {
+                        ssize_t len;
+                        while ((len = read(w.fd, buffer, sizeof buffer)) > 0) {
+                            for (char* p = buffer; p < buffer + len;) {
+                                auto* ev = reinterpret_cast<struct inotify_event*>(p);
+                                p += sizeof(struct inotify_event) + ev->len;
+
+                                if (ev->mask & IN_Q_OVERFLOW) {
+                                    pending = everything = rewatch = true;
+                                    continue;
+                                }
+                                // leftovers from watches we removed ourselves
+                                if (!w.dirs.contains(ev->wd)) continue;
+                                pending = true;
+
+                                if (ev->mask & (IN_IGNORED | IN_DELETE_SELF | IN_MOVE_SELF)) {
+                                    rewatch = true;
+                                    continue;
+                                }
+
+                                sview name = ev->len > 0 ? sview(ev->name) : sview();
+                                if (ev->wd == w.confwd && name == confname) {
+                                    reload = true;
+                                    continue;
+                                }
+                                if ((ev->mask & IN_ISDIR) && (ev->mask & (IN_CREATE | IN_MOVED_TO)))
+                                    rewatch = true;
+
+                                auto dir = w.dirs.find(ev->wd);
+                                auto owners = w.owners.find(ev->wd);
+                                if (dir == w.dirs.end() || owners == w.owners.end()) continue;
+
+                                fs::path changed = dir->second / name;
+                                for (size_t n : owners->second) {
+                                    if (covers(changed, entries[n].source) || covers(changed, entries[n].destination))
+                                        dirty.push_back(n);
+                                }
+                            }
+                        }
+                        continue;
+                    }
+
+                    // the queue settled, act on what accumulated
+                    pending = false;
+
+                    if (reload) {
+                        std::string errorstr;
+                        variables::resolver vars(path);
+                        if (!ucl::parsing::valid(path, vars, errorstr)) {
+                            msg::error("failed while parsing {}, keeping the previous configuration", fmt::bolden(path));
+                            std::cout << errorstr << std::endl;
+                        } else {
+                            msg::info("configuration changed, reloading");
+                            try {
+                                // what the syntax check can't see, like an unknown hook or a cycle,
+                                // mustn't end the watch either
+                                msg::recoverable guard;
+                                // with the variables the check already worked out
+                                config::local::settings fresh = config::local::serialize(path, globals, vars);
+                                vector<link::entry> next = link::plan(fresh, tags);
+                                // pending source changes refer to the old entries
+                                if (!dirty.empty()) everything = true;
+                                dirty = reconcile(entries, next);
+                                conf = std::move(fresh);
+                                entries = std::move(next);
+                                rewatch = true;
+                            } catch (const msg::failure& err) {
+                                msg::error("{}, keeping the previous configuration", err.what());
+                            }
+                        }
+                    }
+
+                    if (everything) {
+                        dirty.resize(entries.size());
+                        for (size_t n = 0; n < entries.size(); n++) dirty[n] = n;
+                    }
+
+                    std::sort(dirty.begin(), dirty.end());
+                    dirty.erase(std::unique(dirty.begin(), dirty.end()), dirty.end());
+                    std::set<string> fired;
+                    for (size_t n : dirty) {
+                        link::result r = link::apply(entries[n], globals, false);
+                        if (r == link::result::fatal) {
+                            close(w.fd);
+                            return 1;
+                        }
+                        if (r == link::result::linked) fired.insert(entries[n].hooks.begin(), entries[n].hooks.end());
+                    }
+                    // a failing hook is reported, but shouldn't stop the watch
+                    hooks::run(conf, fired, 0, false);
+
+                    if (rewatch) install(w, config, entries);
+
+                    dirty.clear();
+                    reload = rewatch = everything = false;
+                }
+            }
+
+        }; // END watch
+    }; // END actions
+}; // END confidant
@@ -0,0 +1,20 @@
+// SPDX-FileCopyrightText: 2026 Will Reed <wreed@disroot.org>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <string_view>
+#include <vector>
+
+#include "settings/global.hpp"
+
+using sview = std::string_view;
+using std::vector;
+
+namespace confidant {
+    namespace actions {
+        namespace watch {
+            int run(sview path, const confidant::config::global::settings& globals, const vector<sview>& tags);
+        }; // END watch
+    }; // END actions
+}; // END confidant
@@ -0,0 +1,19 @@
+// SPDX-FileCopyrightText: 2026 Will Reed <wreed@disroot.org>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <cstring>
+#include <string_view>
+
+#include "arena.hpp"
+
+namespace arena {
+
+    std::string_view strings::intern(std::string_view s) {
+        if (auto it = seen.find(s); it != seen.end()) return *it;
+        auto* copy = static_cast<char*>(pool.allocate(s.size() + 1, alignof(char)));
+        std::memcpy(copy, s.data(), s.size());
+        copy[s.size()] = '\0';
+        return *seen.emplace(copy, s.size()).first;
+    }
+
+}; // END arena
@@ -0,0 +1,30 @@
+// SPDX-FileCopyrightText: 2026 Will Reed <wreed@disroot.org>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <string_view>
+#include <unordered_set>
+
+// one copy of every distinct string, carved out of large blocks rather than
+// allocated one by one; views handed out stay valid for as long as the pool
+namespace arena {
+
+    class strings {
+    public:
+        strings() = default;
+        strings(const strings&) = delete;
+        strings& operator=(const strings&) = delete;
+
+        // the pooled copy of `s`, NUL terminated
+        std::string_view intern(std::string_view s);
+        std::size_t size() const { return seen.size(); }
+
+    private:
+        std::pmr::monotonic_buffer_resource pool{64 * 1024};
+        std::pmr::unordered_set<std::string_view> seen{&pool};
+    };
+
+}; // END arena
@@ -0,0 +1,407 @@
+// SPDX-FileCopyrightText: 2026 Will Reed <wreed@disroot.org>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <atomic>
+#include <cerrno>
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "deploy.hpp"
+#include "digest.hpp"
+#include "xdg.hpp"
+
+namespace fs = std::filesystem;
+
+namespace deploy {
+
+    static std::error_code lasterror() {
+        return std::error_code(errno, std::generic_category());
+    }
+
+    // hidden, next to the destination so the final rename stays on one filesystem
+    fs::path temporary(const fs::path& to) {
+        static std::atomic<unsigned> counter = 0;
+        return to.parent_path() / std::format(".{}.confidant-{}-{}", to.filename().string(), getpid(), counter++);
+    }
+
+    fs::path backup(const fs::path& to) {
+        static const std::string stamp = [] {
+            std::time_t now = std::time(nullptr);
+            std::tm local;
+            localtime_r(&now, &local);
+            char buf[32];
+            std::strftime(buf, sizeof(buf), "%Y%m%dT%H%M%S", &local);
+            return std::string(buf);
+        }();
+        fs::path first = to;
+        first += std::format(".confidant-backup-{}", stamp);
+        // the stamp is only to the second, and a run can back the same path up twice
+        fs::path saved = first;
+        std::error_code ec;
+        for (unsigned n = 1; fs::exists(fs::symlink_status(saved, ec)); n++) {
+            saved = first;
+            saved += std::format("-{}", n);
+        }
+        return saved;
+    }
+
+    bool swap(const fs::path& staged, const fs::path& to, const fs::path& saved, std::error_code& ec) {
+        std::error_code ignored;
+        if (renameat2(AT_FDCWD, staged.c_str(), AT_FDCWD, to.c_str(), RENAME_EXCHANGE) != 0) {
+            if (errno != EINVAL && errno != ENOSYS) {
+                ec = lasterror();
+                fs::remove_all(staged, ignored);
+                return false;
+            }
+            // no exchange on this filesystem; a rename still replaces a file atomically,
+            // anything else has to be moved out of the way first
+            if (!saved.empty()) {
+                if (renameat2(AT_FDCWD, to.c_str(), AT_FDCWD, saved.c_str(), RENAME_NOREPLACE) != 0) {
+                    ec = lasterror();
+                    fs::remove_all(staged, ignored);
+                    return false;
+                }
+            } else if (fs::is_directory(fs::symlink_status(to, ignored))) {
+                fs::remove_all(to, ec);
+            }
+            if (ec || rename(staged.c_str(), to.c_str()) != 0) {
+                if (!ec) ec = lasterror();
+                fs::remove_all(staged, ignored);
+                return false;
+            }
+            return true;
+        }
+
+        // the old contents are at `staged` now
+        if (saved.empty()) {
+            fs::remove_all(staged, ec);
+            return !ec;
+        }
+        if (renameat2(AT_FDCWD, staged.c_str(), AT_FDCWD, saved.c_str(), RENAME_NOREPLACE) != 0) {
+            ec = lasterror();
+            return false;
+        }
+        return true;
+    }
+
+    // the kernel copies for us; copy_file_range refuses some pairs of
+    // filesystems on older kernels, sendfile does not
+    static bool transfer(int in, int out) {
+        bool ranged = true;
+        for (;;) {
+            ssize_t n = ranged
+                ? copy_file_range(in, nullptr, out, nullptr, 1 << 30, 0)
+                : sendfile(out, in, nullptr, 1 << 30);
+            if (n == 0) return true;
+            if (n > 0) continue;
+            if (errno == EINTR) continue;
+            if (ranged && (errno == EXDEV || errno == ENOSYS || errno == EINVAL || errno == EOPNOTSUPP)) {
+                ranged = false;
+                continue;
+            }
+            return false;
+        }
+    }
+
+    bool copy(const fs::path& from, const fs::path& to, std::error_code& ec) {
+        int in = open(from.c_str(), O_RDONLY | O_CLOEXEC);
+        if (in < 0) {
+            ec = lasterror();
+            return false;
+        }
+        struct stat st;
+        if (fstat(in, &st) != 0) {
+            ec = lasterror();
+            close(in);
+            return false;
+        }
+
+        fs::path tmp = temporary(to);
+        int out = open(tmp.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+        if (out < 0) {
+            ec = lasterror();
+            close(in);
+            return false;
+        }
+
+        bool ok = ioctl(out, FICLONE, in) == 0 || transfer(in, out);
+        if (ok) {
+            const struct timespec times[2] = { st.st_atim, st.st_mtim };
+            ok = fchmod(out, st.st_mode & 07777) == 0 && futimens(out, times) == 0;
+        }
+        if (!ok) ec = lasterror();
+        close(in);
+        if (close(out) != 0 && ok) {
+            ec = lasterror();
+            ok = false;
+        }
+
+        if (ok && rename(tmp.c_str(), to.c_str()) != 0) {
+            ec = lasterror();
+            ok = false;
+        }
+        if (!ok) unlink(tmp.c_str());
+        return ok;
+    }
+
+    // both regular files of the same size; only then is hashing worth it
+    static bool comparable(const fs::path& from, const fs::path& to, struct stat& a, struct stat& b) {
+        return stat(from.c_str(), &a) == 0 && stat(to.c_str(), &b) == 0
+            && S_ISREG(a.st_mode) && S_ISREG(b.st_mode) && a.st_size == b.st_size;
+    }
+
+    bool identical(const fs::path& from, const fs::path& to) {
+        struct stat a, b;
+        if (!comparable(from, to, a, b)) return false;
+        if (a.st_dev == b.st_dev && a.st_ino == b.st_ino) return true;
+        if (a.st_size == 0) return true;
+        auto x = digest::file(from);
+        auto y = digest::file(to);
+        return x && y && x.value() == y.value();
+    }
+
+    void warm(const std::vector<std::pair<fs::path, fs::path>>& pairs) {
+        std::vector<fs::path> paths;
+        for (const auto& [from, to] : pairs) {
+            struct stat a, b;
+            if (!comparable(from, to, a, b) || a.st_size == 0) continue;
+            if (a.st_dev == b.st_dev && a.st_ino == b.st_ino) continue;
+            paths.push_back(from);
+            paths.push_back(to);
+        }
+        digest::warm(paths);
+    }
+
+    bool hardlink(const fs::path& from, const fs::path& to, std::error_code& ec) {
+        std::error_code ignored;
+        if (fs::exists(to, ignored) && fs::equivalent(from, to, ignored)) return true;
+
+        fs::path tmp = temporary(to);
+        if (link(from.c_str(), tmp.c_str()) != 0) {
+            ec = lasterror();
+            return false;
+        }
+        if (rename(tmp.c_str(), to.c_str()) != 0) {
+            ec = lasterror();
+            unlink(tmp.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    std::size_t tree(const fs::path& from, const fs::path& to, bool linking, std::error_code& ec) {
+        std::size_t written = 0;
+
+        fs::create_directories(to, ec);
+        if (ec) return written;
+        fs::permissions(to, fs::status(from).permissions(), ec);
+        if (ec) return written;
+
+        // files are handled after the walk, so copies can be compared in one parallel pass
+        std::vector<std::pair<fs::path, fs::path>> files;
+        for (auto it = fs::recursive_directory_iterator(from, ec); !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+            fs::path target = to / it->path().lexically_relative(from);
+            fs::file_status st = it->symlink_status(ec);
+            if (ec) break;
+
+            // something else where this goes, like a file that became a directory, makes way
+            std::error_code missing;
+            fs::file_status there = fs::symlink_status(target, missing);
+            if (fs::exists(there) && there.type() != st.type()) {
+                fs::remove_all(target, ec);
+                if (ec) return written;
+                there = fs::file_status(fs::file_type::not_found);
+                written++;
+            }
+
+            if (fs::is_directory(st)) {
+                fs::create_directory(target, it->path(), ec);
+            } else if (fs::is_symlink(st)) {
+                // links inside the tree are reproduced, not followed
+                fs::path link = fs::read_symlink(it->path(), ec);
+                if (ec) return written;
+                if (!fs::exists(there)) {
+                    fs::create_symlink(link, target, ec);
+                    if (!ec) written++;
+                } else if (fs::read_symlink(target, missing) != link || missing) {
+                    // swapped in, so it never dangles or goes missing in between
+                    fs::path staged = temporary(target);
+                    fs::create_symlink(link, staged, ec);
+                    if (!ec) fs::rename(staged, target, ec);
+                    std::error_code ignored;
+                    if (ec) fs::remove(staged, ignored);
+                    else written++;
+                }
+            } else if (fs::is_regular_file(st)) {
+                files.emplace_back(it->path(), target);
+            }
+            if (ec) return written;
+        }
+        if (ec) return written;
+
+        if (!linking) warm(files);
+        for (const auto& [source, target] : files) {
+            if (linking) {
+                std::error_code ignored;
+                if (fs::exists(target, ignored) && fs::equivalent(source, target, ignored)) continue;
+                if (!hardlink(source, target, ec)) return written;
+            } else {
+                if (identical(source, target)) continue;
+                if (!deploy::copy(source, target, ec)) return written;
+            }
+            written++;
+        }
+
+        // what was deleted from the source goes from the copy too
+        std::vector<fs::path> gone;
+        for (auto it = fs::recursive_directory_iterator(to, ec); !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+            std::error_code missing;
+            if (fs::exists(fs::symlink_status(from / it->path().lexically_relative(to), missing))) continue;
+            gone.push_back(it->path());
+            it.disable_recursion_pending();
+        }
+        if (ec) return written;
+        for (const auto& path : gone) {
+            fs::remove_all(path, ec);
+            if (ec) return written;
+            written++;
+        }
+        return written;
+    }
+
+    // what an earlier run placed at a destination: a whole tree, or a file with these contents
+    struct mark {
+        bool tree = false;
+        std::uint64_t hash = 0;
+    };
+
+    // one destination per line, 'tree PATH' or 'file HASH PATH'; loaded on
+    // first use, written back when the program exits
+    class registry {
+    public:
+        registry() {
+            try {
+                path = xdg::homes().at("XDG_STATE_HOME") / "confidant" / "placed";
+            } catch (...) {
+                // no HOME, nothing can be told apart from someone else's files
+                return;
+            }
+            std::ifstream in(path);
+            std::string line;
+            while (std::getline(in, line)) {
+                std::string_view rest = line;
+                mark m;
+                if (rest.starts_with("tree ")) {
+                    m.tree = true;
+                    rest.remove_prefix(5);
+                } else if (rest.starts_with("file ")) {
+                    rest.remove_prefix(5);
+                    auto res = std::from_chars(rest.data(), rest.data() + rest.size(), m.hash, 16);
+                    if (res.ec != std::errc() || res.ptr == rest.data() + rest.size() || *res.ptr != ' ') continue;
+                    rest.remove_prefix(res.ptr - rest.data() + 1);
+                } else {
+                    continue;
+                }
+                if (!rest.empty()) known.insert_or_assign(std::string(rest), m);
+            }
+        }
+
+        ~registry() {
+            if (!dirty || path.empty()) return;
+            std::error_code ec;
+            fs::create_directories(path.parent_path(), ec);
+            fs::path tmp = path;
+            tmp += std::format(".{}", getpid());
+            {
+                std::ofstream out(tmp, std::ios::trunc);
+                for (const auto& [dest, m] : known) {
+                    if (m.tree) out << std::format("tree {}\n", dest);
+                    else out << std::format("file {:016x} {}\n", m.hash, dest);
+                }
+                if (!out) {
+                    fs::remove(tmp, ec);
+                    return;
+                }
+            }
+            fs::rename(tmp, path, ec);
+        }
+
+        std::optional<mark> find(const fs::path& dest) {
+            std::lock_guard lock(mutex);
+            auto found = known.find(dest.native());
+            if (found == known.end()) return std::nullopt;
+            return found->second;
+        }
+
+        void add(const fs::path& dest, mark m) {
+            // a line per destination; such a path is simply never ours
+            if (dest.native().find('\n') != std::string::npos) return;
+            std::lock_guard lock(mutex);
+            known.insert_or_assign(dest.native(), m);
+            dirty = true;
+        }
+
+        void remove(const fs::path& dest) {
+            std::lock_guard lock(mutex);
+            if (known.erase(dest.native()) > 0) dirty = true;
+        }
+
+    private:
+        fs::path path;
+        std::mutex mutex;
+        std::unordered_map<std::string, mark> known;
+        bool dirty = false;
+    };
+
+    static registry& placed() {
+        static registry r;
+        return r;
+    }
+
+    bool ours(const fs::path& to) {
+        auto m = placed().find(to);
+        if (!m) return false;
+        std::error_code ec;
+        fs::file_status st = fs::symlink_status(to, ec);
+        if (m->tree) return fs::is_directory(st);
+        // edited since it was copied, it's someone's work now
+        if (!fs::is_regular_file(st)) return false;
+        auto h = digest::file(to);
+        return h && h.value() == m->hash;
+    }
+
+    void claim(const fs::path& to) {
+        std::error_code ec;
+        fs::file_status st = fs::symlink_status(to, ec);
+        if (fs::is_directory(st)) {
+            placed().add(to, mark{true, 0});
+        } else if (auto h = digest::file(to)) {
+            placed().add(to, mark{false, h.value()});
+        }
+    }
+
+    void disown(const fs::path& to) {
+        placed().remove(to);
+    }
+
+}; // END deploy
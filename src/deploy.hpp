@@ -0,0 +1,51 @@
+// SPDX-FileCopyrightText: 2026 Will Reed <wreed@disroot.org>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+// placing real files rather than symlinks; everything is written under a
+// temporary name next to the destination and renamed over it, so readers
+// see either the old file or the new one, never a partial copy
+namespace deploy {
+
+    // a hidden name beside `to`, on the same filesystem, for staging its replacement
+    std::filesystem::path temporary(const std::filesystem::path& to);
+    // where `to` is moved aside to by a backup; one timestamp for the whole
+    // run, and a counter after it when that name is taken
+    std::filesystem::path backup(const std::filesystem::path& to);
+    // put `staged` in place of `to` with one atomic rename; the old contents are moved
+    // to `saved` when given and deleted otherwise. if `staged` still exists after a
+    // failure, it holds what used to be at `to`
+    bool swap(const std::filesystem::path& staged, const std::filesystem::path& to,
+              const std::filesystem::path& saved, std::error_code& ec);
+
+    // contents, mode and timestamps; extents are shared with FICLONE where the
+    // filesystem can, otherwise copied in the kernel, never through userspace
+    bool copy(const std::filesystem::path& from, const std::filesystem::path& to, std::error_code& ec);
+    // same contents, by size and then by (cached) content hash
+    bool identical(const std::filesystem::path& from, const std::filesystem::path& to);
+    // hash every pair that identical() would have to read, in parallel, up front
+    void warm(const std::vector<std::pair<std::filesystem::path, std::filesystem::path>>& pairs);
+    bool hardlink(const std::filesystem::path& from, const std::filesystem::path& to, std::error_code& ec);
+    // mirror a directory into `to`, copying or hardlinking every file in it,
+    // correcting symlinks and removing what the source no longer has; returns
+    // the number of entries written or removed before any error, identical
+    // copies are left untouched and not counted
+    std::size_t tree(const std::filesystem::path& from, const std::filesystem::path& to, bool linking, std::error_code& ec);
+
+    // copies and trees placed by earlier runs are kept track of in
+    // $XDG_STATE_HOME/confidant/placed, so only those are ever refreshed in
+    // place; anything else at a destination is left to the conflict policy.
+    // whether `to` is what we put there, and for a file, unchanged since
+    bool ours(const std::filesystem::path& to);
+    // remember what is at `to` now as ours
+    void claim(const std::filesystem::path& to);
+    void disown(const std::filesystem::path& to);
+
+}; // END deploy
@@ -0,0 +1,284 @@
+// SPDX-FileCopyrightText: 2026 Will Reed <wreed@disroot.org>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "digest.hpp"
+#include "xdg.hpp"
+
+namespace fs = std::filesystem;
+
+using std::uint64_t;
+
+namespace digest {
+
+    // XXH64, as specified at https://github.com/Cyan4973/xxHash/blob/dev/doc/xxhash_spec.md;
+    // four independent lanes per 32 byte stripe keep the multipliers busy
+    constexpr uint64_t prime1 = 0x9E3779B185EBCA87ULL;
+    constexpr uint64_t prime2 = 0xC2B2AE3D27D4EB4FULL;
+    constexpr uint64_t prime3 = 0x165667B19E3779F9ULL;
+    constexpr uint64_t prime4 = 0x85EBCA77C2B2AE63ULL;
+    constexpr uint64_t prime5 = 0x27D4EB2F165667C5ULL;
+
+    static uint64_t read64(const unsigned char* p) {
+        uint64_t v;
+        std::memcpy(&v, p, sizeof(v));
+        if constexpr (std::endian::native == std::endian::big) v = std::byteswap(v);
+        return v;
+    }
+
+    static uint64_t read32(const unsigned char* p) {
+        std::uint32_t v;
+        std::memcpy(&v, p, sizeof(v));
+        if constexpr (std::endian::native == std::endian::big) v = std::byteswap(v);
+        return v;
+    }
+
+    static uint64_t round(uint64_t acc, uint64_t input) {
+        acc += input * prime2;
+        acc = std::rotl(acc, 31);
+        return acc * prime1;
+    }
+
+    static uint64_t merge(uint64_t acc, uint64_t val) {
+        acc ^= round(0, val);
+        return acc * prime1 + prime4;
+    }
+
+    uint64_t xxh64(const void* data, std::size_t len, uint64_t seed) {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        const unsigned char* end = p + len;
+        uint64_t h;
+
+        if (len >= 32) {
+            uint64_t v1 = seed + prime1 + prime2;
+            uint64_t v2 = seed + prime2;
+            uint64_t v3 = seed;
+            uint64_t v4 = seed - prime1;
+            for (; end - p >= 32; p += 32) {
+                v1 = round(v1, read64(p));
+                v2 = round(v2, read64(p + 8));
+                v3 = round(v3, read64(p + 16));
+                v4 = round(v4, read64(p + 24));
+            }
+            h = std::rotl(v1, 1) + std::rotl(v2, 7) + std::rotl(v3, 12) + std::rotl(v4, 18);
+            h = merge(h, v1);
+            h = merge(h, v2);
+            h = merge(h, v3);
+            h = merge(h, v4);
+        } else {
+            h = seed + prime5;
+        }
+
+        h += len;
+        for (; end - p >= 8; p += 8) {
+            h ^= round(0, read64(p));
+            h = std::rotl(h, 27) * prime1 + prime4;
+        }
+        if (end - p >= 4) {
+            h ^= read32(p) * prime1;
+            h = std::rotl(h, 23) * prime2 + prime3;
+            p += 4;
+        }
+        for (; p < end; p++) {
+            h ^= *p * prime5;
+            h = std::rotl(h, 11) * prime1;
+        }
+
+        h ^= h >> 33;
+        h *= prime2;
+        h ^= h >> 29;
+        h *= prime3;
+        h ^= h >> 32;
+        return h;
+    }
+
+    struct key {
+        uint64_t dev;
+        uint64_t ino;
+        uint64_t size;
+        uint64_t mtime;
+        bool operator==(const key&) const = default;
+    };
+
+    struct keyhash {
+        std::size_t operator()(const key& k) const { return xxh64(&k, sizeof(k)); }
+    };
+
+    static std::optional<key> identify(const struct stat& st) {
+        if (!S_ISREG(st.st_mode)) return std::nullopt;
+        return key{
+            uint64_t(st.st_dev), uint64_t(st.st_ino), uint64_t(st.st_size),
+            uint64_t(st.st_mtim.tv_sec) * 1000000000ULL + uint64_t(st.st_mtim.tv_nsec)
+        };
+    }
+
+    // loaded on first use, written back when the program exits with only what
+    // this run looked up or added; every refreshed copy is a new inode, and
+    // keeping the old ones would grow the file without end
+    class cache {
+    public:
+        cache() {
+            try {
+                path = xdg::homes().at("XDG_CACHE_HOME") / "confidant" / "hashes";
+            } catch (...) {
+                // no HOME, nowhere to keep anything
+                return;
+            }
+            std::ifstream in(path);
+            std::string line;
+            while (std::getline(in, line)) {
+                key k;
+                uint64_t h;
+                const char* p = line.data();
+                const char* end = p + line.size();
+                bool ok = true;
+                for (uint64_t* field : {&k.dev, &k.ino, &k.size, &k.mtime, &h}) {
+                    while (p < end && *p == ' ') p++;
+                    auto res = std::from_chars(p, end, *field, 16);
+                    if (res.ec != std::errc()) {
+                        ok = false;
+                        break;
+                    }
+                    p = res.ptr;
+                }
+                if (ok) known.emplace(k, slot{h, false});
+            }
+        }
+
+        ~cache() {
+            if (path.empty() || (!dirty && used == known.size())) return;
+            std::error_code ec;
+            fs::create_directories(path.parent_path(), ec);
+            fs::path tmp = path;
+            tmp += std::format(".{}", getpid());
+            {
+                std::ofstream out(tmp, std::ios::trunc);
+                for (const auto& [k, s] : known) {
+                    if (s.used) out << std::format("{:x} {:x} {:x} {:x} {:016x}\n", k.dev, k.ino, k.size, k.mtime, s.hash);
+                }
+                if (!out) {
+                    fs::remove(tmp, ec);
+                    return;
+                }
+            }
+            fs::rename(tmp, path, ec);
+        }
+
+        std::optional<uint64_t> find(const key& k) {
+            std::lock_guard lock(mutex);
+            auto found = known.find(k);
+            if (found == known.end()) return std::nullopt;
+            mark(found->second);
+            return found->second.hash;
+        }
+
+        void add(const key& k, uint64_t h) {
+            std::lock_guard lock(mutex);
+            auto it = known.try_emplace(k, slot{h, false}).first;
+            it->second.hash = h;
+            mark(it->second);
+            dirty = true;
+        }
+
+    private:
+        struct slot {
+            uint64_t hash;
+            bool used;
+        };
+
+        void mark(slot& s) {
+            if (s.used) return;
+            s.used = true;
+            used++;
+        }
+
+        fs::path path;
+        std::mutex mutex;
+        std::unordered_map<key, slot, keyhash> known;
+        std::size_t used = 0;
+        bool dirty = false;
+    };
+
+    static cache& cached() {
+        static cache c;
+        return c;
+    }
+
+    std::optional<uint64_t> file(const fs::path& path) {
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return std::nullopt;
+
+        struct stat st;
+        std::optional<key> k;
+        if (fstat(fd, &st) != 0 || !(k = identify(st))) {
+            close(fd);
+            return std::nullopt;
+        }
+        if (auto h = cached().find(k.value())) {
+            close(fd);
+            return h;
+        }
+
+        uint64_t h;
+        if (st.st_size == 0) {
+            h = xxh64(nullptr, 0);
+        } else {
+            void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data == MAP_FAILED) {
+                close(fd);
+                return std::nullopt;
+            }
+            madvise(data, st.st_size, MADV_SEQUENTIAL);
+            h = xxh64(data, st.st_size);
+            munmap(data, st.st_size);
+        }
+        close(fd);
+
+        cached().add(k.value(), h);
+        return h;
+    }
+
+    void remember(const fs::path& path, uint64_t hash) {
+        struct stat st;
+        if (stat(path.c_str(), &st) != 0) return;
+        if (auto k = identify(st)) cached().add(k.value(), hash);
+    }
+
+    void warm(const std::vector<fs::path>& paths) {
+        if (paths.empty()) return;
+        unsigned jobs = std::max(1u, std::thread::hardware_concurrency());
+        jobs = std::min<unsigned>(jobs, paths.size());
+
+        std::atomic<std::size_t> next = 0;
+        std::vector<std::jthread> pool;
+        pool.reserve(jobs);
+        for (unsigned n = 0; n < jobs; n++) {
+            pool.emplace_back([&] {
+                for (std::size_t i; (i = next++) < paths.size();)
+                    file(paths[i]);
+            });
+        }
+    }
+
+}; // END digest
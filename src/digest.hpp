@@ -0,0 +1,25 @@
+// SPDX-FileCopyrightText: 2026 Will Reed <wreed@disroot.org>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <vector>
+
+// content hashes for deciding whether a copy is already up to date; results
+// are cached in $XDG_CACHE_HOME/confidant/hashes keyed on (device, inode,
+// size, mtime), so a file that hasn't changed is never read twice
+namespace digest {
+
+    std::uint64_t xxh64(const void* data, std::size_t len, std::uint64_t seed = 0);
+
+    std::optional<std::uint64_t> file(const std::filesystem::path& path);
+    // take `hash` as the contents of `path` as it is now, e.g. a fresh copy of a file already hashed
+    void remember(const std::filesystem::path& path, std::uint64_t hash);
+    // hash whatever isn't cached yet, spread over all processors
+    void warm(const std::vector<std::filesystem::path>& paths);
+
+}; // END digest
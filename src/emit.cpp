@@ -0,0 +1,130 @@
+// SPDX-FileCopyrightText: 2026 Will Reed <wreed@disroot.org>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <format>
+#include <string_view>
+
+#include <unistd.h>
+
+#include "emit.hpp"
+
+using sview = std::string_view;
+
+namespace emit {
+
+    writer::writer(int fd) : fd(fd) {}
+
+    writer::~writer() {
+        flush();
+    }
+
+    void writer::put(sview s) {
+        while (!s.empty()) {
+            if (used == capacity) flush();
+            std::size_t n = std::min(s.size(), capacity - used);
+            std::memcpy(buffer.data() + used, s.data(), n);
+            used += n;
+            s.remove_prefix(n);
+        }
+    }
+
+    void writer::flush() {
+        std::size_t done = 0;
+        while (done < used) {
+            ssize_t n = ::write(fd, buffer.data() + done, used - done);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                // nowhere left to report to (e.g. closed pipe), drop the rest
+                break;
+            }
+            done += std::size_t(n);
+        }
+        used = 0;
+    }
+
+    void json::indent() {
+        out.put('\n');
+        for (std::size_t n = 0; n < first.size(); n++)
+            out.put("    ");
+    }
+
+    void json::separate() {
+        if (afterkey) {
+            afterkey = false;
+            return;
+        }
+        if (first.empty()) return;
+        if (!first.back()) out.put(',');
+        first.back() = false;
+        indent();
+    }
+
+    void json::string(sview s) {
+        out.put('"');
+        for (char c : s) {
+            switch (c) {
+                case '"':  out.put("\\\""); break;
+                case '\\': out.put("\\\\"); break;
+                case '\n': out.put("\\n"); break;
+                case '\t': out.put("\\t"); break;
+                case '\r': out.put("\\r"); break;
+                case '\b': out.put("\\b"); break;
+                case '\f': out.put("\\f"); break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20)
+                        out.print("\\u{:04x}", static_cast<unsigned>(c));
+                    else
+                        out.put(c);
+            }
+        }
+        out.put('"');
+    }
+
+    void json::open(char bracket) {
+        separate();
+        out.put(bracket);
+        brackets.push_back(bracket == '{' ? '}' : ']');
+        first.push_back(true);
+    }
+
+    void json::close() {
+        bool empty = first.back();
+        char bracket = brackets.back();
+        first.pop_back();
+        brackets.pop_back();
+        if (!empty) indent();
+        out.put(bracket);
+    }
+
+    void json::key(sview k) {
+        separate();
+        string(k);
+        out.put(": ");
+        afterkey = true;
+    }
+
+    void json::value(sview s) {
+        separate();
+        string(s);
+    }
+
+    void json::value(bool b) {
+        separate();
+        out.put(b ? "true" : "false");
+    }
+
+    void json::value(long long n) {
+        separate();
+        out.print("{}", n);
+    }
+
+    void json::end() {
+        while (!first.empty()) close();
+        out.put('\n');
+        out.flush();
+    }
+
+}; // END emit
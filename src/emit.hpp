@@ -0,0 +1,98 @@
+// SPDX-FileCopyrightText: 2026 Will Reed <wreed@disroot.org>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <format>
+#include <iterator>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+using sview = std::string_view;
+
+namespace emit {
+
+    // buffered writer for a raw file descriptor; output is flushed whenever
+    // the buffer fills up, on flush(), and on destruction.
+    class writer {
+    public:
+        static constexpr std::size_t capacity = 1 << 16;
+
+        // output iterator for std::format_to, writes straight into the buffer
+        struct iterator {
+            using iterator_category = std::output_iterator_tag;
+            using value_type = void;
+            using difference_type = std::ptrdiff_t;
+            using pointer = void;
+            using reference = void;
+
+            writer* out;
+
+            iterator& operator=(char c) { out->put(c); return *this; }
+            iterator& operator*() { return *this; }
+            iterator& operator++() { return *this; }
+            iterator operator++(int) { return *this; }
+        };
+
+        explicit writer(int fd);
+        ~writer();
+
+        writer(const writer&) = delete;
+        writer& operator=(const writer&) = delete;
+
+        void put(char c) {
+            if (used == capacity) flush();
+            buffer[used++] = c;
+        }
+        void put(sview s);
+        void flush();
+
+        iterator out() { return iterator{this}; }
+
+        template <typename... Args>
+        void print(std::format_string<Args...> fmt, Args&&... args) {
+            std::format_to(out(), fmt, std::forward<Args>(args)...);
+        }
+
+        template <typename... Args>
+        void println(std::format_string<Args...> fmt, Args&&... args) {
+            std::format_to(out(), fmt, std::forward<Args>(args)...);
+            put('\n');
+        }
+
+    private:
+        int fd;
+        std::size_t used = 0;
+        std::array<char, capacity> buffer;
+    };
+
+    // incremental JSON emitter; keeps only one flag per nesting level, so
+    // memory use does not depend on the size of the document.
+    class json {
+    public:
+        explicit json(writer& out) : out(out) {}
+
+        void open(char bracket);
+        void close();
+        void key(sview k);
+        void value(sview s);
+        void value(const char* s) { value(sview(s)); }
+        void value(bool b);
+        void value(long long n);
+        void end();
+
+    private:
+        writer& out;
+        std::vector<bool> first;
+        std::vector<char> brackets;
+        bool afterkey = false;
+
+        void separate();
+        void indent();
+        void string(sview s);
+    };
+
+}; // END emit
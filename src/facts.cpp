@@ -0,0 +1,52 @@
+// SPDX-FileCopyrightText: 2026 Will Reed <wreed@disroot.org>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+#include <fnmatch.h>
+
+#include "facts.hpp"
+#include "util.hpp"
+
+namespace fs = std::filesystem;
+
+using sview = std::string_view;
+using std::string;
+
+namespace facts {
+
+    bool table::is(sview var, sview value) const {
+        auto v = vars.lookup(var);
+        return v && v.value() == value;
+    }
+
+    bool table::host(sview glob) const {
+        auto name = vars.lookup("hostname");
+        return name && fnmatch(string(glob).c_str(), name->c_str(), 0) == 0;
+    }
+
+    bool table::os(sview id) const { return is("os", id); }
+
+    bool table::arch(sview name) const { return is("arch", name); }
+
+    bool table::env(sview name) const {
+        if (auto found = envs.find(name); found != envs.end()) return found->second;
+        bool set = util::hasenv(string(name));
+        envs.emplace(string(name), set);
+        return set;
+    }
+
+    bool table::exists(sview path) const {
+        if (auto found = paths.find(path); found != paths.end()) return found->second;
+        fs::path p(path);
+        if (vars.sysroot() != "/" && p.is_absolute()) p = vars.sysroot() / p.relative_path();
+        std::error_code ec;
+        bool there = fs::exists(fs::symlink_status(p, ec));
+        paths.emplace(string(path), there);
+        return there;
+    }
+
+}; // END facts
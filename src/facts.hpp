@@ -0,0 +1,39 @@
+// SPDX-FileCopyrightText: 2026 Will Reed <wreed@disroot.org>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <functional>
+#include <map>
+#include <string>
+#include <string_view>
+
+#include "variables.hpp"
+
+// what the 'when' conditions of a configuration can ask about this machine;
+// each answer is worked out once per run, however many entries ask
+namespace facts {
+
+    class table {
+    public:
+        explicit table(const variables::resolver& vars) : vars(vars) {}
+
+        // `glob` as for fnmatch(3)
+        bool host(std::string_view glob) const;
+        bool os(std::string_view id) const;
+        bool arch(std::string_view name) const;
+        // set in the environment, even if empty
+        bool env(std::string_view name) const;
+        // anything at `path`, without following a final symlink; under the
+        // image's root for a sysroot
+        bool exists(std::string_view path) const;
+
+    private:
+        bool is(std::string_view var, std::string_view value) const;
+
+        const variables::resolver& vars;
+        mutable std::map<std::string, bool, std::less<>> envs;
+        mutable std::map<std::string, bool, std::less<>> paths;
+    };
+
+}; // END facts
@@ -3,29 +3,65 @@
 
 #pragma once
 
+#include <algorithm>
+#include <format>
+#include <ostream>
 #include <string>
 #include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "ansi.hpp"
 
 using std::string;
 using sview = std::string_view;
 
 namespace fmt {
     
-    string bolden(sview str);
-    string ital(sview str);
-    string ul(sview str);
-    string sthru(sview str);
+    // whether escape codes are written at all; decided once at startup
+    inline bool colored = false;
+    
+    // text between two escape codes, written straight into whatever it is
+    // formatted or streamed into; temporary strings are moved in, anything
+    // else is only viewed, so nothing is allocated either way
+    template <typename T>
+    struct styled {
+        sview open;
+        sview close;
+        T text;
+    };
+    
+    template <typename T>
+    using held = std::conditional_t<std::is_same_v<T, string>, string, sview>;
+    
+    template <typename T>
+    styled<held<T>> style(sview open, sview close, T&& text) {
+        return {open, close, held<T>(std::forward<T>(text))};
+    }
+    
+    template <typename T>
+    std::ostream& operator<<(std::ostream& os, const styled<T>& s) {
+        if (colored) os << s.open;
+        os << s.text;
+        if (colored) os << s.close;
+        return os;
+    }
+    
+    template <typename T> auto bolden(T&& s) { return style(ansi::bold, ansi::freset, std::forward<T>(s)); }
+    template <typename T> auto ital(T&& s)   { return style(ansi::italic, ansi::freset, std::forward<T>(s)); }
+    template <typename T> auto ul(T&& s)     { return style(ansi::underline, ansi::freset, std::forward<T>(s)); }
+    template <typename T> auto sthru(T&& s)  { return style(ansi::strikethru, ansi::freset, std::forward<T>(s)); }
 
     namespace fg {
         
-        string black(sview s);
-        string red(sview s);
-        string green(sview s);
-        string yellow(sview s);
-        string blue(sview s);
-        string magenta(sview s);
-        string cyan(sview s);
-        string white(sview s);
+        template <typename T> auto black(T&& s)   { return style(ansi::fg::black, ansi::fg::reset, std::forward<T>(s)); }
+        template <typename T> auto red(T&& s)     { return style(ansi::fg::red, ansi::fg::reset, std::forward<T>(s)); }
+        template <typename T> auto green(T&& s)   { return style(ansi::fg::green, ansi::fg::reset, std::forward<T>(s)); }
+        template <typename T> auto yellow(T&& s)  { return style(ansi::fg::yellow, ansi::fg::reset, std::forward<T>(s)); }
+        template <typename T> auto blue(T&& s)    { return style(ansi::fg::blue, ansi::fg::reset, std::forward<T>(s)); }
+        template <typename T> auto magenta(T&& s) { return style(ansi::fg::magenta, ansi::fg::reset, std::forward<T>(s)); }
+        template <typename T> auto cyan(T&& s)    { return style(ansi::fg::cyan, ansi::fg::reset, std::forward<T>(s)); }
+        template <typename T> auto white(T&& s)   { return style(ansi::fg::white, ansi::fg::reset, std::forward<T>(s)); }
         
         string rgb(int red, int green, int blue);
     
@@ -33,17 +69,31 @@ namespace fmt {
 
     namespace bg {
         
-        string black(sview s);
-        string red(sview s);
-        string green(sview s);
-        string yellow(sview s);
-        string blue(sview s);
-        string magenta(sview s);
-        string cyan(sview s);
-        string white(sview s);
+        template <typename T> auto black(T&& s)   { return style(ansi::bg::black, ansi::bg::reset, std::forward<T>(s)); }
+        template <typename T> auto red(T&& s)     { return style(ansi::bg::red, ansi::bg::reset, std::forward<T>(s)); }
+        template <typename T> auto green(T&& s)   { return style(ansi::bg::green, ansi::bg::reset, std::forward<T>(s)); }
+        template <typename T> auto yellow(T&& s)  { return style(ansi::bg::yellow, ansi::bg::reset, std::forward<T>(s)); }
+        template <typename T> auto blue(T&& s)    { return style(ansi::bg::blue, ansi::bg::reset, std::forward<T>(s)); }
+        template <typename T> auto magenta(T&& s) { return style(ansi::bg::magenta, ansi::bg::reset, std::forward<T>(s)); }
+        template <typename T> auto cyan(T&& s)    { return style(ansi::bg::cyan, ansi::bg::reset, std::forward<T>(s)); }
+        template <typename T> auto white(T&& s)   { return style(ansi::bg::white, ansi::bg::reset, std::forward<T>(s)); }
         
         string rgb(int red, int green, int blue);
     
     }; // END bg
     
 }; // END fmt
+
+// formats the text as its own type would, with the escape codes around it
+template <typename T>
+struct std::formatter<fmt::styled<T>, char> : std::formatter<T, char> {
+    template <typename Context>
+    auto format(const fmt::styled<T>& s, Context& ctx) const {
+        auto out = ctx.out();
+        if (fmt::colored) out = std::ranges::copy(s.open, out).out;
+        ctx.advance_to(out);
+        out = std::formatter<T, char>::format(s.text, ctx);
+        if (fmt::colored) out = std::ranges::copy(s.close, out).out;
+        return out;
+    }
+};
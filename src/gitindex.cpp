@@ -0,0 +1,249 @@
+// SPDX-FileCopyrightText: 2026 Will Reed <wreed@disroot.org>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include <unistd.h>
+
+#include "gitindex.hpp"
+#include "util.hpp"
+#include "xdg.hpp"
+
+namespace fs = std::filesystem;
+
+using sview = std::string_view;
+using std::string;
+using std::vector;
+using std::optional;
+using std::nullopt;
+
+namespace gitindex {
+
+    constexpr sview header = "confidant-index 1";
+
+    static optional<string> slurp(const fs::path& file) {
+        std::ifstream in(file, std::ios::binary);
+        if (!in.is_open()) return nullopt;
+        return string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    optional<fs::path> worktree(const fs::path& path) {
+        std::error_code ec;
+        fs::path dir = fs::absolute(path, ec).lexically_normal();
+        if (ec) return nullopt;
+        if (!dir.has_filename() && dir != dir.root_path()) dir = dir.parent_path();
+        for (;;) {
+            if (fs::exists(fs::symlink_status(dir / ".git", ec))) return dir;
+            if (dir == dir.parent_path()) return nullopt;
+            dir = dir.parent_path();
+        }
+    }
+
+    // .git is either the repository itself, or (for worktrees and submodules)
+    // a file pointing to it
+    static optional<fs::path> gitdir(const fs::path& worktree) {
+        fs::path dotgit = worktree / ".git";
+        std::error_code ec;
+        if (fs::is_directory(dotgit, ec)) return dotgit;
+        auto text = slurp(dotgit);
+        if (!text || !text->starts_with("gitdir: ")) return nullopt;
+        sview rest = sview(*text).substr(8);
+        while (!rest.empty() && (rest.back() == '\n' || rest.back() == '\r')) rest.remove_suffix(1);
+        fs::path dir(rest);
+        return dir.is_absolute() ? dir : (worktree / dir).lexically_normal();
+    }
+
+    static std::uint32_t be32(const unsigned char* p) {
+        return std::uint32_t(p[0]) << 24 | std::uint32_t(p[1]) << 16 | std::uint32_t(p[2]) << 8 | p[3];
+    }
+
+    // the entries of an index whose object ids are `width` bytes; nullopt unless
+    // it parses all the way to a checksum of that width
+    static optional<std::unordered_map<string, string>> parse(sview raw, size_t width) {
+        const auto* data = reinterpret_cast<const unsigned char*>(raw.data());
+        size_t size = raw.size();
+        if (size < 12 + width || std::memcmp(data, "DIRC", 4) != 0) return nullopt;
+        std::uint32_t version = be32(data + 4);
+        std::uint32_t count = be32(data + 8);
+        if (version < 2 || version > 4) return nullopt;
+
+        size_t end = size - width;
+        size_t pos = 12;
+        // stat data, then mode, uid, gid and size
+        constexpr size_t statsize = 40;
+        std::unordered_map<string, string> out;
+        out.reserve(count);
+        string path;
+        for (std::uint32_t n = 0; n < count; n++) {
+            size_t start = pos;
+            if (pos + statsize + width + 2 > end) return nullopt;
+            std::uint32_t mode = be32(data + pos + 24);
+            sview oid(raw.data() + pos + statsize, width);
+            pos += statsize + width;
+            std::uint16_t flags = std::uint16_t(data[pos] << 8 | data[pos + 1]);
+            pos += 2;
+            if (flags & 0x4000) {
+                if (version < 3 || pos + 2 > end) return nullopt;
+                pos += 2;
+            }
+
+            if (version == 4) {
+                // the path is what's left of the previous one, and a new suffix
+                if (pos >= end) return nullopt;
+                unsigned char c = data[pos++];
+                size_t strip = c & 0x7f;
+                while (c & 0x80) {
+                    if (pos >= end) return nullopt;
+                    c = data[pos++];
+                    strip = ((strip + 1) << 7) | (c & 0x7f);
+                }
+                if (strip > path.size()) return nullopt;
+                path.resize(path.size() - strip);
+            } else {
+                path.clear();
+            }
+            const void* nul = std::memchr(data + pos, 0, end - pos);
+            if (!nul) return nullopt;
+            size_t len = static_cast<const unsigned char*>(nul) - (data + pos);
+            path.append(raw.data() + pos, len);
+            pos += len + 1;
+            // before version 4, entries are padded with NULs to a multiple of 8
+            if (version < 4) pos = start + ((pos - start + 7) & ~size_t(7));
+            if (pos > end) return nullopt;
+
+            // anything in a merge conflict only matches itself once resolved
+            unsigned stage = (flags >> 12) & 3;
+            if (stage != 0) {
+                out[path].clear();
+                continue;
+            }
+            string value(oid);
+            value += std::format("{:o}", mode);
+            out.insert_or_assign(path, std::move(value));
+        }
+
+        // extensions (cached trees and such) are skipped, but have to line up
+        while (pos < end) {
+            if (pos + 8 > end) return nullopt;
+            size_t len = be32(data + pos + 4);
+            if (len > end - pos - 8) return nullopt;
+            pos += 8 + len;
+        }
+        return out;
+    }
+
+    // SHA-1 and SHA-256 repositories only differ in the width of object ids,
+    // which the index doesn't record; only the right one parses through
+    static optional<snapshot> load(string raw) {
+        for (size_t width : {20, 32}) {
+            if (auto entries = parse(raw, width))
+                return snapshot{std::move(entries.value()), std::move(raw)};
+        }
+        return nullopt;
+    }
+
+    optional<snapshot> read(const fs::path& worktree) {
+        auto dir = gitdir(worktree);
+        if (!dir) return nullopt;
+        auto raw = slurp(dir.value() / "index");
+        if (!raw) return nullopt;
+        return load(std::move(raw.value()));
+    }
+
+    static fs::path location(sview config) {
+        fs::path state = xdg::homes().at("XDG_STATE_HOME");
+        return state / "confidant" / std::format("{}.index", util::configkey(config));
+    }
+
+    optional<std::pair<std::uint64_t, snapshot>> recorded(sview config) {
+        auto text = slurp(location(config));
+        if (!text) return nullopt;
+
+        // the header line, then the index exactly as it was read
+        sview s = text.value();
+        size_t eol = s.find('\n');
+        if (eol == sview::npos) return nullopt;
+        sview first = s.substr(0, eol);
+        if (!first.starts_with(header) || first.size() != header.size() + 17 || first[header.size()] != ' ')
+            return nullopt;
+        std::uint64_t id;
+        const char* p = first.data() + header.size() + 1;
+        auto res = std::from_chars(p, first.data() + first.size(), id, 16);
+        if (res.ec != std::errc() || res.ptr != first.data() + first.size()) return nullopt;
+
+        auto snap = load(string(s.substr(eol + 1)));
+        if (!snap) return nullopt;
+        return std::pair{id, std::move(snap.value())};
+    }
+
+    void record(sview config, std::uint64_t id, const snapshot& s) {
+        fs::path path = location(config);
+        std::error_code ec;
+        fs::create_directories(path.parent_path(), ec);
+        fs::path tmp = path;
+        tmp += std::format(".{}", getpid());
+        {
+            std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+            out << std::format("{} {:016x}\n", header, id);
+            out.write(s.raw.data(), s.raw.size());
+            if (!out) {
+                fs::remove(tmp, ec);
+                return;
+            }
+        }
+        fs::rename(tmp, path, ec);
+    }
+
+    diff::diff(const fs::path& worktree, const snapshot& then, const snapshot& now) : root(worktree) {
+        tracked.reserve(now.entries.size());
+        for (const auto& [path, value] : now.entries) {
+            tracked.push_back(path);
+            auto was = then.entries.find(path);
+            if (was == then.entries.end() || was->second != value || value.empty()) changed.push_back(path);
+        }
+        // removed paths are gone from now, but what was there changed all the same
+        for (const auto& [path, value] : then.entries) {
+            if (!now.entries.contains(path)) {
+                changed.push_back(path);
+                tracked.push_back(path);
+            }
+        }
+        std::sort(changed.begin(), changed.end());
+        std::sort(tracked.begin(), tracked.end());
+    }
+
+    // whether `paths` holds `rel` itself or anything under it
+    static bool covers(const vector<string>& paths, sview rel) {
+        auto it = std::lower_bound(paths.begin(), paths.end(), rel);
+        if (it == paths.end()) return false;
+        if (*it == rel) return true;
+        // siblings like 'a-b' and 'a.b' sort between 'a' and 'a/', look again from there
+        string under = string(rel) + '/';
+        it = std::lower_bound(it, paths.end(), under);
+        return it != paths.end() && sview(*it).starts_with(under);
+    }
+
+    bool diff::unchanged(const fs::path& path) const {
+        fs::path rel = path.lexically_normal().lexically_relative(root);
+        if (rel.empty()) return false;
+        if (rel == ".") return changed.empty() && !tracked.empty();
+        if (*rel.begin() == "..") return false;
+        sview r = rel.native();
+        if (r.ends_with('/')) r.remove_suffix(1);
+        return covers(tracked, r) && !covers(changed, r);
+    }
+
+}; // END gitindex
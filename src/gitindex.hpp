@@ -0,0 +1,54 @@
+// SPDX-FileCopyrightText: 2026 Will Reed <wreed@disroot.org>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// what git has staged in the repository, read from its index file directly;
+// the index a 'link' went through with is kept in $XDG_STATE_HOME/confidant/
+// <config key>.index, so the next one can tell which sources changed since
+namespace gitindex {
+
+    struct snapshot {
+        // path relative to the work tree -> object id and mode; empty for a
+        // path with merge conflicts
+        std::unordered_map<std::string, std::string> entries;
+        // the index file as it was read
+        std::string raw;
+    };
+
+    // the top of the git work tree `path` is in, if it's in one
+    std::optional<std::filesystem::path> worktree(const std::filesystem::path& path);
+    // the staged state of a work tree; nullopt when there's no index or it isn't
+    // one this understands (versions 2 to 4, SHA-1 or SHA-256)
+    std::optional<snapshot> read(const std::filesystem::path& worktree);
+
+    // the index recorded for `config` and the id of the plan it was applied with
+    std::optional<std::pair<std::uint64_t, snapshot>> recorded(std::string_view config);
+    void record(std::string_view config, std::uint64_t id, const snapshot& s);
+
+    // the paths staged differently between two snapshots of the same work tree
+    class diff {
+    public:
+        diff(const std::filesystem::path& worktree, const snapshot& then, const snapshot& now);
+
+        // whether nothing at or under `path` changed, as far as the index can
+        // tell; paths git doesn't track, or outside the work tree, never count
+        bool unchanged(const std::filesystem::path& path) const;
+        std::size_t size() const { return changed.size(); }
+
+    private:
+        std::filesystem::path root;
+        // both sorted, so everything under a directory is one range
+        std::vector<std::string> changed;
+        std::vector<std::string> tracked;
+    };
+
+}; // END gitindex
@@ -0,0 +1,59 @@
+// SPDX-FileCopyrightText: 2026 Will Reed <wreed@disroot.org>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "graph.hpp"
+
+using std::size_t;
+using std::vector;
+
+namespace graph {
+
+    sorted sort(const edges& before) {
+        size_t n = before.size();
+        vector<size_t> waiting(n, 0);
+        vector<vector<size_t>> after(n);
+        for (size_t i = 0; i < n; i++) {
+            for (size_t b : before[i]) {
+                after[b].push_back(i);
+                waiting[i]++;
+            }
+        }
+
+        // Kahn's algorithm; ties keep their original order
+        sorted out;
+        out.order.reserve(n);
+        for (size_t i = 0; i < n; i++)
+            if (waiting[i] == 0) out.order.push_back(i);
+        for (size_t head = 0; head < out.order.size(); head++) {
+            for (size_t a : after[out.order[head]])
+                if (--waiting[a] == 0) out.order.push_back(a);
+        }
+        if (out.order.size() == n) return out;
+
+        // whatever is left still waits on something that is also left, so
+        // walking backwards through those has to come round on itself
+        size_t at = 0;
+        while (waiting[at] == 0) at++;
+        vector<size_t> seen(n, n);
+        vector<size_t> walk;
+        while (seen[at] == n) {
+            seen[at] = walk.size();
+            walk.push_back(at);
+            for (size_t b : before[at]) {
+                if (waiting[b] != 0) {
+                    at = b;
+                    break;
+                }
+            }
+        }
+        out.cycle.assign(walk.begin() + seen[at], walk.end());
+        std::reverse(out.cycle.begin(), out.cycle.end());
+        out.order.clear();
+        return out;
+    }
+
+}; // END graph
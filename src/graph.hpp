@@ -0,0 +1,24 @@
+// SPDX-FileCopyrightText: 2026 Will Reed <wreed@disroot.org>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// ordering for things that declare what has to happen before them; nodes
+// are numbered 0..n-1 and before[i] lists the nodes that have to precede i
+namespace graph {
+
+    using edges = std::vector<std::vector<std::size_t>>;
+
+    struct sorted {
+        // every node, dependencies first; empty when there is a cycle
+        std::vector<std::size_t> order;
+        // one offending loop, each node preceding the next and the last the first
+        std::vector<std::size_t> cycle;
+    };
+
+    sorted sort(const edges& before);
+
+}; // END graph
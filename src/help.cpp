@@ -30,6 +30,16 @@ namespace help {
             << "    " << fmt::ul("init") << "                " << _("initialize a repository") << "\n"
             << "    " << fmt::ul("config") << "              " << _("view configuration") << "\n"
             << "    " << fmt::ul("link") << "                " << _("create symlinks") << "\n"
+            << "    " << fmt::ul("watch") << "               " << _("keep symlinks applied as files change") << "\n"
+            << "    " << fmt::ul("status") << "              " << _("show the state of configured links") << "\n"
+            << "    " << fmt::ul("which") << "               " << _("find the link managing a path") << "\n"
+            << "    " << fmt::ul("rollback") << "            " << _("undo the last link") << "\n"
+            << "    " << fmt::ul("check") << "               " << _("find problems that would stop links from applying") << "\n"
+            << "    " << fmt::ul("apply") << "               " << _("create symlinks from a saved plan") << "\n"
+            << "    " << fmt::ul("archive") << "             " << _("write symlinks as a tar or cpio archive") << "\n"
+            << "    " << fmt::ul("clone") << "               " << _("fetch a repository and link it") << "\n"
+            << "    " << fmt::ul("sync") << "                " << _("update the repository and link what changed") << "\n"
+            << "    " << fmt::ul("serve") << "               " << _("answer queries from a long-lived process") << "\n"
             << "    " << fmt::ul("help") << "                " << _("display help for subcommands") << "\n"
             << "    " << fmt::ul("usage") << "               " << _("brief command-line usage info") << "\n"
             << "    " << fmt::ul("version") << "             " << _("display version info") << "\n\n"
@@ -46,6 +56,16 @@ namespace help {
             << fmt::ul("init")    << ", "
             << fmt::ul("config")  << ", "
             << fmt::ul("link")    << ", "
+            << fmt::ul("watch")   << ", "
+            << fmt::ul("status")  << ", "
+            << fmt::ul("which")   << ", "
+            << fmt::ul("rollback") << ", "
+            << fmt::ul("check")   << ", "
+            << fmt::ul("apply")   << ", "
+            << fmt::ul("archive") << ", "
+            << fmt::ul("clone")   << ", "
+            << fmt::ul("sync")    << ", "
+            << fmt::ul("serve")   << ", "
             << fmt::ul("help")    << ", "
             << fmt::ul("usage")   << ", "
             << fmt::ul("version") << "\n\n"
@@ -97,6 +117,8 @@ namespace help {
                 << "                        " << _("default: <current directory>/confidant.ucl") << "\n\n"
                 << "    -g, --global        " << _("display the global configuration") << "\n\n"
                 << "    -j, --json          " << _("output configuration in JSON format") << "\n\n"
+                << "    -t, --tags " << fmt::ul("X,Y,Z") << _("    ") << _("only display entries carrying one of the given tags") << "\n\n"
+                << "    -n, --name " << fmt::ul(_("GLOB")) << _("     ") << _("only display entries whose name matches a pattern") << "\n\n"
                 << "    -v, --verbose       " << _("output more information about actions taken") << "\n\n"
                 << "    -q, --quiet         " << _("suppress non-error messages") << "\n\n"
                 << "    -?, -h, --help      " << _("display this help") << "\n"
@@ -133,6 +155,25 @@ namespace help {
             << "    -f, --file " << fmt::ul(_("PATH")) << _("     ") << _("specify the configuration file to operate on") << "\n"
             << "                        " << _("default: <current directory>/confidant.ucl") << "\n\n"
             << "    -d, --dry-run       " << _("show what actions") << " " << fmt::ital(_("would")) << " " << _("be taken") << "\n\n"
+            << "    -r, --roots " << fmt::ul(_("PATH")) << _("    ") << _("apply to every home listed in a file, one") << "\n"
+            << "                        " << _("'HOME UID GID [USER]' per line ('-' for stdin)") << "\n\n"
+            << "    -j, --jobs " << fmt::ul("N") << _("         ") << _("number of entries, or homes with --roots, to apply") << "\n"
+            << "                        " << _("concurrently, and of hooks to run at once") << "\n"
+            << "                        " << _("default: number of processors, no limit for hooks") << "\n\n"
+            << "    --sysroot " << fmt::ul(_("PATH")) << _("      ") << _("link into the image rooted at PATH, as if it were '/'") << "\n\n"
+            << "    --sysroot-user " << fmt::ul(_("USER")) << _(" ") << _("user in the image's /etc/passwd to link for") << "\n"
+            << "                        " << _("default: $USER") << "\n\n"
+            << "    --sysroot-sources   " << _("the repository is inside the image too, link to it there") << "\n\n"
+            << "    --backup            " << _("move conflicting destinations aside, then link in their place") << "\n\n"
+            << "    --force             " << _("replace conflicting destinations") << "\n\n"
+            << "    --no-hooks          " << _("don't run the on-change hooks of entries that changed") << "\n\n"
+            << "    --strict            " << _("don't apply anything when checking the plan turns up warnings,") << "\n"
+            << "                        " << _("not only when it turns up errors") << "\n\n"
+            << "    --no-check          " << _("apply without checking the whole plan first") << "\n\n"
+            << "    --changed           " << _("only look at entries whose sources git has staged") << "\n"
+            << "                        " << _("differently since the last run") << "\n\n"
+            << "    --plan-out " << fmt::ul(_("PATH")) << _("     ") << _("save the resolved plan to PATH for 'apply', instead") << "\n"
+            << "                        " << _("of applying it") << "\n\n"
             << "    -v, --verbose       " << _("output more information about actions taken") << "\n\n"
             << "    -q, --quiet         " << _("suppress non-error messages") << "\n\n"
             << "    -?, -h, --help      " << _("display this help") << "\n"
@@ -141,6 +182,230 @@ namespace help {
         
     }; // END link
 
+    namespace watch {
+
+        void help(std::string_view argz) {
+            std::cout
+            << fg::green(argz) << " " << fmt::ul("watch") << ":\n\n"
+            << "    " << _("apply symlinks, then keep them applied as the configuration,") << "\n"
+            << "    " << _("repository and destination directories change") << "\n\n"
+            << fg::yellow(_("options")) << ":\n\n"
+            << "    -t, --tags " << fmt::ul("X,Y,Z") << _("    ")  << _("specify a set of tagged links to apply, separated by commas") << "\n\n"
+            << "    -f, --file " << fmt::ul(_("PATH")) << _("     ") << _("specify the configuration file to operate on") << "\n"
+            << "                        " << _("default: <current directory>/confidant.ucl") << "\n\n"
+            << "    -v, --verbose       " << _("output more information about actions taken") << "\n\n"
+            << "    -q, --quiet         " << _("suppress non-error messages") << "\n\n"
+            << "    -?, -h, --help      " << _("display this help") << "\n"
+            << std::endl;
+        }
+
+    }; // END watch
+
+    namespace serve {
+
+        void help(std::string_view argz) {
+            std::cout
+            << fg::green(argz) << " " << fmt::ul("serve") << ":\n\n"
+            << "    " << _("keep the configuration loaded and answer 'config get', 'status'") << "\n"
+            << "    " << _("and 'which' over a socket in $XDG_RUNTIME_DIR/confidant; those") << "\n"
+            << "    " << _("commands use the server automatically while it is running") << "\n\n"
+            << fg::yellow(_("options")) << ":\n\n"
+            << "    -t, --tags " << fmt::ul("X,Y,Z") << _("    ")  << _("specify a set of tagged links to include, separated by commas") << "\n\n"
+            << "    -f, --file " << fmt::ul(_("PATH")) << _("     ") << _("specify the configuration file to operate on") << "\n"
+            << "                        " << _("default: <current directory>/confidant.ucl") << "\n\n"
+            << "    -v, --verbose       " << _("output more information about actions taken") << "\n\n"
+            << "    -q, --quiet         " << _("suppress non-error messages") << "\n\n"
+            << "    -?, -h, --help      " << _("display this help") << "\n"
+            << std::endl;
+        }
+
+    }; // END serve
+
+    namespace status {
+
+        void help(std::string_view argz) {
+            std::cout
+            << fg::green(argz) << " " << fmt::ul("status") << ":\n\n"
+            << "    " << _("show whether configured links are in place; exits with 1") << "\n"
+            << "    " << _("unless every selected link is") << "\n\n"
+            << fg::blue(_("arguments")) << ":\n\n"
+            << "    " << fmt::ul(_("NAME")) << _("                ") << _("a link or template name, or a destination path") << "\n"
+            << "                        " << _("default: every link") << "\n\n"
+            << fg::yellow(_("options")) << ":\n\n"
+            << "    -t, --tags " << fmt::ul("X,Y,Z") << _("    ")  << _("specify a set of tagged links to include, separated by commas") << "\n\n"
+            << "    -f, --file " << fmt::ul(_("PATH")) << _("     ") << _("specify the configuration file to operate on") << "\n"
+            << "                        " << _("default: <current directory>/confidant.ucl") << "\n\n"
+            << "    -v, --verbose       " << _("output more information about actions taken") << "\n\n"
+            << "    -q, --quiet         " << _("suppress non-error messages") << "\n\n"
+            << "    -?, -h, --help      " << _("display this help") << "\n"
+            << std::endl;
+        }
+
+    }; // END status
+
+    namespace which {
+
+        void help(std::string_view argz) {
+            std::cout
+            << fg::green(argz) << " " << fmt::ul("which") << ":\n\n"
+            << "    " << _("find the link whose source or destination is the given path") << "\n\n"
+            << fg::blue(_("arguments")) << ":\n\n"
+            << "    " << fmt::ul(_("PATH")) << _("                ") << _("the path to look up") << "\n\n"
+            << fg::yellow(_("options")) << ":\n\n"
+            << "    -t, --tags " << fmt::ul("X,Y,Z") << _("    ")  << _("specify a set of tagged links to include, separated by commas") << "\n\n"
+            << "    -f, --file " << fmt::ul(_("PATH")) << _("     ") << _("specify the configuration file to operate on") << "\n"
+            << "                        " << _("default: <current directory>/confidant.ucl") << "\n\n"
+            << "    -v, --verbose       " << _("output more information about actions taken") << "\n\n"
+            << "    -q, --quiet         " << _("suppress non-error messages") << "\n\n"
+            << "    -?, -h, --help      " << _("display this help") << "\n"
+            << std::endl;
+        }
+
+    }; // END which
+
+    namespace rollback {
+
+        void help(std::string_view argz) {
+            std::cout
+            << fg::green(argz) << " " << fmt::ul("rollback") << ":\n\n"
+            << "    " << _("undo the changes made by the last 'link'") << "\n\n"
+            << fg::yellow(_("options")) << ":\n\n"
+            << "    -f, --file " << fmt::ul(_("PATH")) << _("     ") << _("specify the configuration file to operate on") << "\n"
+            << "                        " << _("default: <current directory>/confidant.ucl") << "\n\n"
+            << "    -d, --dry-run       " << _("show what actions") << " " << fmt::ital(_("would")) << " " << _("be taken") << "\n\n"
+            << "    -v, --verbose       " << _("output more information about actions taken") << "\n\n"
+            << "    -q, --quiet         " << _("suppress non-error messages") << "\n\n"
+            << "    -?, -h, --help      " << _("display this help") << "\n"
+            << std::endl;
+        }
+
+    }; // END rollback
+
+    namespace check {
+
+        void help(std::string_view argz) {
+            std::cout
+            << fg::green(argz) << " " << fmt::ul("check") << ":\n\n"
+            << "    " << _("report every problem that would keep links from applying,") << "\n"
+            << "    " << _("without changing anything") << "\n\n"
+            << fg::yellow(_("options")) << ":\n\n"
+            << "    -t, --tags " << fmt::ul("X,Y,Z") << _("    ")  << _("specify a set of tagged links to check, separated by commas") << "\n\n"
+            << "    -f, --file " << fmt::ul(_("PATH")) << _("     ") << _("specify the configuration file to operate on") << "\n"
+            << "                        " << _("default: <current directory>/confidant.ucl") << "\n\n"
+            << "    -j, --jobs " << fmt::ul("N") << _("         ") << _("number of entries to check concurrently") << "\n"
+            << "                        " << _("default: number of processors") << "\n\n"
+            << "    --strict            " << _("fail on warnings too, not only on errors") << "\n\n"
+            << "    -v, --verbose       " << _("output more information about actions taken") << "\n\n"
+            << "    -q, --quiet         " << _("suppress non-error messages") << "\n\n"
+            << "    -?, -h, --help      " << _("display this help") << "\n"
+            << std::endl;
+        }
+
+    }; // END check
+
+    namespace apply {
+
+        void help(std::string_view argz) {
+            std::cout
+            << fg::green(argz) << " " << fmt::ul("apply") << ":\n\n"
+            << "    " << _("create the symlinks of a plan saved with 'link --plan-out',") << "\n"
+            << "    " << _("without reading any configuration") << "\n\n"
+            << fg::blue(_("arguments")) << ":\n\n"
+            << "    " << fmt::ul(_("PATH")) << _("                ") << _("the plan to apply") << "\n\n"
+            << fg::yellow(_("options")) << ":\n\n"
+            << "    -d, --dry-run       " << _("show what actions") << " " << fmt::ital(_("would")) << " " << _("be taken") << "\n\n"
+            << "    -j, --jobs " << fmt::ul("N") << _("         ") << _("number of entries to apply concurrently, and of hooks") << "\n"
+            << "                        " << _("to run at once") << "\n"
+            << "                        " << _("default: number of processors, no limit for hooks") << "\n\n"
+            << "    --backup            " << _("move conflicting destinations aside, then link in their place") << "\n\n"
+            << "    --force             " << _("replace conflicting destinations") << "\n\n"
+            << "    --no-hooks          " << _("don't run the on-change hooks of entries that changed") << "\n\n"
+            << "    --strict            " << _("don't apply anything when checking the plan turns up warnings,") << "\n"
+            << "                        " << _("not only when it turns up errors") << "\n\n"
+            << "    --no-check          " << _("apply without checking the whole plan first") << "\n\n"
+            << "    -v, --verbose       " << _("output more information about actions taken") << "\n\n"
+            << "    -q, --quiet         " << _("suppress non-error messages") << "\n\n"
+            << "    -?, -h, --help      " << _("display this help") << "\n"
+            << std::endl;
+        }
+
+    }; // END apply
+
+    namespace archive {
+
+        void help(std::string_view argz) {
+            std::cout
+            << fg::green(argz) << " " << fmt::ul("archive") << ":\n\n"
+            << "    " << _("write the symlinks from your configuration, and the directories") << "\n"
+            << "    " << _("leading to them, as an archive on standard output") << "\n\n"
+            << fg::yellow(_("options")) << ":\n\n"
+            << "    -t, --tags " << fmt::ul("X,Y,Z") << _("    ")  << _("specify a set of tagged links to include, separated by commas") << "\n\n"
+            << "    -f, --file " << fmt::ul(_("PATH")) << _("     ") << _("specify the configuration file to operate on") << "\n"
+            << "                        " << _("default: <current directory>/confidant.ucl") << "\n\n"
+            << "    --format " << fmt::ul(_("FORMAT")) << _("     ") << _("tar or cpio (newc)") << "\n"
+            << "                        " << _("default: tar") << "\n\n"
+            << "    --owner " << fmt::ul("UID:GID") << _("     ") << _("owner of every entry") << "\n"
+            << "                        " << _("default: 0:0") << "\n\n"
+            << "    --dir-mode " << fmt::ul(_("MODE")) << _("     ") << _("octal permissions of the directories") << "\n"
+            << "                        " << _("default: 755") << "\n\n"
+            << "    -v, --verbose       " << _("output more information about actions taken") << "\n\n"
+            << "    -q, --quiet         " << _("suppress non-error messages") << "\n\n"
+            << "    -?, -h, --help      " << _("display this help") << "\n"
+            << std::endl;
+        }
+
+    }; // END archive
+
+    namespace clone {
+
+        void help(std::string_view argz) {
+            std::cout
+            << fg::green(argz) << " " << fmt::ul("clone") << ":\n\n"
+            << "    " << _("fetch a repository, shallow and through a shared object cache,") << "\n"
+            << "    " << _("then link the confidant.ucl at the top of it") << "\n\n"
+            << fg::blue(_("arguments")) << ":\n\n"
+            << "    " << fmt::ul("URL") << "                 " << _("the repository to clone, any URL git understands") << "\n\n"
+            << "    " << fmt::ul(_("PATH")) << _("                ") << _("where to clone it") << "\n"
+            << "                        " << _("default: the last part of URL, in the current directory") << "\n\n"
+            << fg::yellow(_("options")) << ":\n\n"
+            << "    -t, --tags " << fmt::ul("X,Y,Z") << _("    ")  << _("specify a set of tagged links to apply, separated by commas") << "\n\n"
+            << "    -j, --jobs " << fmt::ul("N") << _("         ") << _("number of entries to apply concurrently") << "\n"
+            << "                        " << _("default: number of processors") << "\n\n"
+            << "    --depth " << fmt::ul("N") << _("            ") << _("number of commits of history to fetch, 0 for all of it") << "\n"
+            << "                        " << _("default: 1") << "\n\n"
+            << "    --sparse            " << _("only fetch and check out the configuration and the") << "\n"
+            << "                        " << _("sources it names") << "\n\n"
+            << "    --no-link           " << _("clone without linking") << "\n\n"
+            << "    -v, --verbose       " << _("output more information about actions taken") << "\n\n"
+            << "    -q, --quiet         " << _("suppress non-error messages") << "\n\n"
+            << "    -?, -h, --help      " << _("display this help") << "\n"
+            << std::endl;
+        }
+
+    }; // END clone
+
+    namespace sync {
+
+        void help(std::string_view argz) {
+            std::cout
+            << fg::green(argz) << " " << fmt::ul("sync") << ":\n\n"
+            << "    " << _("fast-forward the repository from repository.url, or its upstream,") << "\n"
+            << "    " << _("then link the entries whose sources changed") << "\n\n"
+            << fg::yellow(_("options")) << ":\n\n"
+            << "    -t, --tags " << fmt::ul("X,Y,Z") << _("    ")  << _("specify a set of tagged links to apply, separated by commas") << "\n\n"
+            << "    -f, --file " << fmt::ul(_("PATH")) << _("     ") << _("specify the configuration file to operate on") << "\n"
+            << "                        " << _("default: <current directory>/confidant.ucl") << "\n\n"
+            << "    -j, --jobs " << fmt::ul("N") << _("         ") << _("number of entries to apply concurrently") << "\n"
+            << "                        " << _("default: number of processors") << "\n\n"
+            << "    --no-link           " << _("update without linking") << "\n\n"
+            << "    -v, --verbose       " << _("output more information about actions taken") << "\n\n"
+            << "    -q, --quiet         " << _("suppress non-error messages") << "\n\n"
+            << "    -?, -h, --help      " << _("display this help") << "\n"
+            << std::endl;
+        }
+
+    }; // END sync
+
     namespace defaults {
         std::string global_config_path() {
             return std::format("{}/{}/config.ucl",
@@ -173,8 +438,11 @@ links {
     fontconfig {
         source: ${repo}/.config/fontconfig
         destdir: ${xdg_config_home}
-        # by default, type is 'file'
+        # by default, type is 'file'; 'copy' and 'hardlink' place
+        # real files for programs that won't follow a symlink
         type: directory
+        # hooks to run when this link changes, see 'hooks' below
+        # on-change: fc-cache
     }
     
     bashrc {
@@ -205,6 +473,25 @@ templates {
     # ${repo}/.config/fish/conf.d      -> ${XDG_CONFIG_HOME}/fish/conf.d
     # ${repo}/.config/fish/config.fish -> ${XDG_CONFIG_HOME}/fish/config.fish
 }
+
+# 'packages' mirror a whole directory, like GNU Stow; directories
+# that don't exist at the destination yet become a single link,
+# otherwise their contents are linked one by one
+# packages {
+#     local {
+#         source: ${repo}/local
+#         dest: ${home}/.local
+#     }
+# }
+
+# 'hooks' are commands run once after 'link' changed any entry naming
+# them in 'on-change'; they run concurrently unless told to wait for
+# other hooks with 'after'
+# hooks {
+#     fc-cache {
+#         run: "fc-cache -f"
+#     }
+# }
 */)";
             return s;
         }
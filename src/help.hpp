@@ -33,6 +33,46 @@ namespace help {
         void help(sview argz);
     }; // END link
 
+    namespace watch {
+        void help(sview argz);
+    }; // END watch
+
+    namespace serve {
+        void help(sview argz);
+    }; // END serve
+
+    namespace status {
+        void help(sview argz);
+    }; // END status
+
+    namespace which {
+        void help(sview argz);
+    }; // END which
+
+    namespace rollback {
+        void help(sview argz);
+    }; // END rollback
+
+    namespace check {
+        void help(sview argz);
+    }; // END check
+
+    namespace apply {
+        void help(sview argz);
+    }; // END apply
+
+    namespace archive {
+        void help(sview argz);
+    }; // END archive
+
+    namespace clone {
+        void help(sview argz);
+    }; // END clone
+
+    namespace sync {
+        void help(sview argz);
+    }; // END sync
+
     namespace defaults {
         string global_config_path();
         string global_config();
@@ -0,0 +1,284 @@
+// SPDX-FileCopyrightText: 2026 Will Reed <wreed@disroot.org>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <cerrno>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "journal.hpp"
+#include "deploy.hpp"
+#include "util.hpp"
+#include "xdg.hpp"
+#include "fmt.hpp"
+#include "msg.hpp"
+
+namespace fs = std::filesystem;
+
+using sview = std::string_view;
+using std::string;
+using std::vector;
+
+namespace journal {
+
+    constexpr sview header = "confidant-journal 1";
+    // records are written as they come, but only synced to disk in batches
+    constexpr std::size_t batch = 256;
+
+    static sview literal(op o) {
+        switch (o) {
+            case op::link:    return "link";
+            case op::place:   return "place";
+            case op::mkdir:   return "mkdir";
+            case op::backup:  return "backup";
+            case op::replace: return "replace";
+        }
+        std::unreachable();
+    }
+
+    // fields are tab separated; escape what would break a line apart
+    static string escape(sview s) {
+        string out;
+        out.reserve(s.size());
+        for (char c : s) {
+            switch (c) {
+                case '\\': out += "\\\\"; break;
+                case '\t': out += "\\t";  break;
+                case '\n': out += "\\n";  break;
+                default:   out += c;
+            }
+        }
+        return out;
+    }
+
+    static string unescape(sview s) {
+        string out;
+        out.reserve(s.size());
+        for (size_t n = 0; n < s.size(); n++) {
+            if (s[n] != '\\' || n + 1 == s.size()) {
+                out += s[n];
+                continue;
+            }
+            char c = s[++n];
+            out += c == 't' ? '\t' : c == 'n' ? '\n' : c;
+        }
+        return out;
+    }
+
+    static string format(op o, const fs::path& dest, const fs::path& detail) {
+        string s = std::format("{}\t{}", literal(o), escape(dest.native()));
+        if (!detail.empty()) s += std::format("\t{}", escape(detail.native()));
+        return s;
+    }
+
+    static vector<string> fields(sview line) {
+        vector<string> out;
+        for (size_t tab; (tab = line.find('\t')) != sview::npos; line.remove_prefix(tab + 1))
+            out.push_back(unescape(line.substr(0, tab)));
+        out.push_back(unescape(line));
+        return out;
+    }
+
+    static vector<string> lines(const fs::path& file) {
+        vector<string> out;
+        std::ifstream in(file);
+        for (string line; std::getline(in, line);) out.push_back(line);
+        return out;
+    }
+
+    fs::path location(sview config) {
+        fs::path state = xdg::homes().at("XDG_STATE_HOME");
+        return state / "confidant" / std::format("{}.journal", util::configkey(config));
+    }
+
+    writer::writer(sview config, std::uint64_t id) {
+        fs::path file = location(config);
+        string run = std::format("run\t{:016x}", id);
+
+        // only an unfinished run of the very same plan is worth resuming
+        vector<string> previous = lines(file);
+        bool resuming = previous.size() >= 2 && previous[0] == header && previous[1] == run
+            && previous.back() != "end";
+        if (resuming) {
+            for (const auto& l : previous) {
+                auto f = fields(l);
+                // a change that was only announced may have been made all the same
+                if (f.size() >= 3 && f[0] == "plan") f.erase(f.begin());
+                if (f.size() == 2 && f[0] == "done") finished.insert(f[1]);
+                else if (f.size() >= 2 && f[0] != "mkdir" && f[0] != "run") touched.insert(f[1]);
+            }
+        }
+
+        std::error_code ec;
+        fs::create_directories(file.parent_path(), ec);
+        fd = open(file.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC | (resuming ? 0 : O_TRUNC), 0644);
+        if (fd < 0) {
+            msg::warn("failed to open journal {}, this run can't be resumed or rolled back", fmt::bolden(file.string()));
+            return;
+        }
+        if (!resuming) {
+            line(string(header));
+            line(run);
+            sync();
+        } else {
+            msg::info("resuming an interrupted run, {} entries were already done", finished.size());
+        }
+    }
+
+    writer::~writer() {
+        if (fd < 0) return;
+        sync();
+        close(fd);
+    }
+
+    // straight to the file, so a run that is killed or exits through
+    // msg::fatal leaves everything it did behind
+    void writer::line(string s) {
+        if (fd < 0) return;
+        s += '\n';
+        sview rest = s;
+        while (!rest.empty()) {
+            ssize_t n = write(fd, rest.data(), rest.size());
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                break;
+            }
+            rest.remove_prefix(n);
+        }
+        if (++unsynced >= batch) sync();
+    }
+
+    void writer::sync() {
+        if (fd < 0 || unsynced == 0) return;
+        fdatasync(fd);
+        unsynced = 0;
+    }
+
+    void writer::intend(op o, const fs::path& dest, const fs::path& detail) {
+        string s = std::format("plan\t{}", format(o, dest, detail));
+        std::lock_guard held(guard);
+        line(std::move(s));
+    }
+
+    void writer::record(op o, const fs::path& dest, const fs::path& detail) {
+        string s = format(o, dest, detail);
+        std::lock_guard held(guard);
+        line(std::move(s));
+    }
+
+    void writer::complete(const fs::path& dest) {
+        std::lock_guard held(guard);
+        line(std::format("done\t{}", escape(dest.native())));
+    }
+
+    void writer::end() {
+        std::lock_guard held(guard);
+        line("end");
+        sync();
+    }
+
+    int rollback(sview config, bool dry) {
+        using util::unexpandhome;
+
+        fs::path file = location(config);
+        vector<string> recorded = lines(file);
+        if (recorded.size() < 2 || recorded[0] != header) {
+            msg::error("nothing to roll back for {}", fmt::bolden(config));
+            return 1;
+        }
+
+        // a change that was announced but never recorded was cut short, and is
+        // undone as far as it got; the checks below go by what is there now
+        std::unordered_set<sview> made(recorded.begin(), recorded.end());
+
+        int undone = 0;
+        int failed = 0;
+        std::error_code ec;
+        for (auto it = recorded.rbegin(); it != recorded.rend(); ++it) {
+            auto f = fields(*it);
+            bool unfinished = false;
+            if (f.size() >= 3 && f[0] == "plan") {
+                if (made.contains(sview(*it).substr(5))) continue;
+                f.erase(f.begin());
+                unfinished = true;
+            }
+            if (f.size() < 2 || f[0] == "done" || f[0] == "run") continue;
+            fs::path dest = f[1];
+            string udest = unexpandhome(dest.native());
+            ec.clear();
+
+            if (f[0] == "link" && f.size() == 3) {
+                // only if it is still the link we made
+                if (!fs::is_symlink(dest, ec) || fs::read_symlink(dest, ec) != fs::path(f[2])) continue;
+                if (!dry) fs::remove(dest, ec);
+                if (!ec) msg::pretty("removed {}", udest);
+            } else if (f[0] == "place") {
+                if (!fs::exists(fs::symlink_status(dest, ec))) continue;
+                if (!dry) fs::remove_all(dest, ec);
+                if (!dry && !ec) deploy::disown(dest);
+                if (!ec) msg::pretty("removed {}", udest);
+            } else if (f[0] == "mkdir") {
+                // left alone once something else lives there
+                if (!fs::is_directory(dest, ec) || !fs::is_empty(dest, ec)) continue;
+                if (!dry) fs::remove(dest, ec);
+                if (!ec) msg::extra("removed directory {}", fmt::bolden(udest));
+            } else if (f[0] == "backup" && f.size() == 3) {
+                fs::path saved = f[2];
+                if (!fs::exists(fs::symlink_status(saved, ec))) {
+                    // it never got moved
+                    if (unfinished) continue;
+                    msg::warn("backup of {} at {} is gone, leaving it", fmt::bolden(udest), fmt::bolden(saved.string()));
+                    continue;
+                }
+                if (!dry) {
+                    fs::remove_all(dest, ec);
+                    if (!ec) fs::rename(saved, dest, ec);
+                }
+                if (!ec) msg::pretty("restored {}", udest);
+            } else if (f[0] == "replace" && f.size() == 3) {
+                // a symlink is restored once what replaced it is gone again; a dry
+                // run can't tell whether the directory it became would have been
+                fs::file_status now = fs::symlink_status(dest, ec);
+                if (fs::exists(now) && !(dry && fs::is_directory(now))) {
+                    msg::warn("{} used to be a symlink to {}, but something else is there now, leaving it",
+                        fmt::bolden(udest), fmt::bolden(f[2]));
+                    continue;
+                }
+                if (!dry) fs::create_symlink(fs::path(f[2]), dest, ec);
+                if (!ec) msg::pretty("restored {}", udest);
+            } else if (f[0] == "replace") {
+                msg::warn("{} was replaced with {}, its previous contents can't be restored",
+                    fmt::bolden(udest), fmt::bolden("--force"));
+                continue;
+            } else {
+                continue;
+            }
+
+            if (ec) {
+                msg::error("failed to undo {} at {}: {}", f[0], fmt::bolden(udest), ec.message());
+                failed++;
+            } else {
+                undone++;
+            }
+        }
+
+        if (failed > 0) return 1;
+        // rolled back runs can't be rolled back, or resumed, again
+        if (!dry) fs::remove(file, ec);
+        if (undone == 0) msg::pretty("nothing needed rolling back");
+        else msg::trace("undid {} changes", undone);
+        return 0;
+    }
+
+}; // END journal
@@ -0,0 +1,66 @@
+// SPDX-FileCopyrightText: 2026 Will Reed <wreed@disroot.org>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+
+// an append-only record of what the last 'link' run did, kept in
+// $XDG_STATE_HOME/confidant/<config key>.journal; an interrupted run is
+// resumed from it, and a finished one can be undone with 'rollback'
+namespace journal {
+
+    enum class op {
+        link,    // created a symlink:         dest, target
+        place,   // created a copy or hardlink: dest
+        mkdir,   // created a directory:        dest
+        backup,  // moved a destination aside:  dest, backup
+        replace  // deleted a destination:      dest[, the symlink target it held]
+    };
+    // each change is also announced before it's made, so a run killed
+    // in between still knows where it may have been
+
+    std::filesystem::path location(std::string_view config);
+
+    class writer {
+    public:
+        // `id` identifies the plan; an unfinished run of the same plan is picked up
+        writer(std::string_view config, std::uint64_t id);
+        ~writer();
+        writer(const writer&) = delete;
+        writer& operator=(const writer&) = delete;
+
+        bool resumed() const { return !finished.empty(); }
+        // whether the interrupted run already got through the entry for `dest`
+        bool done(const std::filesystem::path& dest) const { return finished.contains(dest.native()); }
+        // whether the interrupted run changed anything at `dest`
+        bool changed(const std::filesystem::path& dest) const { return touched.contains(dest.native()); }
+
+        // safe to call from several threads at once; `intend` before the change, `record` after
+        void intend(op o, const std::filesystem::path& dest, const std::filesystem::path& detail = {});
+        void record(op o, const std::filesystem::path& dest, const std::filesystem::path& detail = {});
+        void complete(const std::filesystem::path& dest);
+        // the run went through; resuming no longer applies
+        void end();
+
+    private:
+        void line(std::string s);
+        void sync();
+
+        int fd = -1;
+        std::mutex guard;
+        std::size_t unsynced = 0;
+        std::unordered_set<std::string> finished;
+        std::unordered_set<std::string> touched;
+    };
+
+    // undo the recorded run, newest change first
+    int rollback(std::string_view config, bool dry);
+
+}; // END journal
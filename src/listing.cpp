@@ -0,0 +1,110 @@
+// SPDX-FileCopyrightText: 2026 Will Reed <wreed@disroot.org>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <atomic>
+#include <cerrno>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "listing.hpp"
+#include "scan.hpp"
+
+namespace fs = std::filesystem;
+
+using std::string;
+using sview = std::string_view;
+
+namespace listing {
+
+    struct directory {
+        std::once_flag read;
+        // errno from opening it, 0 when it was listed
+        int error = 0;
+        std::unordered_map<string, unsigned char> names;
+    };
+
+    static std::atomic<bool> enabled = false;
+    static std::mutex lock;
+    // a forgotten directory is dropped from here, but whoever is still reading
+    // the old listing keeps it; only lookups that start afterwards see the new one
+    static std::unordered_map<string, std::shared_ptr<directory>> known;
+
+    void enable() {
+        enabled = true;
+    }
+
+    static std::shared_ptr<directory> get(const fs::path& dir) {
+        std::shared_ptr<directory> d;
+        {
+            std::lock_guard held(lock);
+            auto& slot = known[dir.native()];
+            if (!slot) slot = std::make_shared<directory>();
+            d = slot;
+        }
+        // different directories are read at the same time, the same one only once
+        std::call_once(d->read, [&] {
+            int fd = open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+            if (fd < 0) {
+                d->error = errno;
+                return;
+            }
+            if (!scan::entries(fd, [&](sview name, unsigned char type, std::uint64_t) { d->names.emplace(name, type); }))
+                d->error = errno ? errno : EIO;
+            close(fd);
+        });
+        return d;
+    }
+
+    std::optional<fs::file_type> type(const fs::path& path) {
+        if (!enabled) return std::nullopt;
+        fs::path p = path.lexically_normal();
+        if (!p.is_absolute() || !p.has_filename() || p.filename() == "." || p.filename() == "..") return std::nullopt;
+
+        auto d = get(p.parent_path());
+        if (d->error == ENOENT || d->error == ENOTDIR) return fs::file_type::not_found;
+        if (d->error != 0) return std::nullopt;
+
+        auto it = d->names.find(p.filename().native());
+        if (it == d->names.end()) return fs::file_type::not_found;
+        fs::file_type t = scan::dtype(it->second);
+        if (t == fs::file_type::unknown) return std::nullopt;
+        return t;
+    }
+
+    fs::file_status symlink_status(const fs::path& path, std::error_code& ec) {
+        std::optional<fs::file_type> t = type(path);
+        if (!t) return fs::symlink_status(path, ec);
+        if (t == fs::file_type::not_found) {
+            ec = std::make_error_code(std::errc::no_such_file_or_directory);
+            return fs::file_status(fs::file_type::not_found);
+        }
+        ec.clear();
+        return fs::file_status(*t);
+    }
+
+    bool exists(const fs::path& path) {
+        std::optional<fs::file_type> t = type(path);
+        // where a symlink leads isn't in the listing
+        if (!t || t == fs::file_type::symlink) {
+            std::error_code ec;
+            return fs::exists(path, ec);
+        }
+        return t != fs::file_type::not_found;
+    }
+
+    void forget(const fs::path& path) {
+        if (!enabled) return;
+        fs::path p = path.lexically_normal();
+        std::lock_guard held(lock);
+        known.erase(p.native());
+        known.erase(p.parent_path().native());
+    }
+
+}; // END listing
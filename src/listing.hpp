@@ -0,0 +1,29 @@
+// SPDX-FileCopyrightText: 2026 Will Reed <wreed@disroot.org>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <filesystem>
+#include <optional>
+#include <system_error>
+
+// what is at the destinations, from one getdents64(2) of each directory they
+// are in rather than a stat per destination and parent; only for runs that end,
+// since the listings would go stale under long-running commands
+namespace listing {
+
+    // answer from listings for the rest of the run; off until then
+    void enable();
+
+    // what lstat(2) would say is at `path`, not_found included; nullopt when the
+    // listing can't tell (e.g. DT_UNKNOWN, or an unreadable directory)
+    std::optional<std::filesystem::file_type> type(const std::filesystem::path& path);
+    // fs::symlink_status() and fs::exists(), from the listings where they can be
+    std::filesystem::file_status symlink_status(const std::filesystem::path& path, std::error_code& ec);
+    bool exists(const std::filesystem::path& path);
+
+    // something at `path` was created or removed; the directory it is in, and
+    // the path itself if it's one, are read again when next asked about
+    void forget(const std::filesystem::path& path);
+
+}; // END listing
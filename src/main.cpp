@@ -11,7 +11,10 @@
 // std
 #include <format>
 #include <print>
+#include <charconv>
 #include <filesystem>
+#include <optional>
+#include <set>
 #include <stdexcept>
 #include <string>
 #include <string_view>
@@ -30,6 +33,22 @@
 #include "actions/dump.hpp"
 #include "actions/link.hpp"
 #include "actions/get.hpp"
+#include "actions/watch.hpp"
+#include "actions/serve.hpp"
+#include "actions/status.hpp"
+#include "actions/fleet.hpp"
+#include "actions/sysroot.hpp"
+#include "actions/package.hpp"
+#include "actions/hooks.hpp"
+#include "actions/complete.hpp"
+#include "actions/check.hpp"
+#include "actions/repo.hpp"
+#include "actions/plan.hpp"
+#include "actions/archive.hpp"
+#include "journal.hpp"
+#include "scan.hpp"
+#include "listing.hpp"
+#include "gitindex.hpp"
 
 // meson
 #include "config.hpp"
@@ -56,10 +75,120 @@ namespace args {
         bool help = false;
         bool dry = false;
         std::string tags;
+        std::string roots;
+        unsigned jobs = 0;
+        std::string sysroot;
+        std::string sysrootuser;
+        bool sysrootsources = false;
+        bool backup = false;
+        bool force = false;
+        bool nohooks = false;
+        bool strict = false;
+        bool nocheck = false;
+        bool changed = false;
+        std::string planout;
         std::string file = fs::current_path().string() + "/confidant.ucl";
     
     }; // END link
     
+    namespace watch {
+        bool self = false;
+        bool help = false;
+        std::string tags;
+        std::string file = fs::current_path().string() + "/confidant.ucl";
+    }; // END watch
+    
+    namespace serve {
+        bool self = false;
+        bool help = false;
+        std::string tags;
+        std::string file = fs::current_path().string() + "/confidant.ucl";
+    }; // END serve
+    
+    namespace status {
+        bool self = false;
+        bool help = false;
+        std::string what;
+        std::string tags;
+        std::string file = fs::current_path().string() + "/confidant.ucl";
+    }; // END status
+    
+    namespace which {
+        bool self = false;
+        bool help = false;
+        std::string path;
+        std::string tags;
+        std::string file = fs::current_path().string() + "/confidant.ucl";
+    }; // END which
+    
+    namespace rollback {
+        bool self = false;
+        bool help = false;
+        bool dry = false;
+        std::string file = fs::current_path().string() + "/confidant.ucl";
+    }; // END rollback
+    
+    namespace check {
+        bool self = false;
+        bool help = false;
+        bool strict = false;
+        unsigned jobs = 0;
+        std::string tags;
+        std::string file = fs::current_path().string() + "/confidant.ucl";
+    }; // END check
+    
+    namespace apply {
+        bool self = false;
+        bool help = false;
+        bool dry = false;
+        unsigned jobs = 0;
+        bool backup = false;
+        bool force = false;
+        bool nohooks = false;
+        bool strict = false;
+        bool nocheck = false;
+        std::string plan;
+    }; // END apply
+    
+    namespace archive {
+        bool self = false;
+        bool help = false;
+        std::string tags;
+        std::string format = "tar";
+        std::string owner = "0:0";
+        std::string dirmode = "755";
+        std::string file = fs::current_path().string() + "/confidant.ucl";
+    }; // END archive
+    
+    namespace clone {
+        bool self = false;
+        bool help = false;
+        std::string url;
+        std::string dir;
+        std::string tags;
+        unsigned jobs = 0;
+        unsigned depth = 1;
+        bool sparse = false;
+        bool nolink = false;
+    }; // END clone
+    
+    namespace sync {
+        bool self = false;
+        bool help = false;
+        std::string tags;
+        unsigned jobs = 0;
+        bool nolink = false;
+        std::string file = fs::current_path().string() + "/confidant.ucl";
+    }; // END sync
+    
+    // for the shell completions, left out of help and usage
+    namespace complete {
+        bool self = false;
+        std::string what;
+        std::string prefix;
+        std::string file = fs::current_path().string() + "/confidant.ucl";
+    }; // END complete
+    
     namespace config {
         bool self = false;
         bool help = false;
@@ -69,6 +198,8 @@ namespace args {
             bool help = false;
             bool json = false;
             bool global = false;
+            std::string tags;
+            std::string name;
             std::string file = fs::current_path().string() + "/confidant.ucl";
         }; // END dump
         
@@ -95,6 +226,16 @@ namespace args {
         }; // END config
         bool init = false;
         bool link = false;
+        bool watch = false;
+        bool serve = false;
+        bool status = false;
+        bool which = false;
+        bool rollback = false;
+        bool check = false;
+        bool apply = false;
+        bool archive = false;
+        bool clone = false;
+        bool sync = false;
     }; // END help
     
     namespace init {
@@ -113,7 +254,105 @@ namespace cmd {
         lyra::opt dry = lyra::opt(args::link::dry)["-d"]["--dry-run"];
         lyra::opt tags = lyra::opt(args::link::tags, "tags")["-t"]["--tags"];
         lyra::opt file = lyra::opt(args::link::file, "path")["-f"]["--file"];
+        lyra::opt roots = lyra::opt(args::link::roots, "path")["-r"]["--roots"];
+        lyra::opt jobs = lyra::opt(args::link::jobs, "jobs")["-j"]["--jobs"];
+        lyra::opt sysroot = lyra::opt(args::link::sysroot, "path")["--sysroot"];
+        lyra::opt sysrootuser = lyra::opt(args::link::sysrootuser, "user")["--sysroot-user"];
+        lyra::opt sysrootsources = lyra::opt(args::link::sysrootsources)["--sysroot-sources"];
+        lyra::opt backup = lyra::opt(args::link::backup)["--backup"];
+        lyra::opt force = lyra::opt(args::link::force)["--force"];
+        lyra::opt nohooks = lyra::opt(args::link::nohooks)["--no-hooks"];
+        lyra::opt strict = lyra::opt(args::link::strict)["--strict"];
+        lyra::opt nocheck = lyra::opt(args::link::nocheck)["--no-check"];
+        lyra::opt changed = lyra::opt(args::link::changed)["--changed"];
+        lyra::opt planout = lyra::opt(args::link::planout, "path")["--plan-out"];
     }; // END link
+    namespace watch {
+        lyra::command self = lyra::command("watch", [](const lyra::group&) { args::watch::self = true; });
+        lyra::help help = lyra::help(args::watch::help);
+        lyra::opt tags = lyra::opt(args::watch::tags, "tags")["-t"]["--tags"];
+        lyra::opt file = lyra::opt(args::watch::file, "path")["-f"]["--file"];
+    }; // END watch
+    namespace serve {
+        lyra::command self = lyra::command("serve", [](const lyra::group&) { args::serve::self = true; });
+        lyra::help help = lyra::help(args::serve::help);
+        lyra::opt tags = lyra::opt(args::serve::tags, "tags")["-t"]["--tags"];
+        lyra::opt file = lyra::opt(args::serve::file, "path")["-f"]["--file"];
+    }; // END serve
+    namespace status {
+        lyra::command self = lyra::command("status", [](const lyra::group&) { args::status::self = true; });
+        lyra::help help = lyra::help(args::status::help);
+        lyra::arg what = lyra::arg(args::status::what, "name");
+        lyra::opt tags = lyra::opt(args::status::tags, "tags")["-t"]["--tags"];
+        lyra::opt file = lyra::opt(args::status::file, "path")["-f"]["--file"];
+    }; // END status
+    namespace which {
+        lyra::command self = lyra::command("which", [](const lyra::group&) { args::which::self = true; });
+        lyra::help help = lyra::help(args::which::help);
+        lyra::arg path = lyra::arg(args::which::path, "path");
+        lyra::opt tags = lyra::opt(args::which::tags, "tags")["-t"]["--tags"];
+        lyra::opt file = lyra::opt(args::which::file, "path")["-f"]["--file"];
+    }; // END which
+    namespace rollback {
+        lyra::command self = lyra::command("rollback", [](const lyra::group&) { args::rollback::self = true; });
+        lyra::help help = lyra::help(args::rollback::help);
+        lyra::opt dry = lyra::opt(args::rollback::dry)["-d"]["--dry-run"];
+        lyra::opt file = lyra::opt(args::rollback::file, "path")["-f"]["--file"];
+    }; // END rollback
+    namespace check {
+        lyra::command self = lyra::command("check", [](const lyra::group&) { args::check::self = true; });
+        lyra::help help = lyra::help(args::check::help);
+        lyra::opt strict = lyra::opt(args::check::strict)["--strict"];
+        lyra::opt jobs = lyra::opt(args::check::jobs, "jobs")["-j"]["--jobs"];
+        lyra::opt tags = lyra::opt(args::check::tags, "tags")["-t"]["--tags"];
+        lyra::opt file = lyra::opt(args::check::file, "path")["-f"]["--file"];
+    }; // END check
+    namespace apply {
+        lyra::command self = lyra::command("apply", [](const lyra::group&) { args::apply::self = true; });
+        lyra::help help = lyra::help(args::apply::help);
+        lyra::arg plan = lyra::arg(args::apply::plan, "path");
+        lyra::opt dry = lyra::opt(args::apply::dry)["-d"]["--dry-run"];
+        lyra::opt jobs = lyra::opt(args::apply::jobs, "jobs")["-j"]["--jobs"];
+        lyra::opt backup = lyra::opt(args::apply::backup)["--backup"];
+        lyra::opt force = lyra::opt(args::apply::force)["--force"];
+        lyra::opt nohooks = lyra::opt(args::apply::nohooks)["--no-hooks"];
+        lyra::opt strict = lyra::opt(args::apply::strict)["--strict"];
+        lyra::opt nocheck = lyra::opt(args::apply::nocheck)["--no-check"];
+    }; // END apply
+    namespace archive {
+        lyra::command self = lyra::command("archive", [](const lyra::group&) { args::archive::self = true; });
+        lyra::help help = lyra::help(args::archive::help);
+        lyra::opt tags = lyra::opt(args::archive::tags, "tags")["-t"]["--tags"];
+        lyra::opt file = lyra::opt(args::archive::file, "path")["-f"]["--file"];
+        lyra::opt format = lyra::opt(args::archive::format, "format")["--format"];
+        lyra::opt owner = lyra::opt(args::archive::owner, "uid:gid")["--owner"];
+        lyra::opt dirmode = lyra::opt(args::archive::dirmode, "mode")["--dir-mode"];
+    }; // END archive
+    namespace clone {
+        lyra::command self = lyra::command("clone", [](const lyra::group&) { args::clone::self = true; });
+        lyra::help help = lyra::help(args::clone::help);
+        lyra::arg url = lyra::arg(args::clone::url, "url");
+        lyra::arg dir = lyra::arg(args::clone::dir, "path");
+        lyra::opt tags = lyra::opt(args::clone::tags, "tags")["-t"]["--tags"];
+        lyra::opt jobs = lyra::opt(args::clone::jobs, "jobs")["-j"]["--jobs"];
+        lyra::opt depth = lyra::opt(args::clone::depth, "depth")["--depth"];
+        lyra::opt sparse = lyra::opt(args::clone::sparse)["--sparse"];
+        lyra::opt nolink = lyra::opt(args::clone::nolink)["--no-link"];
+    }; // END clone
+    namespace sync {
+        lyra::command self = lyra::command("sync", [](const lyra::group&) { args::sync::self = true; });
+        lyra::help help = lyra::help(args::sync::help);
+        lyra::opt tags = lyra::opt(args::sync::tags, "tags")["-t"]["--tags"];
+        lyra::opt jobs = lyra::opt(args::sync::jobs, "jobs")["-j"]["--jobs"];
+        lyra::opt nolink = lyra::opt(args::sync::nolink)["--no-link"];
+        lyra::opt file = lyra::opt(args::sync::file, "path")["-f"]["--file"];
+    }; // END sync
+    namespace complete {
+        lyra::command self = lyra::command("complete", [](const lyra::group&) { args::complete::self = true; });
+        lyra::arg what = lyra::arg(args::complete::what, "what");
+        lyra::arg prefix = lyra::arg(args::complete::prefix, "prefix");
+        lyra::opt file = lyra::opt(args::complete::file, "path")["-f"]["--file"];
+    }; // END complete
     namespace help {
         lyra::command self = lyra::command("help", [](const lyra::group&) { args::help::self = true; });
         namespace config {
@@ -123,6 +362,16 @@ namespace cmd {
         }; // END config
         lyra::command init = lyra::command("init", [](const lyra::group&) { args::init::help = true; });
         lyra::command link = lyra::command("link", [](const lyra::group&) { args::link::help = true; });
+        lyra::command watch = lyra::command("watch", [](const lyra::group&) { args::watch::help = true; });
+        lyra::command serve = lyra::command("serve", [](const lyra::group&) { args::serve::help = true; });
+        lyra::command status = lyra::command("status", [](const lyra::group&) { args::status::help = true; });
+        lyra::command which = lyra::command("which", [](const lyra::group&) { args::which::help = true; });
+        lyra::command rollback = lyra::command("rollback", [](const lyra::group&) { args::rollback::help = true; });
+        lyra::command check = lyra::command("check", [](const lyra::group&) { args::check::help = true; });
+        lyra::command apply = lyra::command("apply", [](const lyra::group&) { args::apply::help = true; });
+        lyra::command archive = lyra::command("archive", [](const lyra::group&) { args::archive::help = true; });
+        lyra::command clone = lyra::command("clone", [](const lyra::group&) { args::clone::help = true; });
+        lyra::command sync = lyra::command("sync", [](const lyra::group&) { args::sync::help = true; });
     }; // END help
     namespace init {
         lyra::command self = lyra::command("init", [](const lyra::group&) { args::init::self = true; });
@@ -138,6 +387,8 @@ namespace cmd {
             lyra::help help = lyra::help(args::config::dump::help);
             lyra::opt global = lyra::opt(args::config::dump::global)["-g"]["--global"].optional();
             lyra::opt json = lyra::opt(args::config::dump::json)["-j"]["--json"].optional();
+            lyra::opt tags = lyra::opt(args::config::dump::tags, "tags")["-t"]["--tags"];
+            lyra::opt name = lyra::opt(args::config::dump::name, "name")["-n"]["--name"];
             lyra::opt file = lyra::opt(args::config::dump::file, "path")["-f"]["--file"];
         }; // END dump
         namespace get {
@@ -181,28 +432,8 @@ int main(int argc, const char *argv[]) {
     std::string argz = util::stripargz(argv[0]);
     gconfig::color = usecolorp;
     options::global::color = usecolorp;
+    fmt::colored = usecolorp;
     
-    fs::path gconfpath = help::defaults::global_config_path();
-    // check for global config file; try to create it
-    if (!fs::exists(gconfpath)) {
-        try {
-            if (!fs::exists(gconfpath.parent_path()))
-                try {
-                    std::filesystem::create_directory(gconfpath.parent_path());
-                } catch (const fs::filesystem_error& err) {
-                    msg::error("failed to create parent directory {} for global config file!", gconfpath.parent_path().string());
-                    std::cout << err.what() << std::endl;
-                }
-            // write the default global config
-            help::defaults::write_global_config(gconfpath.string());
-        } catch (const fs::filesystem_error& e) {
-            msg::error("failed to create global config file at {}!", gconfpath.string());
-            std::cout << e.what() << std::endl;
-        }
-    }
-    
-    // found the global config, serialize it
-    gconfig::settings gconf = gconfig::serialize(gconfpath.string());
     
     // prepare cli
     lyra::cli cli;
@@ -211,6 +442,16 @@ int main(int argc, const char *argv[]) {
     .add_argument(cmd::help::self
         .add_argument(cmd::help::init)
         .add_argument(cmd::help::link)
+        .add_argument(cmd::help::watch)
+        .add_argument(cmd::help::serve)
+        .add_argument(cmd::help::status)
+        .add_argument(cmd::help::which)
+        .add_argument(cmd::help::rollback)
+        .add_argument(cmd::help::check)
+        .add_argument(cmd::help::apply)
+        .add_argument(cmd::help::archive)
+        .add_argument(cmd::help::clone)
+        .add_argument(cmd::help::sync)
         .add_argument(cmd::help::config::self
             .add_argument(cmd::help::config::dump)
             .add_argument(cmd::help::config::get)))
@@ -226,9 +467,116 @@ int main(int argc, const char *argv[]) {
         .add_argument(cmd::link::dry)
         .add_argument(cmd::link::file)
         .add_argument(cmd::link::tags)
+        .add_argument(cmd::link::roots)
+        .add_argument(cmd::link::jobs)
+        .add_argument(cmd::link::sysroot)
+        .add_argument(cmd::link::sysrootuser)
+        .add_argument(cmd::link::sysrootsources)
+        .add_argument(cmd::link::backup)
+        .add_argument(cmd::link::force)
+        .add_argument(cmd::link::nohooks)
+        .add_argument(cmd::link::strict)
+        .add_argument(cmd::link::nocheck)
+        .add_argument(cmd::link::changed)
+        .add_argument(cmd::link::planout)
         .add_argument(cmd::link::help)
         .add_argument(flags::verbose)
         .add_argument(flags::quiet))
+    // watch subcommand
+    .add_argument(cmd::watch::self
+        .add_argument(cmd::watch::file)
+        .add_argument(cmd::watch::tags)
+        .add_argument(cmd::watch::help)
+        .add_argument(flags::verbose)
+        .add_argument(flags::quiet))
+    // serve subcommand
+    .add_argument(cmd::serve::self
+        .add_argument(cmd::serve::file)
+        .add_argument(cmd::serve::tags)
+        .add_argument(cmd::serve::help)
+        .add_argument(flags::verbose)
+        .add_argument(flags::quiet))
+    // status subcommand
+    .add_argument(cmd::status::self
+        .add_argument(cmd::status::file)
+        .add_argument(cmd::status::tags)
+        .add_argument(cmd::status::help)
+        .add_argument(cmd::status::what)
+        .add_argument(flags::verbose)
+        .add_argument(flags::quiet))
+    // which subcommand
+    .add_argument(cmd::which::self
+        .add_argument(cmd::which::file)
+        .add_argument(cmd::which::tags)
+        .add_argument(cmd::which::help)
+        .add_argument(cmd::which::path)
+        .add_argument(flags::verbose)
+        .add_argument(flags::quiet))
+    // rollback subcommand
+    .add_argument(cmd::rollback::self
+        .add_argument(cmd::rollback::dry)
+        .add_argument(cmd::rollback::file)
+        .add_argument(cmd::rollback::help)
+        .add_argument(flags::verbose)
+        .add_argument(flags::quiet))
+    // check subcommand
+    .add_argument(cmd::check::self
+        .add_argument(cmd::check::strict)
+        .add_argument(cmd::check::jobs)
+        .add_argument(cmd::check::tags)
+        .add_argument(cmd::check::file)
+        .add_argument(cmd::check::help)
+        .add_argument(flags::verbose)
+        .add_argument(flags::quiet))
+    // apply subcommand
+    .add_argument(cmd::apply::self
+        .add_argument(cmd::apply::dry)
+        .add_argument(cmd::apply::jobs)
+        .add_argument(cmd::apply::backup)
+        .add_argument(cmd::apply::force)
+        .add_argument(cmd::apply::nohooks)
+        .add_argument(cmd::apply::strict)
+        .add_argument(cmd::apply::nocheck)
+        .add_argument(cmd::apply::help)
+        .add_argument(cmd::apply::plan)
+        .add_argument(flags::verbose)
+        .add_argument(flags::quiet))
+    // archive subcommand
+    .add_argument(cmd::archive::self
+        .add_argument(cmd::archive::tags)
+        .add_argument(cmd::archive::file)
+        .add_argument(cmd::archive::format)
+        .add_argument(cmd::archive::owner)
+        .add_argument(cmd::archive::dirmode)
+        .add_argument(cmd::archive::help)
+        .add_argument(flags::verbose)
+        .add_argument(flags::quiet))
+    // clone subcommand
+    .add_argument(cmd::clone::self
+        .add_argument(cmd::clone::tags)
+        .add_argument(cmd::clone::jobs)
+        .add_argument(cmd::clone::depth)
+        .add_argument(cmd::clone::sparse)
+        .add_argument(cmd::clone::nolink)
+        .add_argument(cmd::clone::help)
+        .add_argument(cmd::clone::url)
+        .add_argument(cmd::clone::dir)
+        .add_argument(flags::verbose)
+        .add_argument(flags::quiet))
+    // sync subcommand
+    .add_argument(cmd::sync::self
+        .add_argument(cmd::sync::tags)
+        .add_argument(cmd::sync::jobs)
+        .add_argument(cmd::sync::nolink)
+        .add_argument(cmd::sync::file)
+        .add_argument(cmd::sync::help)
+        .add_argument(flags::verbose)
+        .add_argument(flags::quiet))
+    // complete subcommand
+    .add_argument(cmd::complete::self
+        .add_argument(cmd::complete::file)
+        .add_argument(cmd::complete::what)
+        .add_argument(cmd::complete::prefix))
     // config subcommand
     .add_argument(cmd::config::self
         // config get subcommand
@@ -245,6 +593,8 @@ int main(int argc, const char *argv[]) {
             .add_argument(cmd::config::dump::help)
             .add_argument(cmd::config::dump::global)
             .add_argument(cmd::config::dump::json)
+            .add_argument(cmd::config::dump::tags)
+            .add_argument(cmd::config::dump::name)
             .add_argument(flags::quiet)
             .add_argument(flags::verbose))
         .add_argument(flags::verbose)
@@ -261,6 +611,68 @@ int main(int argc, const char *argv[]) {
     // parse the command line
     lyra::parse_result res = cli.parse ( { argc, argv } );
     
+    // completions are asked for on every TAB press, answer before anything else
+    if (args::complete::self)
+        return res ? actions::complete::run(args::complete::file, args::complete::what, args::complete::prefix) : 1;
+    
+    // answer from a running 'confidant serve' when there is one, before
+    // paying for parsing the global and local configuration
+    if (res && !args::help::self) {
+        std::optional<actions::serve::reply> served;
+        bool statusp = false;
+        
+        if (args::config::get::self && !args::config::get::global && !args::config::get::help
+            && !args::config::get::query.starts_with('-'))
+            served = actions::serve::ask(args::config::get::file, "get " + args::config::get::query);
+        else if (args::status::self && !args::status::help && !args::status::what.starts_with('-')) {
+            // the server resolves paths against its own working directory
+            std::string what = args::status::what.find('/') == std::string::npos
+                ? args::status::what : fs::absolute(args::status::what).string();
+            // and only answers for the tags it planned with
+            std::string tags = actions::serve::tagset(util::splittags(args::status::tags));
+            served = actions::serve::ask(args::status::file, "status " + tags + " " + what);
+            statusp = true;
+        } else if (args::which::self && !args::which::help
+            && !args::which::path.empty() && !args::which::path.starts_with('-')) {
+            std::string tags = actions::serve::tagset(util::splittags(args::which::tags));
+            served = actions::serve::ask(args::which::file, "which " + tags + " " + fs::absolute(args::which::path).string());
+        }
+        
+        if (served) {
+            if (!served->ok) {
+                std::string_view body = served->body;
+                if (body.ends_with('\n')) body.remove_suffix(1);
+                msg::error("{}", body);
+                return 1;
+            }
+            std::cout << served->body << std::flush;
+            if (statusp) return actions::status::linked(served->body) ? 0 : 1;
+            return 0;
+        }
+    }
+    
+    fs::path gconfpath = help::defaults::global_config_path();
+    // check for global config file; try to create it
+    if (!fs::exists(gconfpath)) {
+        try {
+            if (!fs::exists(gconfpath.parent_path()))
+                try {
+                    std::filesystem::create_directory(gconfpath.parent_path());
+                } catch (const fs::filesystem_error& err) {
+                    msg::error("failed to create parent directory {} for global config file!", gconfpath.parent_path().string());
+                    std::cout << err.what() << std::endl;
+                }
+            // write the default global config
+            help::defaults::write_global_config(gconfpath.string());
+        } catch (const fs::filesystem_error& e) {
+            msg::error("failed to create global config file at {}!", gconfpath.string());
+            std::cout << e.what() << std::endl;
+        }
+    }
+    
+    // found the global config, serialize it
+    gconfig::settings gconf = gconfig::serialize(gconfpath.string());
+    
     /* apply global configurations */
     
     // color
@@ -272,6 +684,7 @@ int main(int argc, const char *argv[]) {
         options::global::color = gconf.color;
         gconfig::color = gconf.color;
     }
+    fmt::colored = gconfig::color;
     
     // log-level
     if (args::quiet && args::verbose) {
@@ -306,6 +719,26 @@ int main(int argc, const char *argv[]) {
         args::config::get::help = true;
     }
     
+    if (args::status::what.starts_with('-')) {
+        args::status::what = "";
+        args::status::help = true;
+    }
+    
+    if (args::which::path.starts_with('-')) {
+        args::which::path = "";
+        args::which::help = true;
+    }
+    
+    if (args::apply::plan.starts_with('-') || (args::apply::self && args::apply::plan.empty())) {
+        args::apply::plan = "";
+        args::apply::help = true;
+    }
+    
+    if (args::clone::url.starts_with('-') || (args::clone::self && args::clone::url.empty())) {
+        args::clone::url = "";
+        args::clone::help = true;
+    }
+    
     if (args::init::path.starts_with('-') || args::init::path == "-d" || args::init::path == "--dry-run") {
         args::init::path = "";
         args::init::help = true;
@@ -314,6 +747,16 @@ int main(int argc, const char *argv[]) {
     if (args::help::self) {
         if (args::init::help) help::init::help(argz);
         else if (args::link::help) help::link::help(argz);
+        else if (args::watch::help) help::watch::help(argz);
+        else if (args::serve::help) help::serve::help(argz);
+        else if (args::status::help) help::status::help(argz);
+        else if (args::which::help) help::which::help(argz);
+        else if (args::rollback::help) help::rollback::help(argz);
+        else if (args::check::help) help::check::help(argz);
+        else if (args::apply::help) help::apply::help(argz);
+        else if (args::archive::help) help::archive::help(argz);
+        else if (args::clone::help) help::clone::help(argz);
+        else if (args::sync::help) help::sync::help(argz);
         else if (args::config::help) {
             if (args::config::dump::help) help::config::dump::help(argz);
             else if (args::config::get::help) help::config::get::help(argz);
@@ -358,25 +801,80 @@ int main(int argc, const char *argv[]) {
         return 0;
     }
     
+    if (args::watch::help) {
+        help::watch::help(argz);
+        return 0;
+    }
+    
+    if (args::serve::help) {
+        help::serve::help(argz);
+        return 0;
+    }
+    
+    if (args::status::help) {
+        help::status::help(argz);
+        return 0;
+    }
+    
+    if (args::which::help) {
+        help::which::help(argz);
+        return 0;
+    }
+    
+    if (args::rollback::help) {
+        help::rollback::help(argz);
+        return 0;
+    }
+    
+    if (args::check::help) {
+        help::check::help(argz);
+        return 0;
+    }
+    
+    if (args::apply::help) {
+        help::apply::help(argz);
+        return 0;
+    }
+    
+    if (args::archive::help) {
+        help::archive::help(argz);
+        return 0;
+    }
+    
+    if (args::clone::help) {
+        help::clone::help(argz);
+        return 0;
+    }
+    
+    if (args::sync::help) {
+        help::sync::help(argz);
+        return 0;
+    }
+    
     if (args::config::self) {
         
         if (args::config::dump::self) {
             
             if (args::config::dump::global) {
                 if (args::config::dump::json) {
-                    actions::dump::json::global(help::defaults::global_config_path());
+                    actions::dump::json::global(gconf);
                     return 0;
                 } else {
                     actions::dump::global(gconf);
                     return 0;
                 }
             } else {
+                actions::dump::filter only;
+                if (!args::config::dump::tags.empty())
+                    only.tags = util::splittags(args::config::dump::tags);
+                only.name = args::config::dump::name;
+                
+                lconfig::settings lconf = lconfig::serialize(args::config::dump::file, gconf);
                 if (args::config::dump::json) {
-                    actions::dump::json::local(args::config::dump::file);
+                    actions::dump::json::local(lconf, only);
                     return 0;
                 } else {
-                    lconfig::settings lconf = lconfig::serialize(args::config::dump::file, gconf);
-                    actions::dump::local(lconf);
+                    actions::dump::local(lconf, only);
                     return 0;
                 }
             }
@@ -391,7 +889,7 @@ int main(int argc, const char *argv[]) {
                 std::println("{}", actions::get::formatglobalvalue(res.value()));
                 return 0;
             } else {
-                lconfig::settings lconf = lconfig::serialize(args::config::dump::file, gconf);
+                lconfig::settings lconf = lconfig::serialize(args::config::get::file, gconf);
                 auto res = actions::get::local(lconf, args::config::get::query);
                 if (!res) {
                     msg::error("setting {} not found in configuration", fmt::bolden(args::config::get::query));
@@ -403,18 +901,270 @@ int main(int argc, const char *argv[]) {
         }
     }
     
+    // both go on to link what they fetched, as 'link' would
+    if (args::clone::self) {
+        fs::path dir = args::clone::dir.empty()
+            ? actions::repo::directory(args::clone::url) : fs::absolute(args::clone::dir);
+        int c = actions::repo::clone(args::clone::url, dir, args::clone::depth, args::clone::sparse, gconf);
+        if (c != 0 || args::clone::nolink) return c;
+        args::link::self = true;
+        args::link::file = (dir / "confidant.ucl").string();
+        args::link::tags = args::clone::tags;
+        args::link::jobs = args::clone::jobs;
+    }
+    
+    if (args::sync::self) {
+        int s = actions::repo::sync(args::sync::file, gconf);
+        if (s != 0 || args::sync::nolink) return s;
+        // only what the pull changed has to be looked at
+        args::link::self = true;
+        args::link::file = args::sync::file;
+        args::link::tags = args::sync::tags;
+        args::link::jobs = args::sync::jobs;
+        args::link::changed = true;
+    }
+    
     if (args::link::self) {
         std::vector<std::string_view> tags;
         
         if (!args::link::tags.empty())
             tags = util::splittags(args::link::tags);
         
+        if (args::link::backup && args::link::force) {
+            msg::error("--backup and --force are mutually exclusive.");
+            return 1;
+        } else if (args::link::backup) {
+            gconf.conflicts = gconfig::conflict::backup;
+        } else if (args::link::force) {
+            gconf.conflicts = gconfig::conflict::force;
+        }
+        
+        if (!args::link::planout.empty() && (!args::link::roots.empty() || !args::link::sysroot.empty())) {
+            msg::error("{} can't be combined with {} or {}", fmt::bolden("--plan-out"), fmt::bolden("--roots"), fmt::bolden("--sysroot"));
+            return 1;
+        }
+        
+        if (!args::link::roots.empty()) {
+            auto roots = actions::fleet::roots(args::link::roots);
+            return actions::fleet::run(args::link::file, gconf, tags, roots, args::link::jobs, args::link::dry);
+        }
+        
+        if (!args::link::sysroot.empty()) {
+            std::string user = args::link::sysrootuser;
+            if (user.empty()) user = util::getenv("USER").value_or("");
+            if (user.empty()) {
+                msg::error("no user given for {}, and USER is not set", fmt::bolden("--sysroot"));
+                return 1;
+            }
+            return actions::sysroot::run(args::link::file, gconf, tags, args::link::sysroot, user,
+                args::link::sysrootsources, args::link::dry);
+        }
+        
         lconfig::settings lconf = lconfig::serialize(args::link::file, gconf);
-        int n = actions::link::linknormal(lconf, gconf, tags, args::link::dry);
+        std::uint64_t id = actions::link::identify(lconf, tags);
+        
+        // everything is resolved by now; hosts given the plan start from here
+        if (!args::link::planout.empty()) {
+            auto entries = actions::link::plan(lconf, tags);
+            if (!lconf.packages.empty())
+                msg::warn("packages depend on what is already at each destination and are not planned");
+            if (!actions::plan::save(args::link::planout, entries, lconf.hooks, id)) return 1;
+            msg::pretty("planned {} entries into {}", entries.size(), fmt::bolden(args::link::planout));
+            return 0;
+        }
+        
+        // what git has staged is kept after every run; with --changed, only the
+        // sources staged differently since the last run of this plan are looked at
+        auto tree = gitindex::worktree(fs::path(args::link::file).parent_path());
+        std::optional<gitindex::snapshot> staged;
+        if (tree) staged = gitindex::read(tree.value());
+        std::optional<gitindex::diff> since;
+        if (args::link::changed) {
+            if (!staged) {
+                msg::warn("{} needs the configuration in a git repository, linking everything", fmt::bolden("--changed"));
+            } else if (auto last = gitindex::recorded(args::link::file); last && last->first == id) {
+                since.emplace(tree.value(), last->second, staged.value());
+                msg::extra("{} paths changed since the last run", since->size());
+            } else {
+                msg::info("nothing was linked with these settings yet, linking everything");
+            }
+        }
+        
+        // sources are looked up in one walk of the repository, destinations in
+        // one listing of each directory they are in; a few changed sources are
+        // quicker to look up one by one
+        if (!since)
+            scan::warm(fs::path(args::link::file).parent_path(), args::link::jobs);
+        listing::enable();
+        
+        // find every problem before changing anything, rather than stopping halfway
+        if (!args::link::nocheck) {
+            auto entries = actions::link::plan(lconf, tags);
+            if (since)
+                std::erase_if(entries, [&](const auto& e) { return actions::link::unchanged(e, since.value()); });
+            auto found = actions::check::validate(entries, gconf, args::link::jobs);
+            if (!actions::check::clean(found, args::link::strict)) {
+                actions::check::show(entries, found);
+                msg::error("not applying anything, {} errors and {} warnings were found", found.errors, found.warnings);
+                return 1;
+            }
+        }
+        
+        // dry runs change nothing worth resuming or rolling back
+        std::optional<journal::writer> log;
+        if (!args::link::dry)
+            log.emplace(args::link::file, id);
+        journal::writer* logp = log ? &log.value() : nullptr;
+        
+        std::set<std::string> fired;
+        std::size_t failed = 0;
+        int n = actions::link::linkall(lconf, gconf, tags, args::link::dry, args::link::jobs, logp, &fired,
+            since ? &since.value() : nullptr, &failed);
         if (n != 0) return n;
-        int t = actions::link::linktemplate(lconf, gconf, tags, args::link::dry);
-        if (t != 0) return n;
-        return n + t;
+        int p = actions::package::linkpackages(lconf, gconf, tags, args::link::dry, logp);
+        if (p != 0) return p;
+        if (log) log->end();
+        // what failed is still different from the index last recorded, and is retried
+        if (log && staged && failed == 0)
+            gitindex::record(args::link::file, id, staged.value());
+        
+        if (args::link::nohooks) {
+            if (!fired.empty()) msg::info("not running {} hooks", fired.size());
+            return 0;
+        }
+        return actions::hooks::run(lconf, fired, args::link::jobs, args::link::dry);
+    }
+    
+    if (args::watch::self) {
+        std::vector<std::string_view> tags;
+        
+        if (!args::watch::tags.empty())
+            tags = util::splittags(args::watch::tags);
+        
+        return actions::watch::run(args::watch::file, gconf, tags);
+    }
+    
+    if (args::serve::self) {
+        std::vector<std::string_view> tags;
+        
+        if (!args::serve::tags.empty())
+            tags = util::splittags(args::serve::tags);
+        
+        return actions::serve::run(args::serve::file, gconf, tags);
+    }
+    
+    if (args::status::self) {
+        std::vector<std::string_view> tags;
+        
+        if (!args::status::tags.empty())
+            tags = util::splittags(args::status::tags);
+        
+        lconfig::settings lconf = lconfig::serialize(args::status::file, gconf);
+        scan::warm(fs::path(args::status::file).parent_path());
+        listing::enable();
+        auto entries = actions::link::plan(lconf, tags);
+        auto packaged = actions::package::plan(lconf, tags).entries;
+        entries.insert(entries.end(), packaged.begin(), packaged.end());
+        auto found = actions::status::select(entries, args::status::what);
+        if (found.empty()) {
+            msg::error("no link named {} in configuration", fmt::bolden(args::status::what));
+            return 1;
+        }
+        std::string report = actions::status::format(found);
+        std::cout << report << std::flush;
+        return actions::status::linked(report) ? 0 : 1;
+    }
+    
+    if (args::which::self) {
+        std::vector<std::string_view> tags;
+        
+        if (!args::which::tags.empty())
+            tags = util::splittags(args::which::tags);
+        
+        if (args::which::path.empty()) {
+            help::which::help(argz);
+            return 1;
+        }
+        
+        lconfig::settings lconf = lconfig::serialize(args::which::file, gconf);
+        auto entries = actions::link::plan(lconf, tags);
+        auto packaged = actions::package::plan(lconf, tags).entries;
+        entries.insert(entries.end(), packaged.begin(), packaged.end());
+        auto found = actions::status::which(entries, args::which::path);
+        if (!found) {
+            msg::error("{} is not managed by confidant", fmt::bolden(args::which::path));
+            return 1;
+        }
+        std::cout << actions::status::format(found.value()) << std::flush;
+        return 0;
+    }
+    
+    if (args::check::self) {
+        std::vector<std::string_view> tags;
+        
+        if (!args::check::tags.empty())
+            tags = util::splittags(args::check::tags);
+        
+        return actions::check::run(args::check::file, gconf, tags, args::check::jobs, args::check::strict);
+    }
+    
+    if (args::apply::self) {
+        if (args::apply::backup && args::apply::force) {
+            msg::error("--backup and --force are mutually exclusive.");
+            return 1;
+        } else if (args::apply::backup) {
+            gconf.conflicts = gconfig::conflict::backup;
+        } else if (args::apply::force) {
+            gconf.conflicts = gconfig::conflict::force;
+        }
+        
+        return actions::plan::apply(args::apply::plan, gconf, args::apply::jobs, args::apply::dry,
+            args::apply::nohooks, args::apply::nocheck, args::apply::strict);
+    }
+    
+    if (args::archive::self) {
+        std::vector<std::string_view> tags;
+        
+        if (!args::archive::tags.empty())
+            tags = util::splittags(args::archive::tags);
+        
+        actions::archive::options opts;
+        if (args::archive::format == "tar") {
+            opts.kind = actions::archive::format::tar;
+        } else if (args::archive::format == "cpio") {
+            opts.kind = actions::archive::format::cpio;
+        } else {
+            msg::error("format {} is not recognized, expected {} or {}", fmt::ital(args::archive::format),
+                fmt::bolden("tar"), fmt::bolden("cpio"));
+            return 1;
+        }
+        
+        auto number = [](std::string_view s, auto& out, int base) {
+            auto [p, ec] = std::from_chars(s.data(), s.data() + s.size(), out, base);
+            return ec == std::errc() && p == s.data() + s.size() && !s.empty();
+        };
+        std::string_view owner = args::archive::owner;
+        size_t colon = owner.find(':');
+        if (colon == std::string_view::npos
+            || !number(owner.substr(0, colon), opts.uid, 10) || !number(owner.substr(colon + 1), opts.gid, 10)) {
+            msg::error("{} expects numeric {}", fmt::bolden("--owner"), fmt::ital("UID:GID"));
+            return 1;
+        }
+        if (!number(args::archive::dirmode, opts.dirmode, 8) || opts.dirmode > 07777) {
+            msg::error("{} expects an octal mode such as {}", fmt::bolden("--dir-mode"), fmt::ital("755"));
+            return 1;
+        }
+        // reproducible builds pin every timestamp this way
+        if (auto epoch = util::getenv("SOURCE_DATE_EPOCH"); epoch && !number(epoch.value(), opts.mtime, 10)) {
+            msg::error("SOURCE_DATE_EPOCH is not a number of seconds");
+            return 1;
+        }
+        
+        return actions::archive::run(args::archive::file, gconf, tags, opts);
+    }
+    
+    if (args::rollback::self) {
+        return journal::rollback(args::rollback::file, args::rollback::dry);
     }
     
     if (args::init::self) {
@@ -0,0 +1,94 @@
+// SPDX-FileCopyrightText: 2026 Will Reed <wreed@disroot.org>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <charconv>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include <libintl.h>
+
+#include "msg.hpp"
+
+namespace msg {
+    namespace detail {
+
+        // keyed by the address of the literal; the same text from another
+        // translation unit just gets an entry of its own
+        static std::mutex guard;
+        static std::unordered_map<const char*, translation> cache;
+
+        bool fits(std::string_view text, std::size_t args) {
+            std::size_t automatic = 0;
+            bool manual = false;
+            // reads an argument id ending at '}' or ':', starting just past its '{'
+            auto field = [&](std::size_t& i) {
+                std::size_t start = i;
+                while (i < text.size() && text[i] >= '0' && text[i] <= '9') i++;
+                if (i == start) {
+                    if (manual) return false;
+                    automatic++;
+                    return automatic <= args;
+                }
+                if (automatic > 0) return false;
+                manual = true;
+                std::size_t index = 0;
+                auto [end, ec] = std::from_chars(text.data() + start, text.data() + i, index);
+                return ec == std::errc() && index < args;
+            };
+
+            for (std::size_t i = 0; i < text.size(); i++) {
+                if (text[i] == '}') {
+                    if (i + 1 < text.size() && text[i + 1] == '}') { i++; continue; }
+                    return false;
+                }
+                if (text[i] != '{') continue;
+                if (i + 1 < text.size() && text[i + 1] == '{') { i++; continue; }
+
+                i++;
+                if (!field(i)) return false;
+                if (i < text.size() && text[i] == ':') {
+                    // the spec may take its width or precision from an argument
+                    for (i++; i < text.size() && text[i] != '}'; i++) {
+                        if (text[i] != '{') continue;
+                        i++;
+                        if (!field(i) || i >= text.size() || text[i] != '}') return false;
+                    }
+                }
+                if (i >= text.size() || text[i] != '}') return false;
+            }
+            return true;
+        }
+
+        const translation& translate(const char* msgid, std::size_t args) {
+            bool dropped = false;
+            const translation* t;
+            {
+                std::lock_guard lock(guard);
+                if (auto found = cache.find(msgid); found != cache.end()) return found->second;
+
+                const char* text = gettext(msgid);
+                dropped = text != msgid && !fits(text, args);
+                translation& slot = cache[msgid];
+                slot.native = text == msgid || dropped;
+                slot.text = dropped ? msgid : text;
+                t = &slot;
+            }
+            if (dropped)
+                msg::warn("the translation of '{}' doesn't match its arguments, using the original", msgid);
+            return *t;
+        }
+
+        void reject(const char* msgid) {
+            {
+                // the text stays put for whoever is reading it right now
+                std::lock_guard lock(guard);
+                if (cache.at(msgid).native.exchange(true)) return;
+            }
+            msg::warn("the translation of '{}' doesn't match its arguments, using the original", msgid);
+        }
+
+    }; // END detail
+}; // END msg
@@ -3,7 +3,11 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstddef>
 #include <format>
+#include <iterator>
+#include <stdexcept>
 #include <string>
 #include <iostream>
 #include <string_view>
@@ -18,116 +22,127 @@ namespace fg = fmt::fg;
 
 using util::verbose;
 
+// each message is handed to the stream as one string, so lines from
+// concurrent workers don't interleave
 namespace msg {
+    namespace detail {
+        // what the catalog has for a message; `native` when that's the original,
+        // so the format checked at compile time can be used as is
+        struct translation {
+            std::string text;
+            std::atomic<bool> native;
+        };
+
+        // looked up once per message and checked against how many arguments it
+        // is given; a translation that doesn't fit is dropped for the original
+        const translation& translate(const char* msgid, std::size_t args);
+        // whether `text` only refers to arguments below `args`, and numbers
+        // them either automatically or manually throughout
+        bool fits(std::string_view text, std::size_t args);
+        // for a translation that still failed to format, e.g. over a format spec;
+        // the original is used from then on
+        void reject(const char* msgid);
+
+        inline const std::string& label(const char* msgid) {
+            return translate(msgid, 0).text;
+        }
+
+        template <typename... Args>
+        std::string line(std::string prefix, std::format_string<Args...> msg, Args&&... args) {
+            const char* msgid = msg.get().data();
+            const translation& t = translate(msgid, sizeof...(Args));
+            if (!t.native) {
+                try {
+                    std::string out = prefix;
+                    std::vformat_to(std::back_inserter(out), t.text, std::make_format_args(args...));
+                    out += '\n';
+                    return out;
+                } catch (const std::format_error&) {
+                    reject(msgid);
+                }
+            }
+            std::format_to(std::back_inserter(prefix), msg, std::forward<Args>(args)...);
+            prefix += '\n';
+            return prefix;
+        }
+    }; // END detail
+
     template <typename... Args>
-    void pretty(std::string_view msg, Args&&... fmt) {
+    void pretty(std::format_string<Args...> msg, Args&&... fmt) {
         if (gconf::loglevel == verbose::quiet) return;
-        std::string translated = _(msg.data());
-        std::string message = std::vformat(translated, std::make_format_args(fmt...));
-        std::cout
-        << fg::magenta(">>>")
-        << " "
-        << message
-        << "\n";
+        std::cout << detail::line(std::format("{} ", fg::magenta(">>>")), msg, std::forward<Args>(fmt)...);
     }
     
     template <typename... Args>
-    void error(std::string_view msg, Args&&... fmt) {
-        std::string translated = _(msg.data());
-        std::string message = std::vformat(translated, std::make_format_args(fmt...));
-        std::cout
-        << fg::red(_("error"))
-        << ": "
-        << message
-        << "\n";
+    void error(std::format_string<Args...> msg, Args&&... fmt) {
+        std::cout << detail::line(std::format("{}: ", fg::red(detail::label("error"))), msg, std::forward<Args>(fmt)...);
     }
     
     template <typename... Args>
-    void info(std::string_view msg, Args&&... fmt) {
+    void info(std::format_string<Args...> msg, Args&&... fmt) {
         if (gconf::loglevel == verbose::quiet) return;
-        std::string translated = _(msg.data());
-        std::string message = std::vformat(translated, std::make_format_args(fmt...));
-        std::cout
-        << fg::blue(_("info"))
-        << ": "
-        << message
-        << "\n";
+        std::cout << detail::line(std::format("{}: ", fg::blue(detail::label("info"))), msg, std::forward<Args>(fmt)...);
     }
     
     template <typename... Args>
-    void warn(std::string_view msg, Args&&... fmt) {
+    void warn(std::format_string<Args...> msg, Args&&... fmt) {
         if (gconf::loglevel == verbose::quiet) return;
         if (gconf::loglevel <= verbose::normal) return;
-        std::string translated = _(msg.data());
-        std::string message = std::vformat(translated, std::make_format_args(fmt...));
-        std::cout
-        << fg::yellow(_("warn"))
-        << ": "
-        << message
-        << "\n";
+        std::cout << detail::line(std::format("{}: ", fg::yellow(detail::label("warn"))), msg, std::forward<Args>(fmt)...);
     }
     
     template <typename... Args>
-    void warnextra(std::string_view msg, Args&&... fmt) {
+    void warnextra(std::format_string<Args...> msg, Args&&... fmt) {
         if (gconf::loglevel == verbose::quiet) return;
         if (gconf::loglevel <= verbose::info) return;
-        std::string translated = _(msg.data());
-        std::string message = std::vformat(translated, std::make_format_args(fmt...));
-        std::cout
-        << fg::yellow(_("warn"))
-        << ": "
-        << message
-        << "\n";
+        std::cout << detail::line(std::format("{}: ", fg::yellow(detail::label("warn"))), msg, std::forward<Args>(fmt)...);
     }
     
     template <typename... Args>
-    void extra(std::string_view msg, Args&&... fmt) {
+    void extra(std::format_string<Args...> msg, Args&&... fmt) {
         if (gconf::loglevel == verbose::quiet) return;
         if (gconf::loglevel < verbose::debug) return;
-        std::string translated = _(msg.data());
-        std::string message = std::vformat(translated, std::make_format_args(fmt...));
-        std::cout
-        << fg::cyan(_("debug"))
-        << ": "
-        << message
-        << "\n";
+        std::cout << detail::line(std::format("{}: ", fg::cyan(detail::label("debug"))), msg, std::forward<Args>(fmt)...);
     }
     
     template <typename... Args>
-    void debug(std::string_view msg, Args&&... fmt) {
+    void debug(std::format_string<Args...> msg, Args&&... fmt) {
         if (gconf::loglevel == verbose::quiet) return;
         if (gconf::loglevel < verbose::debug) return;
-        std::string translated = _(msg.data());
-        std::string message = std::vformat(translated, std::make_format_args(fmt...));
-        std::cout
-        << fg::cyan(_("debug"))
-        << ": "
-        << message
-        << "\n";
+        std::cout << detail::line(std::format("{}: ", fg::cyan(detail::label("debug"))), msg, std::forward<Args>(fmt)...);
     }
     
     template <typename... Args>
-    void trace(std::string_view msg, Args&&... fmt) {
+    void trace(std::format_string<Args...> msg, Args&&... fmt) {
         if (gconf::loglevel == verbose::quiet) return;
         if (gconf::loglevel < verbose::trace) return;
-        std::string translated = _(msg.data());
-        std::string message = std::vformat(translated, std::make_format_args(fmt...));
-        std::cout
-        << fg::cyan(_("trace"))
-        << ": "
-        << message
-        << "\n";
+        std::cout << detail::line(std::format("{}: ", fg::cyan(detail::label("trace"))), msg, std::forward<Args>(fmt)...);
     }
     
+    // what fatal() throws instead of exiting while a `recoverable` is alive on
+    // the same thread; for commands that keep running on what they had before
+    struct failure : std::runtime_error {
+        using std::runtime_error::runtime_error;
+    };
+
+    namespace detail {
+        inline thread_local int recovering = 0;
+    }; // END detail
+
+    class recoverable {
+    public:
+        recoverable() { detail::recovering++; }
+        ~recoverable() { detail::recovering--; }
+        recoverable(const recoverable&) = delete;
+        recoverable& operator=(const recoverable&) = delete;
+    };
+
     template <typename... Args>
-    [[noreturn]] void fatal(std::string_view msg, Args&&... fmt) {
-        std::string translated = _(msg.data());
-        std::string message = std::vformat(translated, std::make_format_args(fmt...));
-        std::cerr
-        << fg::red(_("fatal"))
-        << ": "
-        << message
-        << std::endl;
+    [[noreturn]] void fatal(std::format_string<Args...> msg, Args&&... fmt) {
+        std::string text = detail::line(std::string(), msg, std::forward<Args>(fmt)...);
+        text.pop_back();
+        if (detail::recovering > 0) throw failure(text);
+        std::cerr << std::format("{}: {}\n", fg::red(detail::label("fatal")), text) << std::flush;
         std::exit(1);
     }
     
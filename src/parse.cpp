@@ -12,6 +12,9 @@
 #include "i18n.hpp"
 #include "util.hpp"
 #include "parse.hpp"
+#include "variables.hpp"
+#include "fmt.hpp"
+#include "msg.hpp"
 
 namespace fs = std::filesystem;
 
@@ -49,6 +52,102 @@ namespace ucl {
             
             return input;
         }
+        
+        struct replacer : ucl::variable_replacer {
+            variables::resolver& vars;
+            explicit replacer(variables::resolver& vars) : vars(vars) {}
+            bool is_variable(const std::string& name) const override { return vars.lookup(name).has_value(); }
+            std::string replace(const std::string& name) const override { return vars.lookup(name).value_or(""); }
+        };
+
+        // hand the entries of the variables {} block to `vars`; true if one of
+        // them was already asked for, so the text has to be read again
+        static bool define(const ucl::Ucl& input, variables::resolver& vars, std::string& errorstr) {
+            const ucl::Ucl block = input.lookup("variables");
+            if (block.type() == UCL_NULL) return false;
+            if (block.type() != UCL_OBJECT) {
+                errorstr = _("variables must be an object");
+                return false;
+            }
+
+            bool again = false;
+            for (const auto& n : block) {
+                variables::definition d;
+                switch (n.type()) {
+                    case UCL_STRING:
+                        d.text = n.string_value();
+                        break;
+                    case UCL_INT:
+                        d.text = std::to_string(n.int_value());
+                        break;
+                    case UCL_FLOAT:
+                    case UCL_BOOLEAN:
+                        d.text = n.forced_string_value();
+                        break;
+                    case UCL_OBJECT:
+                        if (n.lookup("file").type() == UCL_STRING) {
+                            d.how = variables::kind::file;
+                            d.text = n.lookup("file").string_value();
+                        } else if (n.lookup("command").type() == UCL_STRING) {
+                            d.how = variables::kind::command;
+                            d.text = n.lookup("command").string_value();
+                        } else {
+                            errorstr = _("variable ") + n.key() + _(" needs a file or command string");
+                            return false;
+                        }
+                        break;
+                    default:
+                        errorstr = _("variable ") + n.key() + _(" must be a string, number, boolean or object");
+                        return false;
+                }
+                if (!vars.define(n.key(), std::move(d))) {
+                    msg::warn("variable {} is built in and can't be redefined, ignoring it", fmt::bolden(n.key()));
+                    continue;
+                }
+                if (vars.missed(n.key())) again = true;
+            }
+            return again;
+        }
+
+        static bool read(std::string_view path, variables::resolver& vars, ucl::Ucl& input, std::string& errorstr) {
+            std::ifstream handle = std::ifstream(fs::path(path));
+            
+            if (!handle.is_open()) {
+                errorstr = _("failed to open file at ") + std::string(path);
+                return false;
+            }
+            
+            std::stringstream buffer;
+            buffer << handle.rdbuf();
+            handle.close();
+
+            // nothing is worked out before it is used, so the block's own
+            // variables only cost a second pass when something used them
+            replacer r(vars);
+            input = ucl::Ucl::parse(buffer.str(), r, errorstr, UCL_DUPLICATE_APPEND);
+            if (!errorstr.empty()) return false;
+            if (define(input, vars, errorstr))
+                input = ucl::Ucl::parse(buffer.str(), r, errorstr, UCL_DUPLICATE_APPEND);
+            if (errorstr.empty() && !vars.failure().empty()) errorstr = vars.failure();
+            return errorstr.empty();
+        }
+
+        ucl::Ucl file(std::string_view path, variables::resolver& vars) {
+            // through msg::fatal, so a reload can survive the file changing again under it
+            if (!fs::exists(path))
+                msg::fatal("file at {} does not exist", path);
+
+            ucl::Ucl input;
+            std::string errorstr;
+            if (!read(path, vars, input, errorstr))
+                msg::fatal("failed while parsing {}\n{}", path, errorstr);
+            return input;
+        }
+
+        bool valid(std::string_view path, variables::resolver& vars, std::string& errorstr) {
+            ucl::Ucl input;
+            return read(path, vars, input, errorstr);
+        }
     }; // END parsing
     
     namespace get {
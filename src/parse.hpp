@@ -9,6 +9,7 @@
 #include <ucl++.h>
 #include <ucl.h>
 
+#include "variables.hpp"
 
 using std::optional;
 
@@ -47,6 +48,12 @@ namespace ucl {
     
     namespace parsing {
         ucl::Ucl file(std::string_view path, const std::map<std::string, std::string>& vars);
+        // the same, asking `vars` for each ${name} as it comes up; names defined
+        // by the file's own variables {} block are handed to `vars` too
+        ucl::Ucl file(std::string_view path, variables::resolver& vars);
+        // like file(), but reports problems instead of exiting; used where a
+        // broken config must not take the whole process down
+        bool valid(std::string_view path, variables::resolver& vars, std::string& errorstr);
     };
 
     namespace get {
@@ -0,0 +1,344 @@
+// SPDX-FileCopyrightText: 2026 Will Reed <wreed@disroot.org>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "scan.hpp"
+#include "util.hpp"
+#include "xdg.hpp"
+
+namespace fs = std::filesystem;
+
+using std::string;
+using std::vector;
+using sview = std::string_view;
+
+namespace scan {
+
+    // the kernel's record; d_name runs on for the rest of d_reclen
+    struct rawdirent {
+        std::uint64_t d_ino;
+        std::int64_t d_off;
+        unsigned short d_reclen;
+        unsigned char d_type;
+        char d_name[1];
+    };
+
+    bool entries(int fd, const std::function<void(sview name, unsigned char type, std::uint64_t ino)>& each) {
+        alignas(rawdirent) char buf[32 * 1024];
+        for (;;) {
+            long n = syscall(SYS_getdents64, fd, buf, sizeof(buf));
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0) return false;
+            if (n == 0) return true;
+            for (long pos = 0; pos < n;) {
+                const auto* d = reinterpret_cast<const rawdirent*>(buf + pos);
+                sview name(buf + pos + offsetof(rawdirent, d_name));
+                if (name != "." && name != "..") each(name, d->d_type, d->d_ino);
+                pos += d->d_reclen;
+            }
+        }
+    }
+
+    struct node {
+        fs::file_type type;
+        std::uint64_t ino;
+    };
+
+    // paths are relative to the root, "" being the root itself; a directory that
+    // couldn't be read, and .git, are `unknown`: nothing is known about what's in them
+    struct snapshot {
+        fs::path root;
+        std::unordered_map<string, node> nodes;
+        vector<std::pair<string, std::uint64_t>> dirs;
+    };
+
+    // taken before any lookups and only read after
+    static snapshot current;
+    static bool walked = false;
+
+    fs::file_type dtype(unsigned char type) {
+        switch (type) {
+            case DT_REG:  return fs::file_type::regular;
+            case DT_DIR:  return fs::file_type::directory;
+            case DT_LNK:  return fs::file_type::symlink;
+            case DT_BLK:  return fs::file_type::block;
+            case DT_CHR:  return fs::file_type::character;
+            case DT_FIFO: return fs::file_type::fifo;
+            case DT_SOCK: return fs::file_type::socket;
+            default:      return fs::file_type::unknown;
+        }
+    }
+
+    static fs::file_type convert(const struct stat& st) {
+        if (S_ISREG(st.st_mode)) return fs::file_type::regular;
+        if (S_ISDIR(st.st_mode)) return fs::file_type::directory;
+        if (S_ISLNK(st.st_mode)) return fs::file_type::symlink;
+        if (S_ISBLK(st.st_mode)) return fs::file_type::block;
+        if (S_ISCHR(st.st_mode)) return fs::file_type::character;
+        if (S_ISFIFO(st.st_mode)) return fs::file_type::fifo;
+        if (S_ISSOCK(st.st_mode)) return fs::file_type::socket;
+        return fs::file_type::unknown;
+    }
+
+    static std::uint64_t mtime(const struct stat& st) {
+        return std::uint64_t(st.st_mtim.tv_sec) * 1000000000ULL + std::uint64_t(st.st_mtim.tv_nsec);
+    }
+
+    static snapshot walk(const fs::path& root, unsigned jobs) {
+        std::mutex lock;
+        std::condition_variable wake;
+        std::deque<string> todo{""};
+        std::size_t busy = 0;
+
+        // each worker keeps what it finds to itself until the end
+        struct found {
+            vector<std::pair<string, node>> nodes;
+            vector<std::pair<string, std::uint64_t>> dirs;
+            // directories that couldn't be read, whoever found them in their parent
+            vector<string> unreadable;
+        };
+        vector<found> parts(jobs);
+
+        {
+            vector<std::jthread> pool;
+            pool.reserve(jobs);
+            for (unsigned w = 0; w < jobs; w++) {
+                pool.emplace_back([&, w] {
+                    found& mine = parts[w];
+                    std::unique_lock held(lock);
+                    for (;;) {
+                        wake.wait(held, [&] { return !todo.empty() || busy == 0; });
+                        if (todo.empty()) return;
+                        string rel = std::move(todo.front());
+                        todo.pop_front();
+                        busy++;
+                        held.unlock();
+
+                        vector<string> subdirs;
+                        fs::path dir = rel.empty() ? root : root / rel;
+                        int fd = open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+                        struct stat st;
+                        bool read = fd >= 0 && fstat(fd, &st) == 0;
+                        read = read && entries(fd, [&](sview name, unsigned char type, std::uint64_t ino) {
+                            string child = rel.empty() ? string(name) : rel + '/' + string(name);
+                            fs::file_type t = dtype(type);
+                            struct stat cst;
+                            if (type == DT_UNKNOWN && fstatat(fd, name.data(), &cst, AT_SYMLINK_NOFOLLOW) == 0)
+                                t = convert(cst);
+                            if (name == ".git") t = fs::file_type::unknown;
+                            if (t == fs::file_type::directory) subdirs.push_back(child);
+                            mine.nodes.emplace_back(std::move(child), node{t, ino});
+                        });
+                        if (read) mine.dirs.emplace_back(rel, mtime(st));
+                        else mine.unreadable.push_back(rel);
+                        if (fd >= 0) close(fd);
+
+                        held.lock();
+                        for (auto& s : subdirs) todo.push_back(std::move(s));
+                        busy--;
+                        wake.notify_all();
+                    }
+                });
+            }
+        }
+
+        snapshot out;
+        out.root = root;
+        out.nodes.emplace("", node{fs::file_type::directory, 0});
+        for (auto& part : parts) {
+            for (auto& [rel, n] : part.nodes) out.nodes.insert_or_assign(std::move(rel), n);
+            for (auto& d : part.dirs) out.dirs.push_back(std::move(d));
+        }
+        // the parent's record of an unreadable directory may be in any part, so
+        // these go last; lookups below them fall back to stat()
+        for (auto& part : parts) {
+            for (auto& rel : part.unreadable) out.nodes.insert_or_assign(std::move(rel), node{fs::file_type::unknown, 0});
+        }
+        return out;
+    }
+
+    static fs::path location(const fs::path& root) {
+        return xdg::homes().at("XDG_STATE_HOME") / "confidant" / std::format("{}.tree", util::configkey(root.native()));
+    }
+
+    static void save(const snapshot& s) {
+        string out = std::format("confidant-tree 1\n{}\n", s.root.native());
+        for (const auto& [rel, mt] : s.dirs) {
+            if (rel.find('\n') != string::npos) return;
+            out += std::format("d {:x} {}\n", mt, rel);
+        }
+        for (const auto& [rel, n] : s.nodes) {
+            if (rel.find('\n') != string::npos) return;
+            out += std::format("n {} {:x} {}\n", static_cast<int>(n.type), n.ino, rel);
+        }
+
+        std::error_code ec;
+        fs::path path;
+        try {
+            path = location(s.root);
+        } catch (...) {
+            return;
+        }
+        fs::create_directories(path.parent_path(), ec);
+        fs::path tmp = path;
+        tmp += std::format(".{}", getpid());
+        {
+            std::ofstream file(tmp, std::ios::trunc | std::ios::binary);
+            file.write(out.data(), out.size());
+            if (!file) {
+                fs::remove(tmp, ec);
+                return;
+            }
+        }
+        fs::rename(tmp, path, ec);
+    }
+
+    template <typename T>
+    static bool number(sview& line, T& out, int base) {
+        auto [p, ec] = std::from_chars(line.data(), line.data() + line.size(), out, base);
+        if (ec != std::errc() || p == line.data() + line.size() || *p != ' ') return false;
+        line.remove_prefix(p - line.data() + 1);
+        return true;
+    }
+
+    // the last snapshot of `root`, if no directory in it has changed since
+    static bool restore(const fs::path& root, snapshot& s) {
+        std::ifstream file;
+        try {
+            file.open(location(root), std::ios::binary);
+        } catch (...) {
+            return false;
+        }
+        string line;
+        if (!std::getline(file, line) || line != "confidant-tree 1") return false;
+        if (!std::getline(file, line) || line != root.native()) return false;
+
+        s.root = root;
+        while (std::getline(file, line)) {
+            sview rest = line;
+            if (rest.starts_with("d ")) {
+                rest.remove_prefix(2);
+                std::uint64_t mt;
+                if (!number(rest, mt, 16)) return false;
+                // one stat per directory instead of reading them all
+                struct stat st;
+                fs::path dir = rest.empty() ? root : root / rest;
+                if (stat(dir.c_str(), &st) != 0 || !S_ISDIR(st.st_mode) || mtime(st) != mt) return false;
+                s.dirs.emplace_back(rest, mt);
+            } else if (rest.starts_with("n ")) {
+                rest.remove_prefix(2);
+                int type;
+                std::uint64_t ino;
+                if (!number(rest, type, 10) || !number(rest, ino, 16)) return false;
+                s.nodes.insert_or_assign(string(rest), node{static_cast<fs::file_type>(type), ino});
+            } else {
+                return false;
+            }
+        }
+        return !s.dirs.empty();
+    }
+
+    void warm(const fs::path& root, unsigned jobs) {
+        std::error_code ec;
+        fs::path top = fs::absolute(root, ec).lexically_normal();
+        if (ec) return;
+        // "repo/" normalizes with a trailing slash
+        if (!top.has_filename()) top = top.parent_path();
+
+        snapshot s;
+        if (!restore(top, s)) {
+            if (jobs == 0) jobs = std::max(1u, std::thread::hardware_concurrency());
+            s = walk(top, jobs);
+            save(s);
+        }
+        current = std::move(s);
+        walked = true;
+    }
+
+    // `path` relative to the walked root, or nullopt when it's elsewhere
+    static std::optional<string> keyof(const fs::path& path) {
+        if (!walked) return std::nullopt;
+        std::error_code ec;
+        fs::path rel = fs::absolute(path, ec).lexically_normal().lexically_relative(current.root);
+        if (ec || rel.empty() || *rel.begin() == "..") return std::nullopt;
+        string key = rel.native();
+        if (key == ".") return string();
+        while (key.ends_with('/')) key.pop_back();
+        return key;
+    }
+
+    std::optional<fs::file_type> type(const fs::path& path) {
+        std::optional<string> key = keyof(path);
+        if (!key) return std::nullopt;
+
+        if (auto it = current.nodes.find(*key); it != current.nodes.end()) {
+            if (it->second.type == fs::file_type::unknown) return std::nullopt;
+            return it->second.type;
+        }
+        // missing, as long as the closest thing above it was walked into
+        string up = *key;
+        for (;;) {
+            std::size_t slash = up.rfind('/');
+            up = slash == string::npos ? string() : up.substr(0, slash);
+            auto it = current.nodes.find(up);
+            if (it != current.nodes.end()) {
+                if (it->second.type == fs::file_type::directory) return fs::file_type::not_found;
+                return std::nullopt;
+            }
+            if (up.empty()) return std::nullopt;
+        }
+    }
+
+    std::optional<vector<string>> list(const fs::path& dir) {
+        std::optional<string> key = keyof(dir);
+        if (!key) return std::nullopt;
+        auto it = current.nodes.find(*key);
+        if (it == current.nodes.end() || it->second.type != fs::file_type::directory) return std::nullopt;
+
+        vector<string> names;
+        string prefix = key->empty() ? string() : *key + '/';
+        for (const auto& [rel, n] : current.nodes) {
+            if (rel.empty() || !rel.starts_with(prefix)) continue;
+            sview name = sview(rel).substr(prefix.size());
+            if (name.find('/') == sview::npos) names.emplace_back(name);
+        }
+        std::sort(names.begin(), names.end());
+        return names;
+    }
+
+    fs::file_status status(const fs::path& path, std::error_code& ec) {
+        std::optional<fs::file_type> t = type(path);
+        // a symlink is followed the usual way
+        if (!t || t == fs::file_type::symlink) return fs::status(path, ec);
+        if (t == fs::file_type::not_found) {
+            ec = std::make_error_code(std::errc::no_such_file_or_directory);
+            return fs::file_status(fs::file_type::not_found);
+        }
+        ec.clear();
+        return fs::file_status(*t);
+    }
+
+}; // END scan
@@ -0,0 +1,38 @@
+// SPDX-FileCopyrightText: 2026 Will Reed <wreed@disroot.org>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// what is in the repository, from one parallel walk of it instead of a path
+// lookup per source; a snapshot is kept in $XDG_STATE_HOME/confidant/<root
+// key>.tree and reused for as long as none of the directories' mtimes change
+namespace scan {
+
+    // every entry of an open directory, straight from getdents64(2); `type` is
+    // a DT_* value and may be DT_UNKNOWN on filesystems that don't fill it in
+    bool entries(int fd, const std::function<void(std::string_view name, unsigned char type, std::uint64_t ino)>& each);
+    // a DT_* value as a file type; unknown for DT_UNKNOWN
+    std::filesystem::file_type dtype(unsigned char type);
+
+    // walk `root` (skipping .git), up to `jobs` directories at a time (0 for one
+    // per processor); later lookups under it are answered from the walk
+    void warm(const std::filesystem::path& root, unsigned jobs = 0);
+    // what the walk found at `path`, not_found included; nullopt when the path
+    // isn't under the walked root, or goes through a symlink, and has to be
+    // looked up the usual way. a symlink itself is reported as one
+    std::optional<std::filesystem::file_type> type(const std::filesystem::path& path);
+    // names directly inside the directory `dir`, sorted, e.g. for expanding globs
+    std::optional<std::vector<std::string>> list(const std::filesystem::path& dir);
+
+    // fs::status() for sources, from the walk where it can be
+    std::filesystem::file_status status(const std::filesystem::path& path, std::error_code& ec);
+
+}; // END scan
@@ -19,10 +19,15 @@ inline bool usecolor = []() {
 namespace confidant {
     namespace config {
         namespace global {
+            // what to do when a destination is taken by something else
+            enum class conflict { skip, backup, force };
+
             struct settings {
                 bool color = true;
                 bool createdirs = true;
                 util::verbose loglevel = util::verbose::normal;
+                // only ever set from the command line
+                conflict conflicts = conflict::skip;
             };
             
             inline bool color = true;
@@ -1,10 +1,20 @@
 // SPDX-FileCopyrightText: 2026 Will Reed <wreed@disroot.org>
 // SPDX-License-Identifier: GPL-3.0-or-later
 
+#include <algorithm>
 #include <filesystem>
+#include <span>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 #include "util.hpp"
 #include "parse.hpp"
+#include "graph.hpp"
+#include "facts.hpp"
 
 #include "fmt.hpp"
 #include "msg.hpp"
@@ -19,13 +29,271 @@ namespace confidant {
         
         namespace local {
             
+            std::string_view literal(linktype t) {
+                switch (t) {
+                    case linktype::directory: return "directory";
+                    case linktype::file:      return "file";
+                    case linktype::copy:      return "copy";
+                    case linktype::hardlink:  return "hardlink";
+                }
+                std::unreachable();
+            }
+            
+            void lists::add(std::span<const std::string_view> names) {
+                runs.push_back({static_cast<std::uint32_t>(all.size()), static_cast<std::uint32_t>(names.size())});
+                all.insert(all.end(), names.begin(), names.end());
+            }
+            
+            void linktable::reserve(std::size_t n) {
+                name.reserve(n);
+                tag.reserve(n);
+                source.reserve(n);
+                destination.reserve(n);
+                type.reserve(n);
+                onchange.reserve(n);
+                after.reserve(n);
+                needs.reserve(n);
+            }
+            
+            void linktable::push_back(const link& l) {
+                name.push_back(l.name);
+                tag.push_back(l.tag);
+                source.push_back(l.source);
+                destination.push_back(l.destination);
+                type.push_back(l.type);
+                onchange.add(l.onchange);
+                after.add(l.after);
+                needs.add(l.needs);
+            }
+            
+            link linktable::operator[](std::size_t i) const {
+                return {name[i], tag[i], source[i], destination[i], type[i], onchange[i], after[i], needs[i]};
+            }
+            
+            link linktable::at(std::size_t i) const {
+                if (i >= size()) throw std::out_of_range("linktable::at");
+                return (*this)[i];
+            }
+            
+            void templatetable::reserve(std::size_t n) {
+                name.reserve(n);
+                tag.reserve(n);
+                source.reserve(n);
+                destination.reserve(n);
+                items.reserve(n);
+                onchange.reserve(n);
+                after.reserve(n);
+                needs.reserve(n);
+            }
+            
+            void templatetable::push_back(const templatelink& t) {
+                name.push_back(t.name);
+                tag.push_back(t.tag);
+                source.push_back(t.source);
+                destination.push_back(t.destination);
+                items.add(t.items);
+                onchange.add(t.onchange);
+                after.add(t.after);
+                needs.add(t.needs);
+            }
+            
+            templatelink templatetable::operator[](std::size_t i) const {
+                return {name[i], tag[i], source[i], destination[i], items[i], onchange[i], after[i], needs[i]};
+            }
+            
+            templatelink templatetable::at(std::size_t i) const {
+                if (i >= size()) throw std::out_of_range("templatetable::at");
+                return (*this)[i];
+            }
+            
+            // a field holding either one name or a list of them
+            static std::vector<std::string_view> names(settings& conf, const ucl::Ucl& obj, std::string_view field, std::string_view owner) {
+                std::vector<std::string_view> out;
+                if (!ucl::check(obj, field)) return out;
+                ucl::Ucl n = obj[std::string(field)];
+                if (n.type() == ucl::String) {
+                    out.push_back(conf.intern(n.string_value()));
+                } else if (n.type() == ucl::Array) {
+                    out.reserve(n.size());
+                    for (const auto& item : n) {
+                        if (item.type() != ucl::String)
+                            msg::fatal("{} field {} may only hold strings!", fmt::bolden(owner), fmt::ital(field));
+                        out.push_back(conf.intern(item.string_value()));
+                    }
+                } else {
+                    msg::fatal("{} field {} is neither a string nor a list!", fmt::bolden(owner), fmt::ital(field));
+                }
+                return out;
+            }
+            
+            // whether the 'when' conditions of `obj` hold here; every field has
+            // to, and a field holding a list is met by any of its values, or for
+            // 'env' and 'exists' only by all of them
+            static bool applies(settings& conf, const ucl::Ucl& obj, std::string_view owner, const facts::table& facts) {
+                if (!ucl::check(obj, "when")) return true;
+                ucl::Ucl when = obj["when"];
+                if (when.type() != ucl::Object)
+                    msg::fatal("{} field {} must be an object!", fmt::bolden(owner), fmt::ital("when"));
+                
+                for (const auto& cond : when) {
+                    std::string key = cond.key();
+                    auto values = names(conf, when, key, owner);
+                    auto any = [&](auto&& test) { return std::ranges::any_of(values, test); };
+                    auto all = [&](auto&& test) { return std::ranges::all_of(values, test); };
+                    bool holds;
+                    if (key == "host") holds = any([&](std::string_view v) { return facts.host(v); });
+                    else if (key == "os") holds = any([&](std::string_view v) { return facts.os(v); });
+                    else if (key == "arch") holds = any([&](std::string_view v) { return facts.arch(v); });
+                    else if (key == "env") holds = all([&](std::string_view v) { return facts.env(v); });
+                    else if (key == "exists") holds = all([&](std::string_view v) { return facts.exists(v); });
+                    else {
+                        msg::fatal("{} condition {} is not recognized, expected one of {}, {}, {}, {} or {}",
+                            fmt::bolden(owner), fmt::ital(key), fmt::bolden("host"), fmt::bolden("os"),
+                            fmt::bolden("arch"), fmt::bolden("env"), fmt::bolden("exists"));
+                    }
+                    if (!holds) return false;
+                }
+                return true;
+            }
+            
+            // entries whose conditions didn't hold are gone; so are the entries
+            // requiring them, and what remains no longer comes after them
+            static void prune(settings& conf, std::unordered_set<std::string_view> dropped) {
+                for (const auto& l : conf.links) dropped.erase(l.name);
+                for (const auto& t : conf.templates) dropped.erase(t.name);
+                if (dropped.empty()) return;
+                
+                std::vector<bool> links(conf.links.size(), true), templates(conf.templates.size(), true);
+                auto needsdropped = [&](std::span<const std::string_view> needs) {
+                    return std::ranges::any_of(needs, [&](std::string_view n) { return dropped.contains(n); });
+                };
+                // dropping one entry may leave a name nothing else has, and so on
+                for (bool changed = true; changed;) {
+                    changed = false;
+                    std::unordered_set<std::string_view> losing;
+                    for (size_t i = 0; i < conf.links.size(); i++) {
+                        if (links[i] && needsdropped(conf.links.needs[i])) {
+                            links[i] = false;
+                            losing.insert(conf.links.name[i]);
+                        }
+                    }
+                    for (size_t i = 0; i < conf.templates.size(); i++) {
+                        if (templates[i] && needsdropped(conf.templates.needs[i])) {
+                            templates[i] = false;
+                            losing.insert(conf.templates.name[i]);
+                        }
+                    }
+                    for (size_t i = 0; i < conf.links.size(); i++) if (links[i]) losing.erase(conf.links.name[i]);
+                    for (size_t i = 0; i < conf.templates.size(); i++) if (templates[i]) losing.erase(conf.templates.name[i]);
+                    for (auto name : losing) changed |= dropped.insert(name).second;
+                }
+                
+                auto kept = [&](std::span<const std::string_view> names) {
+                    std::vector<std::string_view> out;
+                    for (auto n : names) if (!dropped.contains(n)) out.push_back(n);
+                    return out;
+                };
+                linktable ls;
+                ls.reserve(conf.links.size());
+                for (size_t i = 0; i < conf.links.size(); i++) {
+                    if (!links[i]) continue;
+                    link l = conf.links[i];
+                    auto after = kept(l.after);
+                    l.after = after;
+                    ls.push_back(l);
+                }
+                templatetable ts;
+                ts.reserve(conf.templates.size());
+                for (size_t i = 0; i < conf.templates.size(); i++) {
+                    if (!templates[i]) continue;
+                    templatelink t = conf.templates[i];
+                    auto after = kept(t.after);
+                    t.after = after;
+                    ts.push_back(t);
+                }
+                conf.links = std::move(ls);
+                conf.templates = std::move(ts);
+            }
+            
+            // every hook named has to exist, and 'after' mustn't loop
+            static void checkhooks(const settings& conf) {
+                std::unordered_map<std::string_view, size_t> index;
+                for (size_t i = 0; i < conf.hooks.size(); i++) index.emplace(conf.hooks[i].name, i);
+                
+                auto known = [&](std::string_view owner, const auto& hooks) {
+                    for (const auto& h : hooks)
+                        if (!index.contains(h))
+                            msg::fatal("{} refers to hook {}, which isn't defined!", fmt::bolden(owner), fmt::bolden(h));
+                };
+                for (const auto& l : conf.links) known(l.name, l.onchange);
+                for (const auto& t : conf.templates) known(t.name, t.onchange);
+                
+                graph::edges before(conf.hooks.size());
+                for (size_t i = 0; i < conf.hooks.size(); i++) {
+                    known(conf.hooks[i].name, conf.hooks[i].after);
+                    for (const auto& a : conf.hooks[i].after) before[i].push_back(index.at(a));
+                }
+                auto sorted = graph::sort(before);
+                if (!sorted.cycle.empty()) {
+                    std::string loop;
+                    for (size_t i : sorted.cycle) loop += conf.hooks[i].name + " -> ";
+                    loop += conf.hooks[sorted.cycle.front()].name;
+                    msg::fatal("hooks can't run after one another in a circle: {}", fmt::bolden(loop));
+                }
+            }
+
+            // links and templates may only come after each other, and not in a circle
+            static void checkorder(const settings& conf) {
+                // a link and a template of the same name are one node
+                std::unordered_map<std::string_view, size_t> index;
+                std::vector<std::string_view> nodes;
+                auto node = [&](std::string_view name) {
+                    auto [it, added] = index.emplace(name, nodes.size());
+                    if (added) nodes.push_back(name);
+                    return it->second;
+                };
+                for (const auto& l : conf.links) node(l.name);
+                for (const auto& t : conf.templates) node(t.name);
+                
+                graph::edges before(nodes.size());
+                auto add = [&](std::string_view owner, std::span<const std::string_view> names) {
+                    for (const auto& name : names) {
+                        auto it = index.find(name);
+                        if (it == index.end())
+                            msg::fatal("{} has to come after {}, which is neither a link nor a template!",
+                                fmt::bolden(owner), fmt::bolden(name));
+                        before[index.at(owner)].push_back(it->second);
+                    }
+                };
+                for (const auto& l : conf.links) { add(l.name, l.after); add(l.name, l.needs); }
+                for (const auto& t : conf.templates) { add(t.name, t.after); add(t.name, t.needs); }
+                
+                auto sorted = graph::sort(before);
+                if (!sorted.cycle.empty()) {
+                    std::string loop;
+                    for (size_t i : sorted.cycle) loop += std::string(nodes[i]) + " -> ";
+                    loop += std::string(nodes[sorted.cycle.front()]);
+                    msg::fatal("entries can't come after one another in a circle: {}", fmt::bolden(loop));
+                }
+            }
+
             confidant::config::local::settings serialize(std::string_view path, const confidant::config::global::settings& globals) {
+                variables::resolver vars(path);
+                return serialize(path, globals, vars);
+            }
+            
+            confidant::config::local::settings serialize(std::string_view path, const confidant::config::global::settings& globals,
+                                                         variables::resolver& vars) {
                 
                 confidant::config::local::settings conf;
              
-                auto vars = util::makevarmap(path);
                 ucl::Ucl input = ucl::parsing::file(path, vars);
                 
+                // conditions are settled here, once, so planning never sees
+                // the entries that don't apply to this machine
+                facts::table facts(vars);
+                std::unordered_set<std::string_view> dropped;
+                
                 // BEGIN serializing
                 
                 // BEGEIN repository
@@ -56,7 +324,12 @@ namespace confidant {
                         for (const auto& n : obj) {
                             confidant::config::local::link link;
                             
-                            link.name = n.key();
+                            link.name = conf.intern(n.key());
+                            if (!applies(conf, n, link.name, facts)) {
+                                msg::debug("conditions of link {} don't hold, skipping", fmt::bolden(link.name));
+                                dropped.insert(link.name);
+                                continue;
+                            }
                             
                             // BEGIN tag
                             if (ucl::check(n, "tag") && n["tag"].type() == ucl::String) {
@@ -65,7 +338,7 @@ namespace confidant {
                                     msg::fatal("failed to parse {} field {} as a string!", fmt::bolden(link.name),
                                                                                            fmt::bolden("tag"));
                                 else
-                                    link.tag = s.value();                                
+                                    link.tag = conf.intern(s.value());
                             }
                             // END tag
                             
@@ -73,7 +346,7 @@ namespace confidant {
                             if (ucl::check(n, "source") && n["source"].type() == ucl::String) {
                                 auto s = ucl::get::str(n, "source");
                                 if (!s) msg::fatal("failed to parse {} field {} as a string!", fmt::bolden(link.name), fmt::bolden("source"));
-                                else link.source = fs::path(s.value());
+                                else link.source = conf.intern(s.value());
                             } else if (ucl::check(n, "source") &&  n["source"].type() != ucl::String) {
                                 msg::fatal("{} field {} must be a string!", fmt::bolden(link.name), fmt::bolden("source"));
                             } else {
@@ -85,12 +358,12 @@ namespace confidant {
                             if (ucl::check(n, "dest")) {
                                 auto s = ucl::get::str(n, "dest");
                                 if (!s) msg::fatal("failed to parse {} field {} as a string!", fmt::bolden(link.name), fmt::bolden("dest"));
-                                else link.destination = fs::path(s.value());
+                                else link.destination = conf.intern(s.value());
                             } else if (ucl::check(n, "destdir")) {
                                 auto s  = ucl::get::str(n, "destdir");
                                 if (!s) msg::fatal("failed to parse {} field {} as a string!", fmt::bolden(link.name), fmt::bolden("destdir"));
-                                std::string bn = link.source.filename().string();    
-                                link.destination = fs::path(std::format("{}/{}", s.value(), bn));
+                                std::string bn = fs::path(link.source).filename().string();
+                                link.destination = conf.intern(std::format("{}/{}", s.value(), bn));
                             } else {
                                 msg::fatal("link {} is missing a {} value!", fmt::bolden(link.name), fmt::bolden("dest/destdir"));
                             }
@@ -104,15 +377,26 @@ namespace confidant {
                                 if (!t) msg::fatal("failed to parse {} field {} as a string!", fmt::bolden(link.name), fmt::bolden("type"));
                                 else if (t.value() == "file") link.type = linktype::file;
                                 else if (t.value() == "directory") link.type = linktype::directory;
+                                else if (t.value() == "copy") link.type = linktype::copy;
+                                else if (t.value() == "hardlink") link.type = linktype::hardlink;
                                 else {
-                                    msg::warn("type {} is not recognized, expected one of {} or {}, using default",
+                                    msg::warn("type {} is not recognized, expected one of {}, {}, {} or {}, using default",
                                         fmt::ital(t.value()),
                                         fmt::bolden("file"),
-                                        fmt::bolden("directory"));
+                                        fmt::bolden("directory"),
+                                        fmt::bolden("copy"),
+                                        fmt::bolden("hardlink"));
                                     link.type = linktype::file;
                                 }
                             }
                             // END type
+                            // the table copies these lists in
+                            auto onchange = names(conf, n, "on-change", link.name);
+                            auto after = names(conf, n, "after", link.name);
+                            auto needs = names(conf, n, "requires", link.name);
+                            link.onchange = onchange;
+                            link.after = after;
+                            link.needs = needs;
                             conf.links.push_back(link);
                         }
                     }
@@ -134,7 +418,12 @@ namespace confidant {
                         for (const auto& tmpl : obj) {
                             confidant::config::local::templatelink t;
                             
-                            t.name = tmpl.key();
+                            t.name = conf.intern(tmpl.key());
+                            if (!applies(conf, tmpl, t.name, facts)) {
+                                msg::debug("conditions of template {} don't hold, skipping", fmt::bolden(t.name));
+                                dropped.insert(t.name);
+                                continue;
+                            }
                             
                             // optional condition tag
                             if (ucl::check(tmpl, "tag") && tmpl["tag"].type() == ucl::String) {
@@ -143,11 +432,11 @@ namespace confidant {
                                     msg::fatal("failed to parse {} field {} as a string!", fmt::bolden(t.name),
                                                                                           fmt::bolden("tag"));
                                 else
-                                    t.tag = s.value();                                
+                                    t.tag = conf.intern(s.value());
                             }
                             
                             if (ucl::check(tmpl, "source")) {
-                                t.source = fs::path(tmpl["source"].string_value());
+                                t.source = conf.intern(tmpl["source"].string_value());
                             
                             } else {
                                 msg::fatal("template {} is missing a {} value!",
@@ -157,7 +446,7 @@ namespace confidant {
                             }
                                 
                             if (ucl::check(tmpl, "dest")) {
-                                t.destination = fs::path(tmpl["dest"].string_value());
+                                t.destination = conf.intern(tmpl["dest"].string_value());
                             
                             } else {
                                 msg::fatal("template {} is missing a {} value!",
@@ -165,20 +454,18 @@ namespace confidant {
                                     fmt::ital("dest"));
                             }
                             
+                            std::vector<std::string_view> items;
                             if (ucl::check(tmpl, "items") && tmpl["items"].type() == ucl::Array) {
                                 // items field exists and is an array (normal, correct)
-                                int numitems = tmpl["items"].size();
-                                t.items.reserve(numitems);
-                                
-                                // iterate over items
-                                for (int i = 0; i < numitems; i++) {
-                                    auto lst = ucl::get::list(tmpl, "items");
-                                    if (!lst) {
-                                        msg::fatal("failed to get {} items field as a list!",
-                                            fmt::bolden(t.name));
-                                    } else {
-                                        t.items.push_back(lst.value().at(i).string_value());
-                                    }
+                                auto lst = ucl::get::list(tmpl, "items");
+                                if (!lst) {
+                                    msg::fatal("failed to get {} items field as a list!",
+                                        fmt::bolden(t.name));
+                                } else {
+                                    items.reserve(lst.value().size());
+                                    // iterate over items
+                                    for (const auto& item : lst.value())
+                                        items.push_back(conf.intern(item.string_value()));
                                 }
                                 
                             } else if (ucl::check(tmpl, "items") && tmpl["items"].type() != ucl::Array) {
@@ -192,12 +479,101 @@ namespace confidant {
                                     fmt::bolden(t.name),
                                     fmt::ital("items"));
                             }
+                            auto onchange = names(conf, tmpl, "on-change", t.name);
+                            auto after = names(conf, tmpl, "after", t.name);
+                            auto needs = names(conf, tmpl, "requires", t.name);
+                            t.items = items;
+                            t.onchange = onchange;
+                            t.after = after;
+                            t.needs = needs;
                             conf.templates.push_back(t);
                             
                         }
                     }
                 }
                 // END templates
+                // BEGIN packages
+                if (!ucl::check(input, "packages")) {
+                    msg::debug("field {} not specified", fmt::bolden("packages"));
+                } else {
+                    auto oobj = ucl::get::node(input, "packages");
+                    if (!oobj) {
+                        msg::fatal("failed to parse {} as a node!", fmt::bolden("packages"));
+                    } else {
+                        ucl::Ucl obj = oobj.value();
+                        conf.packages.reserve(ucl::members(obj));
+                        
+                        for (const auto& pkg : obj) {
+                            confidant::config::local::package p;
+                            
+                            p.name = pkg.key();
+                            if (!applies(conf, pkg, p.name, facts)) {
+                                msg::debug("conditions of package {} don't hold, skipping", fmt::bolden(p.name));
+                                continue;
+                            }
+                            
+                            // optional condition tag
+                            if (ucl::check(pkg, "tag") && pkg["tag"].type() == ucl::String) {
+                                auto s = ucl::get::str(pkg, "tag");
+                                if (!s)
+                                    msg::fatal("failed to parse {} field {} as a string!", fmt::bolden(p.name),
+                                                                                          fmt::bolden("tag"));
+                                else
+                                    p.tag = s.value();
+                            }
+                            
+                            if (ucl::check(pkg, "source") && pkg["source"].type() == ucl::String) {
+                                p.source = fs::path(pkg["source"].string_value());
+                            } else {
+                                msg::fatal("package {} is missing a {} value!",
+                                    fmt::bolden(p.name),
+                                    fmt::ital("source"));
+                            }
+                            
+                            if (ucl::check(pkg, "dest") && pkg["dest"].type() == ucl::String) {
+                                p.destination = fs::path(pkg["dest"].string_value());
+                            } else {
+                                msg::fatal("package {} is missing a {} value!",
+                                    fmt::bolden(p.name),
+                                    fmt::ital("dest"));
+                            }
+                            conf.packages.push_back(p);
+                        }
+                    }
+                }
+                // END packages
+                // BEGIN hooks
+                if (!ucl::check(input, "hooks")) {
+                    msg::debug("field {} not specified", fmt::bolden("hooks"));
+                } else {
+                    auto oobj = ucl::get::node(input, "hooks");
+                    if (!oobj) {
+                        msg::fatal("failed to parse {} as a node!", fmt::bolden("hooks"));
+                    } else {
+                        ucl::Ucl obj = oobj.value();
+                        conf.hooks.reserve(ucl::members(obj));
+                        
+                        for (const auto& h : obj) {
+                            confidant::config::local::hook hook;
+                            
+                            hook.name = h.key();
+                            
+                            if (ucl::check(h, "run") && h["run"].type() == ucl::String) {
+                                hook.run = h["run"].string_value();
+                            } else {
+                                msg::fatal("hook {} is missing a {} value!",
+                                    fmt::bolden(hook.name),
+                                    fmt::ital("run"));
+                            }
+                            for (auto a : names(conf, h, "after", hook.name)) hook.after.emplace_back(a);
+                            conf.hooks.push_back(hook);
+                        }
+                    }
+                }
+                checkhooks(conf);
+                // END hooks
+                prune(conf, std::move(dropped));
+                checkorder(conf);
                 
                 // return configuration
                 return conf;
@@ -4,9 +4,18 @@
 #pragma once
 
 #include "settings/global.hpp"
+#include "arena.hpp"
+#include "variables.hpp"
 
+#include <cstddef>
+#include <cstdint>
 #include <filesystem>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <span>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace fs = std::filesystem;
@@ -17,35 +26,147 @@ namespace confidant {
         
         namespace local {
 
-            enum linktype { directory, file };
+            // copy and hardlink place real files, for programs that won't follow symlinks
+            enum linktype { directory, file, copy, hardlink };
             
             struct repository {
                 std::string url;
             };
             
+            // one link as stored in settings; the strings belong to those settings
             struct link {
-                std::string name;
-                std::string tag;
-                fs::path source;
-                fs::path destination;
-                linktype type;
+                std::string_view name;
+                std::string_view tag;
+                std::string_view source;
+                std::string_view destination;
+                linktype type = linktype::file;
+                // hooks to run when this link had to change
+                std::span<const std::string_view> onchange;
+                // links or templates applied first; 'requires' also skips this
+                // one when they fail
+                std::span<const std::string_view> after;
+                std::span<const std::string_view> needs;
             };
             
             struct templatelink {
+                std::string_view name;
+                std::string_view tag;
+                std::string_view source;
+                std::string_view destination;
+                std::span<const std::string_view> items;
+                std::span<const std::string_view> onchange;
+                std::span<const std::string_view> after;
+                std::span<const std::string_view> needs;
+            };
+            
+            // a list of names for every row of a table, kept back to back
+            class lists {
+            public:
+                void add(std::span<const std::string_view> names);
+                std::span<const std::string_view> operator[](std::size_t row) const {
+                    const auto& r = runs[row];
+                    return {all.data() + r.first, r.count};
+                }
+                void reserve(std::size_t rows) { runs.reserve(rows); }
+            private:
+                struct run { std::uint32_t first, count; };
+                std::vector<run> runs;
+                std::vector<std::string_view> all;
+            };
+            
+            // walks a table row by row, assembling each on the way
+            template <typename Table>
+            class cursor {
+            public:
+                using iterator_category = std::input_iterator_tag;
+                using value_type = typename Table::row;
+                using difference_type = std::ptrdiff_t;
+                using reference = value_type;
+                using pointer = void;
+                
+                cursor() = default;
+                cursor(const Table* table, std::size_t at) : table(table), at(at) {}
+                value_type operator*() const { return (*table)[at]; }
+                cursor& operator++() { at++; return *this; }
+                cursor operator++(int) { cursor was = *this; at++; return was; }
+                bool operator==(const cursor&) const = default;
+            private:
+                const Table* table = nullptr;
+                std::size_t at = 0;
+            };
+            
+            // links, one column per field, so going over a single field (every tag,
+            // say) stays within one block of memory; rows are views put together
+            // on access
+            class linktable {
+            public:
+                using row = link;
+                
+                std::vector<std::string_view> name, tag, source, destination;
+                std::vector<linktype> type;
+                lists onchange, after, needs;
+                
+                std::size_t size() const { return name.size(); }
+                bool empty() const { return name.empty(); }
+                void reserve(std::size_t n);
+                void push_back(const link& l);
+                link operator[](std::size_t i) const;
+                link at(std::size_t i) const;
+                cursor<linktable> begin() const { return {this, 0}; }
+                cursor<linktable> end() const { return {this, size()}; }
+            };
+            
+            class templatetable {
+            public:
+                using row = templatelink;
+                
+                std::vector<std::string_view> name, tag, source, destination;
+                lists items, onchange, after, needs;
+                
+                std::size_t size() const { return name.size(); }
+                bool empty() const { return name.empty(); }
+                void reserve(std::size_t n);
+                void push_back(const templatelink& t);
+                templatelink operator[](std::size_t i) const;
+                templatelink at(std::size_t i) const;
+                cursor<templatetable> begin() const { return {this, 0}; }
+                cursor<templatetable> end() const { return {this, size()}; }
+            };
+            
+            // a directory mirrored into `destination` with as few links as possible
+            struct package {
                 std::string name;
                 std::string tag;
                 fs::path source;
                 fs::path destination;
-                std::vector<std::string> items;
+            };
+            
+            // a command run once after a 'link' changed any entry naming it in on-change
+            struct hook {
+                std::string name;
+                std::string run;
+                // hooks that have to finish first when they run as well
+                std::vector<std::string> after;
             };
             
             struct settings {
                 repository repo;
-                std::vector<link> links;
-                std::vector<templatelink> templates;
+                linktable links;
+                templatetable templates;
+                std::vector<package> packages;
+                std::vector<hook> hooks;
+                
+                // every string in links and templates lives here, once; shared so
+                // that copies of the settings stay valid on their own
+                std::shared_ptr<arena::strings> strings = std::make_shared<arena::strings>();
+                std::string_view intern(std::string_view s) { return strings->intern(s); }
             };
             
+            std::string_view literal(linktype t);
+
             confidant::config::local::settings serialize(std::string_view path, const confidant::config::global::settings& globals);
+            confidant::config::local::settings serialize(std::string_view path, const confidant::config::global::settings& globals,
+                                                         variables::resolver& vars);
         }; // END local
 
     }; // END config
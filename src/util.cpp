@@ -10,9 +10,10 @@
 #include <ranges>
 #include <string_view>
 #include <map>
+#include <cstdint>
+#include <format>
+#include <system_error>
 
-#include "parse.hpp"
-#include "xdg.hpp"
 #include "msg.hpp"
 #include "util.hpp"
 
@@ -23,48 +24,6 @@ using std::string_view;
 
 namespace util {
     
-    std::map<std::string, std::string> makevarmap(std::string_view path) {
-        
-        std::map<std::string, std::string> vars;
-        std::map<std::string, fs::path> xdghomes = xdg::homes();
-
-        ucl::var::add("XDG_CONFIG_HOME", xdghomes["XDG_CONFIG_HOME"].string(), vars);
-        ucl::var::add("XDG_CACHE_HOME",  xdghomes["XDG_CACHE_HOME"].string(),  vars);
-        ucl::var::add("XDG_DATA_HOME",   xdghomes["XDG_DATA_HOME"].string(),   vars);
-        ucl::var::add("XDG_STATE_HOME",  xdghomes["XDG_STATE_HOME"].string(),  vars);
-        
-        ucl::var::add("xdg_config_home", xdghomes["XDG_CONFIG_HOME"].string(), vars);
-        ucl::var::add("xdg_cache_home",  xdghomes["XDG_CACHE_HOME"].string(),  vars);
-        ucl::var::add("xdg_data_home",   xdghomes["XDG_DATA_HOME"].string(),   vars);
-        ucl::var::add("xdg_state_home",  xdghomes["XDG_STATE_HOME"].string(),  vars);
-        
-        ucl::var::add("XDG_RUNTIME_DIR", xdghomes["XDG_RUNTIME_DIR"].string(), vars);
-        ucl::var::add("xdg_runtime_dir", xdghomes["XDG_RUNTIME_DIR"].string(), vars);
- 
-        std::optional<std::string> homedir = util::getenv("HOME");
-        if (!homedir)
-            throw std::runtime_error("HOME is not set in the environment!");
-     
-        ucl::var::add("HOME", homedir.value(), vars);
-        ucl::var::add("home", homedir.value(), vars);
-        ucl::var::add("REPO", fs::path(path).parent_path().string(), vars);
-        ucl::var::add("repo", fs::path(path).parent_path().string(), vars);
-        
-        std::optional<std::string> username = util::getenv("USER");
-        if (username) {
-            ucl::var::add("user", username.value(), vars);
-            ucl::var::add("USER", username.value(), vars);
-        }
-        
-        std::optional<std::string> email = util::getenv("EMAIL");
-        if (email) {
-            ucl::var::add("email", email.value(), vars);
-            ucl::var::add("EMAIL", email.value(), vars);
-        }
-        
-        return vars;
-    }
-    
     std::string verboseliteral(verbose v) {
         switch (v) {
             case verbose::quiet:
@@ -198,6 +157,18 @@ namespace util {
         else if (envnocolor->empty()) return true;
         else return false;
     }
+    
+    std::string configkey(std::string_view config) {
+        // FNV-1a of the resolved path, so every spelling of it agrees
+        std::error_code ec;
+        std::string key = fs::weakly_canonical(fs::absolute(fs::path(config)), ec).native();
+        std::uint64_t hash = 0xcbf29ce484222325;
+        for (unsigned char c : key) {
+            hash ^= c;
+            hash *= 0x100000001b3;
+        }
+        return std::format("{:016x}", hash);
+    }
 
 
 }; // END util
@@ -19,7 +19,6 @@ namespace util {
         debug = 3,
         trace = 4
     };
-    std::map<std::string, std::string> makevarmap(std::string_view path);
     std::string verboseliteral(verbose v);
     std::string substitute(std::string_view tmpl, std::string_view item);
     std::vector<std::string_view> split(std::string_view sv);
@@ -31,4 +30,6 @@ namespace util {
     std::string unexpandhome(std::string_view p);
     std::vector<std::filesystem::path> splitpath(const std::string& pathstr);
     bool usecolorp();
+    // stable name for per-configuration runtime and state files
+    std::string configkey(std::string_view config);
 }; // END util
@@ -0,0 +1,230 @@
+// SPDX-FileCopyrightText: 2026 Will Reed <wreed@disroot.org>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <optional>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/utsname.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "variables.hpp"
+#include "util.hpp"
+#include "xdg.hpp"
+#include "i18n.hpp"
+
+extern char** environ;
+
+namespace fs = std::filesystem;
+
+using sview = std::string_view;
+using std::string;
+using std::optional;
+using std::nullopt;
+
+namespace variables {
+
+    resolver::resolver(sview config)
+        : dir(fs::path(config).parent_path()), repo(dir.string()), environment(true) {}
+
+    resolver::resolver(sview config, std::map<string, fs::path> xdghomes, sview home, sview user, const fs::path& root, sview repo)
+        : dir(fs::path(config).parent_path()), repo(repo.empty() ? dir.string() : string(repo)), root(root),
+          xdghomes(std::move(xdghomes)), home(string(home)), user(string(user)) {}
+
+    static string chomp(string s) {
+        while (!s.empty() && (s.back() == '\n' || s.back() == '\r')) s.pop_back();
+        return s;
+    }
+
+    static optional<string> slurp(const fs::path& file) {
+        std::ifstream in(file, std::ios::binary);
+        if (!in.is_open()) return nullopt;
+        return string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    // ID from os-release(5), unquoted; "linux" when it doesn't say
+    static string osid(const fs::path& root) {
+        auto text = slurp(root / "etc/os-release");
+        if (!text) text = slurp(root / "usr/lib/os-release");
+        if (!text) return "linux";
+        sview rest = text.value();
+        while (!rest.empty()) {
+            size_t eol = rest.find('\n');
+            sview line = rest.substr(0, eol);
+            rest = eol == sview::npos ? sview() : rest.substr(eol + 1);
+            if (!line.starts_with("ID=")) continue;
+            line.remove_prefix(3);
+            if (line.size() >= 2 && (line.front() == '"' || line.front() == '\'') && line.back() == line.front())
+                line = line.substr(1, line.size() - 2);
+            return string(line);
+        }
+        return "linux";
+    }
+
+    static optional<string> hostname(const fs::path& root) {
+        if (root != "/") {
+            auto text = slurp(root / "etc/hostname");
+            if (!text) return nullopt;
+            return chomp(text.value().substr(0, text->find('\n')));
+        }
+        char name[256] = {};
+        if (gethostname(name, sizeof name - 1) != 0) return nullopt;
+        return string(name);
+    }
+
+    // standard output of 'sh -c command', run in `dir`; nullopt when it fails
+    static optional<string> run(const string& command, const fs::path& dir) {
+        int out[2];
+        if (pipe2(out, O_CLOEXEC) != 0) return nullopt;
+
+        posix_spawn_file_actions_t actions;
+        posix_spawn_file_actions_init(&actions);
+        posix_spawn_file_actions_adddup2(&actions, out[1], STDOUT_FILENO);
+        if (!dir.empty()) posix_spawn_file_actions_addchdir_np(&actions, dir.c_str());
+
+        const char* argv[] = {"/bin/sh", "-c", command.c_str(), nullptr};
+        pid_t pid;
+        int err = posix_spawn(&pid, "/bin/sh", &actions, nullptr, const_cast<char* const*>(argv), environ);
+        posix_spawn_file_actions_destroy(&actions);
+        close(out[1]);
+        if (err != 0) {
+            close(out[0]);
+            return nullopt;
+        }
+
+        string output;
+        char buf[4096];
+        for (;;) {
+            ssize_t n = read(out[0], buf, sizeof buf);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) break;
+            output.append(buf, n);
+        }
+        close(out[0]);
+
+        int status;
+        while (waitpid(pid, &status, 0) < 0) {
+            if (errno != EINTR) return nullopt;
+        }
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) return nullopt;
+        return output;
+    }
+
+    const std::map<string, fs::path>& resolver::homes() const {
+        if (!xdghomes) xdghomes = xdg::homes();
+        return xdghomes.value();
+    }
+
+    // built-in names may be written fully in upper or lower case
+    optional<string> resolver::builtin(sview name, bool& isbuiltin) const {
+        string lower(name);
+        std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return std::tolower(c); });
+        string upper(name);
+        std::transform(upper.begin(), upper.end(), upper.begin(), [](unsigned char c) { return std::toupper(c); });
+        isbuiltin = name == lower || name == upper;
+        if (!isbuiltin) return nullopt;
+
+        if (lower == "repo") return repo;
+        if (lower == "home") {
+            if (environment) {
+                auto env = util::getenv("HOME");
+                if (!env) throw std::runtime_error("HOME is not set in the environment!");
+                return env;
+            }
+            return home;
+        }
+        if (lower == "user") {
+            auto u = environment ? util::getenv("USER") : user;
+            if (u && u->empty()) return nullopt;
+            return u;
+        }
+        if (lower == "email") return util::getenv("EMAIL");
+        if (lower.starts_with("xdg_")) {
+            auto found = homes().find(upper);
+            if (found != homes().end()) return found->second.string();
+        }
+        if (lower == "hostname") return hostname(root);
+        if (lower == "os") return osid(root);
+        if (lower == "arch") {
+            struct utsname u;
+            if (uname(&u) != 0) return nullopt;
+            return string(u.machine);
+        }
+
+        isbuiltin = false;
+        return nullopt;
+    }
+
+    // lookups happen while libucl is parsing, so a failure is kept for the
+    // parser's caller to report instead of ending anything from in there
+    optional<string> resolver::evaluate(sview name, const definition& d) const {
+        switch (d.how) {
+            case kind::value:
+                return d.text;
+            case kind::file: {
+                fs::path file = dir / d.text;
+                auto text = slurp(file);
+                if (!text) {
+                    if (failed.empty())
+                        failed = _("failed to read ") + file.string() + _(" for variable ") + string(name);
+                    return nullopt;
+                }
+                return chomp(std::move(text.value()));
+            }
+            case kind::command: {
+                auto output = run(d.text, dir);
+                if (!output) {
+                    if (failed.empty())
+                        failed = _("the command for variable ") + string(name) + _(" failed: ") + d.text;
+                    return nullopt;
+                }
+                return chomp(std::move(output.value()));
+            }
+        }
+        return nullopt;
+    }
+
+    optional<string> resolver::lookup(sview name) const {
+        if (auto found = known.find(name); found != known.end()) return found->second;
+
+        optional<string> value;
+        bool builtinp = false;
+        value = builtin(name, builtinp);
+        if (!builtinp) {
+            auto d = defined.find(name);
+            if (d != defined.end()) {
+                value = evaluate(name, d->second);
+            } else {
+                // perhaps one of a variables {} block that hasn't been read yet
+                unknown.emplace(name);
+                return nullopt;
+            }
+        }
+        known.emplace(string(name), value);
+        return value;
+    }
+
+    bool resolver::define(sview name, definition d) {
+        bool builtinp = false;
+        builtin(name, builtinp);
+        if (builtinp) return false;
+        // what was left unknown before may be this
+        if (auto found = known.find(name); found != known.end()) known.erase(found);
+        defined.insert_or_assign(string(name), std::move(d));
+        return true;
+    }
+
+}; // END variables
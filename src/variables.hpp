@@ -0,0 +1,73 @@
+// SPDX-FileCopyrightText: 2026 Will Reed <wreed@disroot.org>
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#pragma once
+
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <optional>
+#include <set>
+#include <string>
+#include <string_view>
+
+// the ${name}s a local configuration can use: built-in ones, and those of its
+// variables {} block; each is only worked out the first time the configuration
+// refers to it, then remembered for as long as the resolver lives
+namespace variables {
+
+    // how an entry of the variables {} block gets its value
+    enum class kind { value, file, command };
+
+    struct definition {
+        kind how = kind::value;
+        // the value itself, a path to read (relative to the repository) or a
+        // command for 'sh -c' (run in the repository), whose output is the value
+        std::string text;
+    };
+
+    class resolver {
+    public:
+        // for `config`, from this process's environment
+        explicit resolver(std::string_view config);
+        // for `config` applied to another home, or to an image rooted at `root`,
+        // whose hostname and OS are then the image's; `repo` is what ${repo}
+        // says when the image sees the repository somewhere else
+        resolver(std::string_view config, std::map<std::string, std::filesystem::path> xdghomes,
+                 std::string_view home, std::string_view user, const std::filesystem::path& root = "/",
+                 std::string_view repo = {});
+
+        // nullopt when there's no such variable, or it has no value here
+        std::optional<std::string> lookup(std::string_view name) const;
+        // built-in names can't be redefined; false for those
+        bool define(std::string_view name, definition d);
+        // whether `name` was looked up before anything defined it
+        bool missed(std::string_view name) const { return unknown.contains(name); }
+        // "/" unless this is for an image
+        const std::filesystem::path& sysroot() const { return root; }
+        // why a variable's file or command gave no value, empty when none failed
+        const std::string& failure() const { return failed; }
+
+    private:
+        std::optional<std::string> builtin(std::string_view name, bool& isbuiltin) const;
+        std::optional<std::string> evaluate(std::string_view name, const definition& d) const;
+        const std::map<std::string, std::filesystem::path>& homes() const;
+
+        // where the configuration is, and what ${repo} says
+        std::filesystem::path dir;
+        std::string repo;
+        std::filesystem::path root = "/";
+        // from the environment only once something asks, when not given
+        bool environment = false;
+        mutable std::optional<std::map<std::string, std::filesystem::path>> xdghomes;
+        std::optional<std::string> home;
+        std::optional<std::string> user;
+
+        std::map<std::string, definition, std::less<>> defined;
+        mutable std::map<std::string, std::optional<std::string>, std::less<>> known;
+        mutable std::set<std::string, std::less<>> unknown;
+        // only the first; it's raised once parsing is done, not from within it
+        mutable std::string failed;
+    };
+
+}; // END variables
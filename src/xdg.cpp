@@ -145,4 +145,14 @@ std::map<std::string, fs::path> homes() {
     return x;
 }
 
+std::map<std::string, fs::path> homes(const fs::path& home, int uid) {
+    std::map<std::string, fs::path> x;
+    x.insert(std::pair{"XDG_CONFIG_HOME", home / ".config"});
+    x.insert(std::pair{"XDG_CACHE_HOME",  home / ".cache"});
+    x.insert(std::pair{"XDG_STATE_HOME",  home / ".local/state"});
+    x.insert(std::pair{"XDG_DATA_HOME",   home / ".local/share"});
+    x.insert(std::pair{"XDG_RUNTIME_DIR", fs::path(std::format("/run/user/{}", uid))});
+    return x;
+}
+
 } // END xdg
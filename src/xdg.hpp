@@ -12,4 +12,6 @@
 namespace xdg {
     std::map<std::string, std::vector<std::filesystem::path>> dirs();
     std::map<std::string, std::filesystem::path> homes();
+    // the defaults for a given home and user id, ignoring the environment
+    std::map<std::string, std::filesystem::path> homes(const std::filesystem::path& home, int uid);
 } // END xdg
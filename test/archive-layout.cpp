@@ -0,0 +1,220 @@
+#include "actions/archive.hpp"
+#include "actions/link.hpp"
+#include "settings/local.hpp"
+
+#include "test.hpp"
+#include "testing.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <format>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <sys/stat.h>
+
+namespace config = confidant::config;
+namespace actions = confidant::actions;
+
+struct member {
+    std::string path;
+    char type;
+    std::string link;
+    std::uint64_t uid = 0;
+    std::uint64_t mode = 0;
+};
+
+static std::uint64_t number(std::string_view field, int base) {
+    while (!field.empty() && (field.back() == '\0' || field.back() == ' ')) field.remove_suffix(1);
+    std::uint64_t value = 0;
+    std::from_chars(field.data(), field.data() + field.size(), value, base);
+    return value;
+}
+
+static std::string text(std::string_view field) {
+    return std::string(field.substr(0, std::min(field.find('\0'), field.size())));
+}
+
+// every member, with whatever pax headers said about it applied; empty if
+// any header is malformed or the archive doesn't end on a whole record
+static std::vector<member> untar(std::string_view raw, std::vector<std::string>& records) {
+    std::vector<member> out;
+    if (raw.size() % 10240 != 0) return {};
+    std::string path, link;
+    std::uint64_t uid = 0;
+    bool extended = false;
+    for (std::size_t pos = 0; pos + 512 <= raw.size(); pos += 512) {
+        std::string_view h = raw.substr(pos, 512);
+        if (h.find_first_not_of('\0') == std::string_view::npos) return out;
+        unsigned sum = 0;
+        for (std::size_t i = 0; i < 512; i++) sum += i >= 148 && i < 156 ? ' ' : static_cast<unsigned char>(h[i]);
+        if (sum != number(h.substr(148, 8), 8) || h.substr(257, 6) != std::string_view("ustar\0", 6)) return {};
+
+        std::uint64_t size = number(h.substr(124, 12), 8);
+        if (h[156] == 'x') {
+            // "LENGTH key=value\n", LENGTH counting the whole record
+            std::string_view data = raw.substr(pos + 512, size);
+            while (!data.empty()) {
+                std::size_t length = number(data.substr(0, data.find(' ')), 10);
+                if (length == 0 || length > data.size() || data[length - 1] != '\n') return {};
+                std::string_view rec = data.substr(0, length);
+                records.emplace_back(rec);
+                std::string_view kv = rec.substr(rec.find(' ') + 1);
+                kv.remove_suffix(1);
+                std::string_view key = kv.substr(0, kv.find('=')), value = kv.substr(kv.find('=') + 1);
+                if (key == "path") path = value;
+                if (key == "linkpath") link = value;
+                if (key == "uid") uid = number(value, 10);
+                data.remove_prefix(length);
+            }
+            extended = true;
+            pos += (size + 511) / 512 * 512;
+            continue;
+        }
+
+        member m;
+        std::string prefix = text(h.substr(345, 155));
+        m.path = prefix.empty() ? text(h.substr(0, 100)) : prefix + "/" + text(h.substr(0, 100));
+        m.type = h[156];
+        m.link = text(h.substr(157, 100));
+        m.uid = number(h.substr(108, 8), 8);
+        m.mode = number(h.substr(100, 8), 8);
+        if (extended) {
+            if (!path.empty()) m.path = path;
+            if (!link.empty()) m.link = link;
+            if (uid) m.uid = uid;
+            path.clear();
+            link.clear();
+            uid = 0;
+            extended = false;
+        }
+        out.push_back(m);
+    }
+    return {};
+}
+
+// every member up to the trailer; empty if the stream doesn't line up
+static std::vector<member> uncpio(std::string_view raw) {
+    std::vector<member> out;
+    std::size_t pos = 0;
+    while (pos + 110 <= raw.size()) {
+        std::string_view h = raw.substr(pos, 110);
+        if (h.substr(0, 6) != "070701") return {};
+        auto field = [&](int i) { return number(h.substr(6 + 8 * i, 8), 16); };
+        std::uint64_t namesize = field(11), filesize = field(6);
+        if (pos + 110 + namesize > raw.size() || raw[pos + 110 + namesize - 1] != '\0') return {};
+        member m;
+        m.path = raw.substr(pos + 110, namesize - 1);
+        m.mode = field(1);
+        m.uid = field(2);
+        pos = (pos + 110 + namesize + 3) & ~std::size_t(3);
+        m.link = raw.substr(pos, filesize);
+        pos = (pos + filesize + 3) & ~std::size_t(3);
+        if (m.path == "TRAILER!!!") return pos == raw.size() ? out : std::vector<member>{};
+        m.type = S_ISDIR(m.mode) ? '5' : '2';
+        out.push_back(m);
+    }
+    return {};
+}
+
+static actions::link::entry linked(const std::string& source, const std::string& destination) {
+    actions::link::entry e;
+    e.name = destination;
+    e.source = source;
+    e.destination = destination;
+    return e;
+}
+
+int main(const int argc, const char *argv[]) {
+
+    testing::checks check;
+
+    // one path ustar splits into prefix and name, one whose last part doesn't
+    // fit in a name at all, and a target too long for a link name
+    std::string split = std::format("home/user/{}/{}/file", std::string(60, 'd'), std::string(60, 'e'));
+    std::string longname = std::format("home/user/{}", std::string(120, 'x'));
+    std::string longtarget = std::format("/repo/{}", std::string(150, 't'));
+    std::vector<actions::link::entry> entries = {
+        linked("/repo/bashrc", "/home/user/.bashrc"),
+        linked("/repo/split", "/" + split),
+        linked("/repo/long", "/" + longname),
+        linked(longtarget, "/home/user/.vimrc"),
+        linked("/repo/inner", "/home/user/.bashrc/inner")
+    };
+    actions::link::entry copied = linked("/repo/copied", "/home/user/copied");
+    copied.type = config::local::linktype::copy;
+    entries.push_back(copied);
+
+    actions::archive::options opts;
+    opts.uid = 1000;
+    opts.gid = 1000;
+    opts.dirmode = 0750;
+    opts.mtime = 1700000000;
+
+    // members in path order, directories first, copies and links inside links left out
+    std::vector<std::string> expected = {
+        "home/", "home/user/", "home/user/.bashrc", "home/user/.vimrc",
+        std::format("home/user/{}/", std::string(60, 'd')),
+        std::format("home/user/{}/{}/", std::string(60, 'd'), std::string(60, 'e')),
+        split, longname
+    };
+
+    std::ostringstream tar;
+    check(actions::archive::write(tar, entries, opts) == 4, "tar counts the links");
+    std::string raw = tar.str();
+    std::vector<std::string> records;
+    std::vector<member> all = untar(raw, records);
+    std::vector<std::string> paths;
+    for (const auto& m : all) paths.push_back(m.path);
+    check(paths == expected, "tar members are in order with valid checksums");
+    check(raw.substr(345, 1) == std::string(1, '\0') && raw.substr(257, 8) == std::string_view("ustar\0" "00", 8),
+        "tar headers are ustar");
+
+    // the split path is held by prefix and name, without a pax header
+    auto at = [&](const std::string& path) {
+        return std::find_if(all.begin(), all.end(), [&](const member& m) { return m.path == path; });
+    };
+    bool splitted = false;
+    for (std::size_t pos = 512; pos < raw.size(); pos += 512) {
+        if (raw[pos + 156] == '2' && text(raw.substr(pos + 345, 155)) == std::format("home/user/{}", std::string(60, 'd')))
+            splitted = text(raw.substr(pos, 100)) == std::format("{}/file", std::string(60, 'e')) && raw[pos - 512 + 156] != 'x';
+    }
+    check(splitted, "long path split into prefix and name");
+    check(at(longname) != all.end() && at(longname)->type == '2' && at(longname)->link == "/repo/long",
+        "over-long name carried by a pax path record");
+    check(at("home/user/.vimrc") != all.end() && at("home/user/.vimrc")->link == longtarget,
+        "over-long target carried by a pax linkpath record");
+    check(std::find(records.begin(), records.end(), std::format("140 path={}\n", longname)) != records.end()
+        && std::find(records.begin(), records.end(), std::format("170 linkpath={}\n", longtarget)) != records.end(),
+        "pax record lengths count themselves");
+    check(at("home/") != all.end() && at("home/")->type == '5' && at("home/")->mode == 0750 && at("home/")->uid == 1000
+        && at("home/user/.bashrc")->mode == 0777, "tar modes and owners");
+
+    // ids too large for ustar's octal fields go in pax records
+    actions::archive::options big = opts;
+    big.uid = 70000000;
+    std::ostringstream bigtar;
+    actions::archive::write(bigtar, {entries[0]}, big);
+    records.clear();
+    all = untar(bigtar.str(), records);
+    check(all.size() == 3 && std::all_of(all.begin(), all.end(), [](const member& m) { return m.uid == 70000000; }),
+        "large uid carried by a pax record");
+
+    std::ostringstream cpio;
+    opts.kind = actions::archive::format::cpio;
+    check(actions::archive::write(cpio, entries, opts) == 4, "cpio counts the links");
+    all = uncpio(cpio.str());
+    paths.clear();
+    for (const auto& m : all) paths.push_back(m.type == '5' ? m.path + "/" : m.path);
+    check(paths == expected, "cpio members are in order and aligned");
+    check(at(longname) != all.end() && at(longname)->mode == (S_IFLNK | 0777) && at(longname)->uid == 1000
+        && at("home/user/.vimrc")->link == longtarget,
+        "cpio keeps long paths and targets whole");
+    check(at("home") != all.end() && at("home")->mode == (S_IFDIR | 0750), "cpio directory mode");
+
+    return check.result();
+
+}
@@ -0,0 +1,117 @@
+#include "actions/check.hpp"
+#include "actions/link.hpp"
+#include "settings/global.hpp"
+#include "settings/local.hpp"
+
+#include "test.hpp"
+#include "testing.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+namespace config = confidant::config;
+namespace actions = confidant::actions;
+
+static actions::link::entry linked(const fs::path& source, const fs::path& destination) {
+    actions::link::entry e;
+    e.name = destination.filename().string();
+    e.source = source;
+    e.destination = destination;
+    return e;
+}
+
+// what was found about entry `i`, in order
+static std::vector<actions::check::kind> about(const actions::check::report& found, std::size_t i) {
+    std::vector<actions::check::kind> out;
+    for (const auto& p : found.problems)
+        if (p.entry == i) out.push_back(p.what);
+    return out;
+}
+
+int main(const int argc, const char *argv[]) {
+
+    testing::scratch dir("check");
+    fs::path repo = dir / "repo";
+    fs::path home = dir / "home";
+    fs::create_directories(repo / "tree");
+    fs::create_directories(home / "locked");
+    std::ofstream(repo / "file") << "ours";
+    std::ofstream(home / "theirs") << "theirs";
+    std::ofstream(home / "plain") << "a file";
+    fs::create_symlink(repo / "file", home / "done");
+
+    std::vector<actions::link::entry> entries = {
+        linked(repo / "file", home / "fresh"),
+        linked(repo / "missing", home / "missing"),
+        linked(repo / "file", home / "dir"),
+        linked(repo / "file", home / "plain" / "below"),
+        linked(repo / "file", home / "deeper" / "still" / "file"),
+        linked(repo / "file", home / "theirs"),
+        linked(repo / "file", home / "done"),
+        linked(repo / "file", home / "locked" / "file")
+    };
+    entries[2].type = config::local::linktype::directory;
+    fs::permissions(home / "locked", fs::perms::owner_read | fs::perms::owner_exec);
+    testing::checks check;
+
+    config::global::settings globals;
+    actions::check::report found = actions::check::validate(entries, globals, 4);
+    check(about(found, 0).empty() && about(found, 6).empty(), "nothing is wrong with a new or finished link");
+    check(about(found, 1) == std::vector{actions::check::kind::nosource}, "a missing source is an error");
+    check(about(found, 2) == std::vector{actions::check::kind::notdirectory}, "a directory link needs a directory");
+    bool blocked = std::any_of(found.problems.begin(), found.problems.end(), [&](const auto& p) {
+        return p.entry == 3 && p.what == actions::check::kind::blocked && p.path == home / "plain";
+    });
+    check(blocked, "a file on the way to the destination blocks it");
+    check(about(found, 4).empty(), "missing parents are made");
+    check(about(found, 5) == std::vector{actions::check::kind::conflict}, "a taken destination is a warning");
+
+    // root writes anywhere, so only where permissions hold
+    int fd = open((home / "locked" / "probe").c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+    if (fd >= 0) {
+        close(fd);
+        fs::remove(home / "locked" / "probe");
+        std::println("skip: unwritable directories, permissions aren't enforced");
+    } else {
+        check(about(found, 7) == std::vector{actions::check::kind::unwritable}, "an unwritable parent is an error");
+    }
+
+    bool ordered = true;
+    for (std::size_t i = 1; i < found.problems.size(); i++)
+        ordered = ordered && found.problems[i - 1].entry <= found.problems[i].entry;
+    check(ordered, "problems come in plan order");
+    check(found.errors == found.problems.size() - found.warnings && found.warnings == 1, "errors and warnings are counted");
+    check(!actions::check::clean(found, false), "errors stop the run");
+
+    // without the errors, a warning only stops a strict run
+    std::vector<actions::link::entry> warned = {entries[0], entries[5]};
+    found = actions::check::validate(warned, globals, 4);
+    check(actions::check::clean(found, false) && !actions::check::clean(found, true), "warnings only stop strict runs");
+
+    // a shared destination goes to the entry listed first, the rest are only warned about
+    std::vector<actions::link::entry> shared = {entries[0], linked(repo / "file", home / "." / "fresh")};
+    shared[1].name = "again";
+    found = actions::check::validate(shared, globals, 4);
+    check(about(found, 0).empty() && about(found, 1) == std::vector{actions::check::kind::duplicate}
+        && found.problems[0].other == 0 && found.errors == 0, "a shared destination is a warning");
+
+    // nothing is taken when it would be moved aside or replaced anyway
+    globals.conflicts = config::global::conflict::backup;
+    check(actions::check::validate(warned, globals, 4).problems.empty(), "nothing is taken with a backup");
+
+    // nor made when directories aren't created
+    globals.createdirs = false;
+    found = actions::check::validate({entries[4]}, globals, 4);
+    check(about(found, 0) == std::vector{actions::check::kind::noparent} && found.warnings == 1, "a missing parent is a warning without create-directories");
+
+    fs::permissions(home / "locked", fs::perms::owner_all);
+    return check.result();
+
+}
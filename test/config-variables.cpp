@@ -0,0 +1,70 @@
+#include "settings/global.hpp"
+#include "settings/local.hpp"
+#include "msg.hpp"
+#include "variables.hpp"
+
+#include "test.hpp"
+#include "testing.hpp"
+
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <string>
+
+namespace fs = std::filesystem;
+namespace config = confidant::config;
+
+static int count(const fs::path& file) {
+    std::ifstream in(file);
+    int n = 0;
+    for (std::string line; std::getline(in, line);) n++;
+    return n;
+}
+
+int main(const int argc, const char *argv[]) {
+
+    // commands run where the config is, so it's read from a copy
+    testing::scratch dir("variables");
+    fs::path repo = dir / "repo";
+    fs::path home = dir / "home";
+    fs::create_directories(repo);
+    fs::create_directories(home);
+    for (const char* name : {"local.ucl", "font"})
+        fs::copy_file(std::format("{}/test/aux/t/config-variables/{}", PROJECT_ROOT, name), repo / name);
+    setenv("HOME", home.c_str(), 1);
+    testing::checks check;
+
+    std::string path = (repo / "local.ucl").string();
+    variables::resolver vars(path);
+    config::local::settings conf = config::local::serialize(path, config::global::settings{}, vars);
+
+    check(conf.links.size() == 3, "links read");
+    if (conf.links.size() == 3) {
+        check(conf.links.source[0] == (repo / "dark").string() && conf.links.destination[0] == (home / ".theme-12").string(),
+            "variables used before the block are filled in");
+        check(conf.links.source[1] == (repo / "size-12").string() && conf.links.destination[1] == (home / "mono").string(),
+            "a file gives its contents, without the newline");
+        check(conf.links.destination[2] == (home / ".home").string(), "built-in variables can't be redefined");
+    }
+    check(count(repo / "size.log") == 1, "a command runs once, however often it's used");
+    check(!fs::exists(repo / "unused.log"), "a command nothing uses never runs");
+    check(vars.lookup("size") == "12" && !vars.lookup("nothing"), "variables are remembered");
+
+    // a command that fails is a parse error, one a reload can recover from
+    std::ofstream(repo / "failing.ucl") << "links = { x = { source = ${repo}/${bad}\n dest = ${home}/x } }\n"
+        "variables = { bad = { command = \"exit 3\" } }\n";
+    bool failed = false;
+    try {
+        msg::recoverable recover;
+        std::string failing = (repo / "failing.ucl").string();
+        variables::resolver again(failing);
+        config::local::serialize(failing, config::global::settings{}, again);
+    } catch (const msg::failure& e) {
+        failed = std::string(e.what()).contains("bad");
+    }
+    check(failed, "a failing command fails the parse");
+
+    return check.result();
+
+}
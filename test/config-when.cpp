@@ -0,0 +1,44 @@
+#include "settings/global.hpp"
+#include "settings/local.hpp"
+
+#include "test.hpp"
+#include "testing.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <format>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace config = confidant::config;
+
+int main(const int argc, const char *argv[]) {
+
+    setenv("CONFIDANT_TEST_SET", "", 1);
+    unsetenv("CONFIDANT_TEST_UNSET");
+    testing::checks check;
+
+    std::string path = std::format("{}/test/aux/t/config-when/local.ucl", PROJECT_ROOT);
+    config::local::settings conf = config::local::serialize(path, config::global::settings{});
+
+    std::set<std::string_view> names(conf.links.name.begin(), conf.links.name.end());
+    check(names.contains("always") && names.contains("anyhost") && !names.contains("otherhost"), "host is matched as a glob");
+    check(names.contains("thisos"), "a list is met by any of its values");
+    check(names.contains("envset") && !names.contains("envboth"), "every variable has to be set, even if empty");
+    check(names.contains("present") && !names.contains("absent"), "every path has to exist, and every field hold");
+    check(!names.contains("needsabsent"), "what requires a dropped entry is dropped with it");
+    check(names.contains("afterabsent"), "what only comes after it stays");
+    check(names.size() == 6, "nothing else is dropped");
+    check(conf.templates.empty(), "templates have conditions too");
+
+    auto after = std::find(conf.links.name.begin(), conf.links.name.end(), "afterabsent") - conf.links.name.begin();
+    if (static_cast<std::size_t>(after) < conf.links.size()) {
+        auto waits = conf.links.after[after];
+        check(waits.size() == 1 && waits[0] == "always", "a dropped entry is nothing to wait for");
+    }
+
+    return check.result();
+
+}
@@ -0,0 +1,64 @@
+#include "digest.hpp"
+
+#include "test.hpp"
+#include "testing.hpp"
+
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <format>
+#include <string>
+#include <vector>
+
+// reference values from libxxhash's XXH64
+struct vector {
+    std::size_t len;
+    std::uint64_t seed;
+    std::uint64_t hash;
+};
+
+int main(const int argc, const char *argv[]) {
+
+    testing::checks check;
+
+    // the buffer xxhsum's own sanity check hashes
+    std::vector<unsigned char> buffer;
+    std::uint32_t gen = 2654435761U;
+    for (int i = 0; i < 256; i++) {
+        buffer.push_back(static_cast<unsigned char>(gen >> 24));
+        gen *= gen;
+    }
+
+    for (const vector& v : {
+            vector{0, 0, 0xEF46DB3751D8E999ULL},
+            vector{0, 2654435761U, 0xAC75FDA2929B17EFULL},
+            vector{1, 0, 0x4FCE394CC88952D8ULL},
+            vector{1, 2654435761U, 0x739840CB819FA723ULL},
+            vector{14, 0, 0xCFFA8DB881BC3A3DULL},
+            vector{14, 2654435761U, 0x5B9611585EFCC9CBULL},
+            vector{222, 0, 0x9DD507880DEBB03DULL},
+            vector{222, 2654435761U, 0xDC515172B8EE0600ULL}}) {
+        std::uint64_t h = digest::xxh64(buffer.data(), v.len, v.seed);
+        check(h == v.hash, std::format("{} bytes, seed {:x}: {:016x}", v.len, v.seed, h));
+    }
+
+    const std::string fox = "The quick brown fox jumps over the lazy dog";
+    check(digest::xxh64("abc", 3) == 0x44BC2CF5AD770999ULL
+        && digest::xxh64(fox.data(), fox.size()) == 0x0B242D361FDA71BCULL, "strings");
+
+    // a file hashes the same as its contents, and again once cached; without
+    // HOME the cache stays in memory and nothing is written on exit
+    unsetenv("HOME");
+    unsetenv("XDG_CACHE_HOME");
+    testing::scratch dir("digest");
+    {
+        std::ofstream out(dir / "fox");
+        out << fox;
+    }
+    auto first = digest::file(dir / "fox");
+    auto second = digest::file(dir / "fox");
+    check(first && second && *first == 0x0B242D361FDA71BCULL && *second == *first, "files, hashed and cached");
+
+    return check.result();
+
+}
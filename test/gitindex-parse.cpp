@@ -0,0 +1,92 @@
+#include "gitindex.hpp"
+
+#include "test.hpp"
+#include "testing.hpp"
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <format>
+#include <string>
+
+namespace fs = std::filesystem;
+
+// object id in hex and mode, as 'git ls-files -s' shows them
+static std::string show(const gitindex::snapshot& s, const std::string& path) {
+    auto found = s.entries.find(path);
+    if (found == s.entries.end()) return "missing";
+    const std::string& value = found->second;
+    if (value.size() < 20) return value;
+    std::string out;
+    for (unsigned char c : value.substr(0, 20)) out += std::format("{:02x}", c);
+    return std::format("{} {}", value.substr(20), out);
+}
+
+static std::optional<gitindex::snapshot> load(const fs::path& worktree, const std::string& fixture, bool truncated = false) {
+    std::ifstream in(std::format("{}/test/aux/t/gitindex-parse/{}", PROJECT_ROOT, fixture), std::ios::binary);
+    std::string raw(std::istreambuf_iterator<char>(in), {});
+    if (truncated) raw.pop_back();
+    std::ofstream(worktree / ".git" / "index", std::ios::binary | std::ios::trunc) << raw;
+    return gitindex::read(worktree);
+}
+
+int main(const int argc, const char *argv[]) {
+
+    testing::scratch dir("gitindex");
+    fs::create_directories(dir / ".git");
+    fs::create_directories(dir / "dots" / "config");
+    testing::checks check;
+
+    check(gitindex::worktree(dir / "dots" / "config") == dir.path(), "work tree found from below");
+
+    // version 2: every path in full, padded to 8 bytes, with a cached tree extension
+    auto v2 = load(dir.path(), "index-v2");
+    check(v2 && v2->entries.size() == 7, "version 2 parses");
+    if (v2) {
+        check(show(v2.value(), "README") == "100644 8178c76d627cade75005b40711b92f4177bc6cfc"
+            && show(v2.value(), "bin/run") == "100755 1a2485251c33a70432394c93fb89330ef214bfc9"
+            && show(v2.value(), "link") == "120000 100b93820ade4c16225673b4ca62bb3ade63c313"
+            && show(v2.value(), "dots/config/nvim/lua/plugins.lua") == "100644 a564707544f53459c40ea75859a0a56f3beaa6b6",
+            "version 2 entries");
+    }
+
+    // version 4: paths prefix-compressed against the previous one, no padding;
+    // README is in a merge conflict, and init.lua has a staged edit
+    auto v4 = load(dir.path(), "index-v4");
+    check(v4 && v4->entries.size() == 7, "version 4 parses");
+    if (v4) {
+        check(show(v4.value(), "README").empty()
+            && show(v4.value(), "dots/config/nvim-extra") == "100644 0f2287157f7cb0dd40498c7a92f74b6975fa2d57"
+            && show(v4.value(), "dots/config/nvim/init.lua") == "100644 94f30097244730a842502c65e2506558c514e358"
+            && show(v4.value(), "dots/config/nvim/lua/plugins.lua") == "100644 a564707544f53459c40ea75859a0a56f3beaa6b6"
+            && show(v4.value(), "link") == "120000 100b93820ade4c16225673b4ca62bb3ade63c313",
+            "version 4 entries");
+    }
+
+    check(!load(dir.path(), "index-v2", true) && !load(dir.path(), "index-v4", true), "truncated indexes are rejected");
+
+    if (v2 && v4) {
+        gitindex::diff since(dir.path(), v2.value(), v4.value());
+        check(since.size() == 2, "diff finds the edit and the conflict");
+        check(since.unchanged(dir / "dots" / "bashrc") && since.unchanged(dir / "dots" / "config" / "nvim-extra")
+            && since.unchanged(dir / "dots" / "config" / "nvim" / "lua"),
+            "diff leaves the rest unchanged");
+        check(!since.unchanged(dir / "README") && !since.unchanged(dir / "dots" / "config" / "nvim")
+            && !since.unchanged(dir / "dots"),
+            "diff covers the changed paths and their parents");
+        check(!since.unchanged(dir / "untracked") && !since.unchanged(dir.path().parent_path() / "elsewhere"),
+            "untracked paths never count as unchanged");
+
+        // the index is kept as it was read, and reads back the same
+        setenv("XDG_STATE_HOME", (dir / "state").c_str(), 1);
+        std::string conf = (dir / "confidant.ucl").string();
+        gitindex::record(conf, 0x2a, v4.value());
+        auto again = gitindex::recorded(conf);
+        check(again && again->first == 0x2a && again->second.entries == v4->entries, "recorded index reads back");
+    }
+
+    return check.result();
+
+}
@@ -0,0 +1,122 @@
+#include "actions/link.hpp"
+#include "settings/global.hpp"
+#include "settings/local.hpp"
+#include "journal.hpp"
+
+#include "test.hpp"
+#include "testing.hpp"
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+namespace config = confidant::config;
+namespace actions = confidant::actions;
+
+static actions::link::entry linked(const fs::path& source, const fs::path& destination) {
+    actions::link::entry e;
+    e.name = destination.filename().string();
+    e.source = source;
+    e.destination = destination;
+    return e;
+}
+
+int main(const int argc, const char *argv[]) {
+
+    testing::scratch dir("journal");
+    fs::path repo = dir / "repo";
+    fs::path home = dir / "home";
+    fs::create_directories(repo);
+    fs::create_directories(home);
+    setenv("HOME", home.c_str(), 1);
+    setenv("XDG_STATE_HOME", (dir / "state").c_str(), 1);
+    for (const char* name : {"a", "b"})
+        std::ofstream(repo / name) << name;
+
+    // only symlinks, so nothing but the journal is written to the state directory
+    std::vector<actions::link::entry> entries = {
+        linked(repo / "a", home / "a"),
+        linked(repo / "b", home / "sub" / "b"),
+        linked(repo / "c", home / "c")
+    };
+    std::string conf = (repo / "confidant.ucl").string();
+    config::global::settings globals;
+    testing::checks check;
+
+    // the first run fails on c, whose source is missing, and never ends
+    {
+        journal::writer log(conf, 1);
+        std::size_t failed = 0;
+        actions::link::linkall(entries, globals, false, 1, &log, nullptr, nullptr, &failed);
+        check(!log.resumed() && failed == 1, "first run fails one entry");
+    }
+    check(fs::is_symlink(home / "a") && fs::is_symlink(home / "sub" / "b") && !fs::exists(fs::symlink_status(home / "c")),
+        "first run links the rest");
+
+    // the same plan picks up where it stopped, and only retries what failed
+    std::ofstream(repo / "c") << "c";
+    {
+        journal::writer log(conf, 1);
+        check(log.resumed() && log.done(home / "a") && log.done(home / "sub" / "b") && !log.done(home / "c"),
+            "resume knows what was done");
+        check(log.changed(home / "a") && !log.changed(home / "c"), "resume knows what was changed");
+        fs::remove(home / "a");
+        std::size_t failed = 0;
+        actions::link::linkall(entries, globals, false, 1, &log, nullptr, nullptr, &failed);
+        check(failed == 0 && fs::is_symlink(home / "c") && !fs::exists(fs::symlink_status(home / "a")),
+            "resume applies only what is left");
+        log.end();
+    }
+    std::ofstream(home / "a") << "someone else's";
+
+    // a dry rollback changes nothing
+    check(journal::rollback(conf, true) == 0 && fs::is_symlink(home / "c"), "dry rollback leaves everything");
+
+    // rollback removes what the run made, newest first, and only if it's still ours
+    check(journal::rollback(conf, false) == 0, "rollback succeeds");
+    check(!fs::exists(fs::symlink_status(home / "c")) && !fs::exists(home / "sub") && fs::is_regular_file(home / "a"),
+        "rollback undoes the run");
+    check(journal::rollback(conf, false) != 0, "a rolled back run is gone");
+
+    // a finished run is not resumed, even by the same plan
+    {
+        journal::writer log(conf, 1);
+        log.end();
+    }
+    {
+        journal::writer log(conf, 1);
+        check(!log.resumed(), "a finished run is not resumed");
+    }
+    // and neither is one of a different plan
+    {
+        journal::writer log(conf, 1);
+        actions::link::linkall({entries[0]}, globals, false, 1, &log);
+    }
+    {
+        journal::writer log(conf, 2);
+        check(!log.resumed(), "another plan is not resumed");
+    }
+
+    // a run killed in the middle of a change; what it wrote is on disk already
+    {
+        journal::writer log(conf, 3);
+        log.intend(journal::op::link, home / "b", repo / "b");
+        fs::create_symlink(repo / "b", home / "b");
+        std::ifstream in(journal::location(conf));
+        std::string text(std::istreambuf_iterator<char>(in), {});
+        check(text.contains("plan\tlink\t"), "records are written as they come");
+    }
+    {
+        journal::writer log(conf, 3);
+        check(log.changed(home / "b") && !log.done(home / "b"), "an announced change counts as changed");
+    }
+    check(journal::rollback(conf, false) == 0 && !fs::exists(fs::symlink_status(home / "b")),
+        "an announced change is rolled back");
+
+    return check.result();
+
+}
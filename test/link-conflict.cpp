@@ -0,0 +1,173 @@
+#include "actions/link.hpp"
+#include "settings/global.hpp"
+#include "settings/local.hpp"
+
+#include "test.hpp"
+#include "testing.hpp"
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+namespace fs = std::filesystem;
+namespace config = confidant::config;
+namespace actions = confidant::actions;
+
+static void write(const fs::path& path, const std::string& text) {
+    std::ofstream out(path, std::ios::trunc);
+    out << text;
+}
+
+static std::string read(const fs::path& path) {
+    std::ifstream in(path);
+    return std::string(std::istreambuf_iterator<char>(in), {});
+}
+
+static actions::link::entry linked(const fs::path& source, const fs::path& destination) {
+    actions::link::entry e;
+    e.name = destination.filename().string();
+    e.source = source;
+    e.destination = destination;
+    return e;
+}
+
+static actions::link::entry copied(const fs::path& source, const fs::path& destination) {
+    actions::link::entry e = linked(source, destination);
+    e.type = config::local::linktype::copy;
+    return e;
+}
+
+int main(const int argc, const char *argv[]) {
+
+    // without HOME, what we placed is only remembered for this run
+    unsetenv("HOME");
+    unsetenv("XDG_STATE_HOME");
+    unsetenv("XDG_CACHE_HOME");
+
+    testing::scratch dir("conflict");
+    fs::create_directories(dir / "repo" / "tree");
+    fs::create_directories(dir / "home" / "tree");
+    fs::create_directories(dir / "home" / "copies" / "tree");
+    write(dir / "repo" / "file", "ours\n");
+    write(dir / "repo" / "tree" / "inner", "ours\n");
+    for (const char* name : {"skip", "backup", "force"}) {
+        write(dir / "home" / name, "theirs\n");
+        write(dir / "home" / "copies" / name, "theirs\n");
+    }
+    write(dir / "home" / "tree" / "inner", "theirs\n");
+    write(dir / "home" / "copies" / "tree" / "inner", "theirs\n");
+
+    config::global::settings globals;
+    testing::checks check;
+
+    // someone else's file is left alone under skip
+    globals.conflicts = config::global::conflict::skip;
+    actions::link::result r = actions::link::apply(linked(dir / "repo" / "file", dir / "home" / "skip"), globals, false);
+    check(r == actions::link::result::skipped && !fs::is_symlink(dir / "home" / "skip") && read(dir / "home" / "skip") == "theirs\n", "skip keeps a foreign file");
+
+    // and so is someone else's directory
+    r = actions::link::apply(linked(dir / "repo" / "file", dir / "home" / "tree"), globals, false);
+    check(r == actions::link::result::skipped && read(dir / "home" / "tree" / "inner") == "theirs\n", "skip keeps a foreign directory");
+
+    // backup moves it aside before linking
+    globals.conflicts = config::global::conflict::backup;
+    r = actions::link::apply(linked(dir / "repo" / "file", dir / "home" / "backup"), globals, false);
+    bool saved = false;
+    for (const auto& entry : fs::directory_iterator(dir / "home")) {
+        std::string name = entry.path().filename().string();
+        if (name.starts_with("backup.confidant-backup-") && read(entry.path()) == "theirs\n") saved = true;
+    }
+    check(r == actions::link::result::linked && fs::is_symlink(dir / "home" / "backup") && saved, "backup saves a foreign file");
+
+    // and never over an earlier backup
+    write(dir / "home" / "twice", "theirs\n");
+    actions::link::apply(linked(dir / "repo" / "file", dir / "home" / "twice"), globals, false);
+    fs::remove(dir / "home" / "twice");
+    write(dir / "home" / "twice", "theirs again\n");
+    r = actions::link::apply(linked(dir / "repo" / "file", dir / "home" / "twice"), globals, false);
+    int backups = 0;
+    for (const auto& entry : fs::directory_iterator(dir / "home"))
+        if (entry.path().filename().string().starts_with("twice.confidant-backup-")) backups++;
+    check(r == actions::link::result::linked && backups == 2, "a second backup gets a name of its own");
+
+    // force replaces it outright, directories included
+    globals.conflicts = config::global::conflict::force;
+    r = actions::link::apply(linked(dir / "repo" / "file", dir / "home" / "force"), globals, false);
+    check(r == actions::link::result::linked && fs::read_symlink(dir / "home" / "force") == dir / "repo" / "file", "force replaces a foreign file");
+    r = actions::link::apply(linked(dir / "repo" / "file", dir / "home" / "tree"), globals, false);
+    check(r == actions::link::result::linked && fs::is_symlink(dir / "home" / "tree"), "force replaces a foreign directory");
+
+    // a link that's already in place is left as is
+    r = actions::link::apply(linked(dir / "repo" / "file", dir / "home" / "force"), globals, false);
+    check(r == actions::link::result::skipped, "force leaves a correct link alone");
+
+    // copies go through the same policies
+    globals.conflicts = config::global::conflict::skip;
+    r = actions::link::apply(copied(dir / "repo" / "file", dir / "home" / "copies" / "skip"), globals, false);
+    check(r == actions::link::result::skipped && read(dir / "home" / "copies" / "skip") == "theirs\n", "skip keeps a foreign file from a copy");
+
+    // and so is someone else's directory, even with a file of the same name in it
+    actions::link::entry tree = copied(dir / "repo" / "tree", dir / "home" / "copies" / "tree");
+    r = actions::link::apply(tree, globals, false);
+    check(r == actions::link::result::skipped && read(dir / "home" / "copies" / "tree" / "inner") == "theirs\n", "skip keeps a foreign directory from a copy");
+
+    // backup moves it aside before copying
+    globals.conflicts = config::global::conflict::backup;
+    r = actions::link::apply(copied(dir / "repo" / "file", dir / "home" / "copies" / "backup"), globals, false);
+    saved = false;
+    for (const auto& entry : fs::directory_iterator(dir / "home" / "copies")) {
+        std::string name = entry.path().filename().string();
+        if (name.starts_with("backup.confidant-backup-") && read(entry.path()) == "theirs\n") saved = true;
+    }
+    check(r == actions::link::result::linked && read(dir / "home" / "copies" / "backup") == "ours\n" && saved, "backup saves a foreign file from a copy");
+
+    // force replaces it outright
+    globals.conflicts = config::global::conflict::force;
+    r = actions::link::apply(copied(dir / "repo" / "file", dir / "home" / "copies" / "force"), globals, false);
+    check(r == actions::link::result::linked && read(dir / "home" / "copies" / "force") == "ours\n", "force replaces a foreign file with a copy");
+
+    // a copy we placed is refreshed in place even under skip
+    globals.conflicts = config::global::conflict::skip;
+    write(dir / "repo" / "file", "ours, edited\n");
+    r = actions::link::apply(copied(dir / "repo" / "file", dir / "home" / "copies" / "force"), globals, false);
+    check(r == actions::link::result::linked && read(dir / "home" / "copies" / "force") == "ours, edited\n", "skip refreshes our own copy");
+
+    // until someone edits it, when it's theirs again
+    write(dir / "home" / "copies" / "force", "edited by hand\n");
+    r = actions::link::apply(copied(dir / "repo" / "file", dir / "home" / "copies" / "force"), globals, false);
+    check(r == actions::link::result::skipped && read(dir / "home" / "copies" / "force") == "edited by hand\n", "skip keeps an edited copy");
+
+    // a tree we placed follows its source: what was deleted goes, links point where
+    // the source's do, and what became something else is replaced
+    fs::path mirror = dir / "repo" / "mirror";
+    fs::path placed = dir / "home" / "copies" / "mirror";
+    fs::create_directories(mirror / "kept");
+    write(mirror / "file", "ours\n");
+    write(mirror / "old", "ours\n");
+    write(mirror / "kind", "ours\n");
+    write(mirror / "kept" / "old", "ours\n");
+    fs::create_symlink("file", mirror / "link");
+    r = actions::link::apply(copied(mirror, placed), globals, false);
+    check(r == actions::link::result::linked && read(placed / "old") == "ours\n" && fs::read_symlink(placed / "link") == "file",
+        "a tree is copied");
+    fs::remove(mirror / "old");
+    fs::remove(mirror / "kept" / "old");
+    fs::remove(mirror / "kind");
+    fs::create_directories(mirror / "kind");
+    write(mirror / "kind" / "inside", "ours\n");
+    fs::remove(mirror / "link");
+    fs::create_symlink("kept", mirror / "link");
+    r = actions::link::apply(copied(mirror, placed), globals, false);
+    check(r == actions::link::result::linked, "a changed tree is refreshed");
+    check(!fs::exists(placed / "old") && !fs::exists(placed / "kept" / "old") && fs::is_directory(placed / "kept"),
+        "what was deleted from the source is removed");
+    check(fs::is_symlink(placed / "link") && fs::read_symlink(placed / "link") == "kept", "a link pointing elsewhere is corrected");
+    check(read(placed / "kind" / "inside") == "ours\n", "a file that became a directory is replaced");
+    r = actions::link::apply(copied(mirror, placed), globals, false);
+    check(r == actions::link::result::skipped && read(placed / "file") == "ours\n", "an unchanged tree is left alone");
+
+    return check.result();
+
+}
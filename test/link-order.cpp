@@ -0,0 +1,62 @@
+#include "actions/link.hpp"
+#include "settings/global.hpp"
+#include "settings/local.hpp"
+
+#include "test.hpp"
+#include "testing.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+namespace config = confidant::config;
+namespace actions = confidant::actions;
+
+int main(const int argc, const char *argv[]) {
+
+    testing::scratch home("order");
+    setenv("HOME", home.path().c_str(), 1);
+
+    std::string path = std::format("{}/test/aux/t/link-order/local.ucl", PROJECT_ROOT);
+    config::global::settings globals;
+    config::local::settings conf = config::local::serialize(path, globals);
+    testing::checks check;
+
+    // the plan has every entry after what it waits for, whatever the order in the file
+    std::vector<actions::link::entry> planned = actions::link::plan(conf, {"nested"});
+    auto at = [&](const std::string& name) {
+        auto it = std::find_if(planned.begin(), planned.end(), [&](const auto& e) { return e.name == name; });
+        return it - planned.begin();
+    };
+    check(planned.size() == 10, "every entry is planned");
+    check(at("base") < at("top"), "after orders the plan");
+    check(at("broken") < at("needy") && at("needy") < at("needier") && at("base") < at("needier"),
+        "requires orders the plan");
+    check(at("outer") < at("inner"), "a destination inside another comes after it");
+    check(at("top") < at("first") && at("first") < at("second"), "a shared destination goes in the order listed");
+
+    // what requires a failed entry is skipped, all the way down; what only
+    // comes after it is still applied
+    check(actions::link::linkall(conf, globals, {}, false, 4) == 0, "failures don't stop the run");
+    auto linked = [&](const char* name) { return fs::is_symlink(home / name); };
+    check(linked("top") && linked("base") && linked("patient"), "entries are linked");
+    check(!fs::exists(fs::symlink_status(home / "broken")), "an entry without a source fails");
+    check(!linked("needy") && !linked("needier"), "entries requiring it are skipped");
+    check(linked("shared") && fs::read_symlink(home / "shared").filename() == "base", "the first of a shared destination wins");
+    check(!fs::exists(fs::symlink_status(home / "outer")), "untagged runs leave tagged entries out");
+
+    // a saved plan can close a loop that was never checked; it is refused, not waited on forever
+    std::vector<actions::link::entry> loop = {planned[at("base")], planned[at("top")]};
+    loop[0].destination = home / "looped-base";
+    loop[1].destination = home / "looped-top";
+    loop[0].after = {"top"};
+    check(actions::link::linkall(loop, globals, false, 4) != 0, "a plan going in a circle is refused");
+    check(!linked("looped-base") && !linked("looped-top"), "nothing in it is linked");
+
+    return check.result();
+
+}
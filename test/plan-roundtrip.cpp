@@ -0,0 +1,114 @@
+#include "actions/plan.hpp"
+#include "actions/link.hpp"
+#include "settings/local.hpp"
+
+#include "test.hpp"
+#include "testing.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <format>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+namespace config = confidant::config;
+namespace actions = confidant::actions;
+
+static std::string slurp(const fs::path& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), {});
+}
+
+static void spit(const fs::path& path, const std::string& raw) {
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << raw;
+}
+
+int main(const int argc, const char *argv[]) {
+
+    testing::scratch dir("plan");
+    testing::checks check;
+
+    std::vector<actions::link::entry> entries(3);
+    entries[0].name = "shell";
+    entries[0].source = "/repo/dots/bashrc";
+    entries[0].destination = "/home/user/.bashrc";
+    entries[0].hooks = {"reload"};
+    entries[1].name = "nvim";
+    entries[1].source = "/repo/dots/nvim";
+    entries[1].destination = "/home/user/.config/nvim";
+    entries[1].type = config::local::linktype::directory;
+    entries[1].target = "/image/repo/dots/nvim";
+    entries[1].after = {"shell"};
+    entries[1].needs = {"shell"};
+    entries[2].name = "fonts";
+    entries[2].source = "/repo/fonts";
+    entries[2].destination = "/home/user/.local/share/fonts";
+    entries[2].type = config::local::linktype::copy;
+    entries[2].templated = true;
+    entries[2].hooks = {"reload", "fc-cache"};
+    std::vector<config::local::hook> hooks = {
+        {"reload", "exec $SHELL", {}},
+        {"fc-cache", "fc-cache -f", {"reload"}}
+    };
+
+    fs::path path = dir / "plan";
+    check(actions::plan::save(path.string(), entries, hooks, 0x1234abcd), "plan saved");
+    {
+        actions::plan::reader plan(path.string());
+        check(plan.error().empty() && plan.id() == 0x1234abcd, "plan opened");
+        bool same = plan.entries() == entries.size() && plan.hooks() == hooks.size();
+        for (std::size_t i = 0; same && i < entries.size(); i++) same = plan.entry(i) == entries[i];
+        for (std::size_t i = 0; same && i < hooks.size(); i++) {
+            auto h = plan.hook(i);
+            same = h.name == hooks[i].name && h.run == hooks[i].run && h.after == hooks[i].after;
+        }
+        check(same, "plan reads back as saved");
+    }
+
+    std::string raw = slurp(path);
+
+    // every byte is accounted for, so losing any is noticed
+    spit(dir / "truncated", raw.substr(0, raw.size() - 1));
+    {
+        actions::plan::reader plan((dir / "truncated").string());
+        check(plan.error().ends_with("is truncated or damaged") && plan.entries() == 0, "truncated plan refused");
+    }
+    spit(dir / "short", raw.substr(0, 20));
+    {
+        actions::plan::reader plan((dir / "short").string());
+        check(plan.error().ends_with("is not a plan"), "plan shorter than its header refused");
+    }
+
+    // a string pointing past the end of the file
+    std::string damaged = raw;
+    std::uint32_t offset = 0xffffff00;
+    std::memcpy(damaged.data() + 48, &offset, sizeof offset);
+    spit(dir / "damaged", damaged);
+    {
+        actions::plan::reader plan((dir / "damaged").string());
+        check(plan.error().ends_with("is damaged") && plan.entries() == 0, "damaged plan refused");
+    }
+
+    std::string newer = raw;
+    std::uint32_t version = actions::plan::version + 1;
+    std::memcpy(newer.data() + 8, &version, sizeof version);
+    spit(dir / "newer", newer);
+    {
+        actions::plan::reader plan((dir / "newer").string());
+        check(plan.error().find(std::format("is a version {} plan", version)) != std::string::npos, "other versions refused");
+    }
+
+    // nothing to do is still a plan
+    check(actions::plan::save((dir / "empty").string(), {}, {}, 7), "empty plan saved");
+    {
+        actions::plan::reader plan((dir / "empty").string());
+        check(plan.error().empty() && plan.id() == 7 && plan.entries() == 0 && plan.hooks() == 0, "empty plan reads back");
+    }
+
+    return check.result();
+
+}
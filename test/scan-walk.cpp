@@ -0,0 +1,70 @@
+#include "scan.hpp"
+
+#include "test.hpp"
+#include "testing.hpp"
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+int main(const int argc, const char *argv[]) {
+
+    // without HOME no snapshot is kept, so every warm() walks again
+    unsetenv("HOME");
+    unsetenv("XDG_STATE_HOME");
+
+    testing::scratch dir("scan");
+    fs::path repo = dir / "repo";
+    fs::create_directories(repo / "dir" / "sub");
+    fs::create_directories(repo / ".git");
+    // enough of them that parents and what is in them are read by different workers
+    for (int i = 0; i < 64; i++) fs::create_directories(repo / "many" / std::to_string(i) / "locked" / "inside");
+    std::ofstream(repo / "a") << "a";
+    std::ofstream(repo / "dir" / "b") << "b";
+    std::ofstream(repo / ".git" / "HEAD") << "ref: refs/heads/main";
+    fs::create_directory_symlink("dir", repo / "link");
+    for (int i = 0; i < 64; i++) fs::permissions(repo / "many" / std::to_string(i) / "locked", fs::perms::none);
+
+    testing::checks check;
+
+    scan::warm(repo, 8);
+    check(scan::type(repo / "a") == fs::file_type::regular && scan::type(repo / "dir" / "sub") == fs::file_type::directory
+        && scan::type(repo) == fs::file_type::directory, "walk finds what is there");
+    check(scan::type(repo / "missing") == fs::file_type::not_found && scan::type(repo / "dir" / "gone" / "deeper") == fs::file_type::not_found,
+        "walk knows what isn't there");
+    check(scan::type(repo / "link") == fs::file_type::symlink && !scan::type(repo / "link" / "b"), "symlinks are not followed");
+    check(!scan::type(repo / ".git" / "HEAD") && !scan::type(dir / "elsewhere"), ".git and paths outside are looked up");
+    check(scan::list(repo / "dir") == std::vector<std::string>{"b", "sub"}, "directory listing");
+    std::error_code ec;
+    check(fs::is_regular_file(scan::status(repo / "a", ec)) && !fs::exists(scan::status(repo / "missing", ec)),
+        "status from the walk");
+
+    // root reads it all the same, so only where permissions hold
+    int fd = open((repo / "many" / "0" / "locked").c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd >= 0) {
+        close(fd);
+        std::println("skip: unreadable directories, permissions aren't enforced");
+    } else {
+        // whichever worker recorded it in its parent, it is never taken for walked
+        bool unknown = true;
+        for (int i = 0; i < 32 && unknown; i++) {
+            scan::warm(repo, 8);
+            for (int n = 0; n < 64; n++) {
+                fs::path locked = repo / "many" / std::to_string(n) / "locked";
+                unknown = unknown && !scan::type(locked) && !scan::type(locked / "inside");
+            }
+        }
+        check(unknown, "unreadable directories are looked up");
+    }
+
+    for (int i = 0; i < 64; i++) fs::permissions(repo / "many" / std::to_string(i) / "locked", fs::perms::owner_all);
+    return check.result();
+
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <filesystem>
+#include <format>
+#include <iostream>
+#include <print>
+#include <string_view>
+#include <system_error>
+
+#include <unistd.h>
+
+// what the tests have in common: somewhere of their own to make a mess, and
+// a tally of the checks made
+namespace testing {
+
+    // a fresh directory under the temporary one, gone again with this
+    class scratch {
+    public:
+        explicit scratch(std::string_view name)
+            : root(std::filesystem::temp_directory_path() / std::format("confidant-{}-{}", name, getpid())) {
+            std::filesystem::create_directories(root);
+        }
+        ~scratch() {
+            std::error_code ec;
+            std::filesystem::remove_all(root, ec);
+        }
+        scratch(const scratch&) = delete;
+        scratch& operator=(const scratch&) = delete;
+
+        const std::filesystem::path& path() const { return root; }
+        std::filesystem::path operator/(const std::filesystem::path& p) const { return root / p; }
+
+    private:
+        std::filesystem::path root;
+    };
+
+    // each check is reported as it's made; the test fails when any did
+    class checks {
+    public:
+        void operator()(bool ok, std::string_view what) {
+            if (ok) {
+                std::println("pass: {}", what);
+            } else {
+                std::println(std::cerr, "fail: {}", what);
+                failed = true;
+            }
+        }
+        int result() const { return failed ? 1 : 0; }
+
+    private:
+        bool failed = false;
+    };
+
+}; // END testing